@@ -0,0 +1,154 @@
+/**
+ * @file cmsis_os.h
+ * @author tonyddg (tonyddg@outlook.com)
+ * @brief 主机模拟使用的 CMSIS RTOS 与 FreeRTOS 接口, 由 host_os.c 以 pthread 与虚拟时钟实现
+ * @version 0.1
+ * @date 2024-02-04
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef HOST_CMSIS_OS_DEF
+#define HOST_CMSIS_OS_DEF
+
+#include <stdint.h>
+#include <stddef.h>
+
+//********** CMSIS RTOS **********//
+
+typedef void* osThreadId_t;
+typedef void* osMessageQueueId_t;
+typedef void* osSemaphoreId_t;
+typedef void* osTimerId_t;
+
+typedef void (*osThreadFunc_t)(void* argument);
+typedef void (*osTimerFunc_t)(void* argument);
+
+typedef enum
+{
+    osOK = 0,
+    osError = -1,
+    osErrorTimeout = -2,
+    osErrorResource = -3,
+    osErrorParameter = -4,
+    osErrorNoMemory = -5,
+    osErrorISR = -6
+} osStatus_t;
+
+typedef enum
+{
+    osPriorityNone = 0,
+    osPriorityIdle = 1,
+    osPriorityLow = 8,
+    osPriorityBelowNormal = 16,
+    osPriorityNormal = 24,
+    osPriorityAboveNormal = 32,
+    osPriorityHigh = 40,
+    osPriorityRealtime = 48,
+    osPriorityRealtime7 = 55
+} osPriority_t;
+
+typedef enum
+{
+    osTimerOnce = 0,
+    osTimerPeriodic = 1
+} osTimerType_t;
+
+typedef struct
+{
+    const char* name;
+    uint32_t attr_bits;
+    void* cb_mem;
+    uint32_t cb_size;
+    void* stack_mem;
+    uint32_t stack_size;
+    osPriority_t priority;
+} osThreadAttr_t;
+
+#define osWaitForever 0xFFFFFFFFU
+
+#define osFlagsWaitAny 0x00000000U
+#define osFlagsWaitAll 0x00000001U
+#define osFlagsNoClear 0x00000002U
+#define osFlagsError 0x80000000U
+#define osFlagsErrorTimeout 0xFFFFFFFEU
+
+uint32_t osKernelGetTickCount(void);
+uint32_t osKernelGetTickFreq(void);
+
+osThreadId_t osThreadNew(osThreadFunc_t func, void* argument, const osThreadAttr_t* attr);
+osThreadId_t osThreadGetId(void);
+uint32_t osThreadFlagsSet(osThreadId_t thread_id, uint32_t flags);
+uint32_t osThreadFlagsWait(uint32_t flags, uint32_t options, uint32_t timeout);
+
+osStatus_t osDelay(uint32_t ticks);
+osStatus_t osDelayUntil(uint32_t ticks);
+
+osMessageQueueId_t osMessageQueueNew(uint32_t msg_count, uint32_t msg_size, const void* attr);
+osStatus_t osMessageQueuePut(osMessageQueueId_t mq_id, const void* msg_ptr, uint8_t msg_prio, uint32_t timeout);
+osStatus_t osMessageQueueGet(osMessageQueueId_t mq_id, void* msg_ptr, uint8_t* msg_prio, uint32_t timeout);
+uint32_t osMessageQueueGetCount(osMessageQueueId_t mq_id);
+uint32_t osMessageQueueGetSpace(osMessageQueueId_t mq_id);
+
+osSemaphoreId_t osSemaphoreNew(uint32_t max_count, uint32_t initial_count, const void* attr);
+osStatus_t osSemaphoreAcquire(osSemaphoreId_t semaphore_id, uint32_t timeout);
+osStatus_t osSemaphoreRelease(osSemaphoreId_t semaphore_id);
+uint32_t osSemaphoreGetCount(osSemaphoreId_t semaphore_id);
+
+osTimerId_t osTimerNew(osTimerFunc_t func, osTimerType_t type, void* argument, const void* attr);
+osStatus_t osTimerStart(osTimerId_t timer_id, uint32_t ticks);
+osStatus_t osTimerStop(osTimerId_t timer_id);
+uint32_t osTimerIsRunning(osTimerId_t timer_id);
+
+//********** FreeRTOS **********//
+
+typedef uint32_t UBaseType_t;
+typedef int32_t BaseType_t;
+typedef uint32_t TickType_t;
+typedef void* TaskHandle_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS 1
+#define pdFAIL 0
+#define portMAX_DELAY 0xFFFFFFFFU
+#define pdMS_TO_TICKS(x) (x)
+
+typedef enum
+{
+    eNoAction = 0,
+    eSetBits,
+    eIncrement,
+    eSetValueWithOverwrite,
+    eSetValueWithoutOverwrite
+} eNotifyAction;
+
+void* pvPortMalloc(size_t size);
+void vPortFree(void* mem);
+size_t xPortGetFreeHeapSize(void);
+size_t xPortGetMinimumEverFreeHeapSize(void);
+BaseType_t xPortIsInsideInterrupt(void);
+
+// 临界区与中断屏蔽均以同一个全局递归锁实现, 模拟中断只在持有该锁时执行
+void vPortEnterCritical(void);
+void vPortExitCritical(void);
+UBaseType_t ulPortRaiseBASEPRI(void);
+void vPortSetBASEPRI(UBaseType_t mask);
+
+#define taskENTER_CRITICAL() vPortEnterCritical()
+#define taskEXIT_CRITICAL() vPortExitCritical()
+#define taskENTER_CRITICAL_FROM_ISR() ulPortRaiseBASEPRI()
+#define taskEXIT_CRITICAL_FROM_ISR(mask) vPortSetBASEPRI(mask)
+// 模拟中断返回后总是重新调度, 不需要请求切换
+#define portYIELD_FROM_ISR(woken) ((void)(woken))
+
+TickType_t xTaskGetTickCount(void);
+TickType_t xTaskGetTickCountFromISR(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action);
+BaseType_t xTaskNotifyFromISR(TaskHandle_t task, uint32_t value, eNotifyAction action, BaseType_t* woken);
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t* value, TickType_t timeout);
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t timeout);
+
+#endif
@@ -0,0 +1,789 @@
+#include "host_os.h"
+#include "host_sim.h"
+#include "cmsis_os.h"
+#include "main.h"
+#include "usart.h"
+#include "i2c.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 外设状态只在任务与模拟中断中访问, 默认同一时刻只有一个任务或中断运行, 因此不加锁
+
+//********** 内核 **********//
+
+uint32_t SystemCoreClock = 72000000;
+CoreDebug_Type hostCoreDebug;
+static DWT_Type hostDWT;
+
+DWT_Type* HostDWT_Get(void)
+{
+    // 任务的计算不消耗虚拟时间, 因此叠加实际经过的时间, 使代码段的周期数有意义
+    if(hostDWT.CTRL & DWT_CTRL_CYCCNTENA_Msk)
+    {
+        uint64_t mhz = SystemCoreClock / 1000000;
+        hostDWT.CYCCNT = (uint32_t)(HostOS_GetTimeUs() * mhz + HostOS_GetRealNs() * mhz / 1000);
+    }
+    return &hostDWT;
+}
+
+uint32_t HAL_GetTick(void)
+{
+    return osKernelGetTickCount();
+}
+
+void Error_Handler(void)
+{
+    fprintf(stderr, "Error_Handler called at %llu us\n", (unsigned long long)HostOS_GetTimeUs());
+    abort();
+}
+
+GPIO_TypeDef hostGPIOC;
+
+void HAL_GPIO_TogglePin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin)
+{
+    GPIOx->ODR ^= GPIO_Pin;
+}
+
+//********** UART **********//
+
+// RX 线路上等待到达的数据
+#define HOST_UART_LINE_SIZE (1u << 16)
+// TX 线路上已发送的数据
+#define HOST_UART_OUT_SIZE (1u << 18)
+
+// 接收方式
+#define HOST_UART_RX_NONE 0
+#define HOST_UART_RX_DMA 1
+#define HOST_UART_RX_BLOCK 2
+
+static DMA_Channel_TypeDef hostUartRxCh;
+static DMA_Channel_TypeDef hostUartTxCh;
+DMA_HandleTypeDef hdma_usart1_rx = {
+    .Instance = &hostUartRxCh,
+    .Init = {.Mode = DMA_NORMAL}
+};
+DMA_HandleTypeDef hdma_usart1_tx = {
+    .Instance = &hostUartTxCh,
+    .Init = {.Mode = DMA_NORMAL}
+};
+UART_HandleTypeDef huart1 = {
+    .hdmatx = &hdma_usart1_tx,
+    .hdmarx = &hdma_usart1_rx,
+    .gState = HAL_UART_STATE_READY,
+    .RxState = HAL_UART_STATE_READY
+};
+
+static uint32_t hostUartByteUs = 87;
+static uint8_t hostUartLine[HOST_UART_LINE_SIZE];
+static size_t hostUartLineHead = 0;
+static size_t hostUartLineCount = 0;
+static uint32_t hostUartLost = 0;
+static HostEvent hostUartRxEvent;
+static HostEvent hostUartIdleEvent;
+static HostEvent hostUartErrEvent;
+
+static uint8_t hostUartRxMode = HOST_UART_RX_NONE;
+static uint16_t hostUartRxPos = 0;
+static uint8_t hostUartRxSinceIdle = 0;
+static uint8_t hostUartRxDone = 0;
+
+static char hostUartOut[HOST_UART_OUT_SIZE];
+static size_t hostUartOutLen = 0;
+static const uint8_t* hostUartTxData = NULL;
+static uint16_t hostUartTxLen = 0;
+static HostEvent hostUartTxEvent;
+
+static void HostOut_Append(char* out, size_t* out_len, size_t size, const uint8_t* data, size_t len)
+{
+    if(*out_len + len > size)
+    {
+        fprintf(stderr, "host_hal: output capture overflow\n");
+        abort();
+    }
+    memcpy(out + *out_len, data, len);
+    *out_len += len;
+}
+
+static size_t HostOut_Take(char* out, size_t* out_len, char* buf, size_t size)
+{
+    size_t len = (*out_len < size - 1) ? *out_len : size - 1;
+    memcpy(buf, out, len);
+    buf[len] = 0;
+    memmove(out, out + len, *out_len - len);
+    *out_len -= len;
+    return len;
+}
+
+void HostUart_SetBaud(uint32_t baud)
+{
+    hostUartByteUs = (10000000u + baud / 2) / baud;
+}
+
+// 停止接收, DMA 计数器保持停止时的值
+static void HostUart_RxStop()
+{
+    hostUartRxMode = HOST_UART_RX_NONE;
+    huart1.RxState = HAL_UART_STATE_READY;
+}
+
+static void HostUart_RxEvent(uint16_t pos)
+{
+    if(huart1.RxEventCallback != NULL)
+    {
+        huart1.RxEventCallback(&huart1, pos);
+    }
+}
+
+static void HostUart_RxIdle(void* arg)
+{
+    (void)arg;
+    if(!hostUartRxSinceIdle)
+    {
+        return;
+    }
+    hostUartRxSinceIdle = 0;
+
+    uint16_t pos = hostUartRxPos;
+    if(hostUartRxMode == HOST_UART_RX_DMA && pos > 0 && pos < huart1.RxXferSize)
+    {
+        if(hdma_usart1_rx.Init.Mode != DMA_CIRCULAR)
+        {
+            HostUart_RxStop();
+        }
+        HostUart_RxEvent(pos);
+    }
+    else if(hostUartRxMode == HOST_UART_RX_BLOCK && pos > 0)
+    {
+        HostUart_RxStop();
+        hostUartRxDone = 1;
+        HostOS_WakeObj(&hostUartRxDone);
+    }
+}
+
+static void HostUart_RxByte(void* arg)
+{
+    (void)arg;
+    uint8_t byte = hostUartLine[hostUartLineHead];
+    hostUartLineHead = (hostUartLineHead + 1) % HOST_UART_LINE_SIZE;
+    hostUartLineCount--;
+    if(hostUartLineCount > 0)
+    {
+        HostEvent_Start(&hostUartRxEvent, hostUartByteUs, HostUart_RxByte, NULL);
+    }
+    HostEvent_Start(&hostUartIdleEvent, hostUartByteUs, HostUart_RxIdle, NULL);
+
+    if(hostUartRxMode == HOST_UART_RX_NONE)
+    {
+        hostUartLost++;
+        return;
+    }
+
+    uint16_t size = huart1.RxXferSize;
+    huart1.pRxBuffPtr[hostUartRxPos] = byte;
+    hostUartRxPos++;
+    hostUartRxSinceIdle = 1;
+    hostUartRxCh.CNDTR = size - hostUartRxPos;
+
+    if(hostUartRxMode == HOST_UART_RX_BLOCK)
+    {
+        if(hostUartRxPos == size)
+        {
+            HostUart_RxStop();
+            hostUartRxDone = 1;
+            HostOS_WakeObj(&hostUartRxDone);
+        }
+        return;
+    }
+
+    // 与 HAL 相同, 直到空闲的 DMA 接收在半满与全满时也产生接收事件
+    if(hostUartRxPos == size / 2 && (hostUartRxCh.CCR & DMA_IT_HT))
+    {
+        HostUart_RxEvent(size / 2);
+    }
+    if(hostUartRxPos == size)
+    {
+        if(hdma_usart1_rx.Init.Mode == DMA_CIRCULAR)
+        {
+            hostUartRxPos = 0;
+            hostUartRxCh.CNDTR = size;
+            hostUartRxSinceIdle = 0;
+        }
+        else
+        {
+            HostUart_RxStop();
+        }
+        HostUart_RxEvent(size);
+    }
+}
+
+void HostUart_Input(const void* data, size_t len)
+{
+    const uint8_t* src = data;
+    if(hostUartLineCount + len > HOST_UART_LINE_SIZE)
+    {
+        fprintf(stderr, "host_hal: UART input overflow\n");
+        abort();
+    }
+    for(size_t i = 0; i < len; i++)
+    {
+        hostUartLine[(hostUartLineHead + hostUartLineCount) % HOST_UART_LINE_SIZE] = src[i];
+        hostUartLineCount++;
+    }
+    if(len > 0 && !hostUartRxEvent._active)
+    {
+        HostEvent_Start(&hostUartRxEvent, hostUartByteUs, HostUart_RxByte, NULL);
+    }
+}
+
+size_t HostUart_GetPendingNum()
+{
+    return hostUartLineCount;
+}
+
+uint32_t HostUart_GetLostNum()
+{
+    return hostUartLost;
+}
+
+size_t HostUart_GetOutput(char* buf, size_t size)
+{
+    return HostOut_Take(hostUartOut, &hostUartOutLen, buf, size);
+}
+
+static void HostUart_Error(void* arg)
+{
+    if(hostUartRxMode != HOST_UART_RX_NONE)
+    {
+        HostUart_RxStop();
+    }
+    huart1.ErrorCode = (uint32_t)(uintptr_t)arg;
+    if(huart1.ErrorCallback != NULL)
+    {
+        huart1.ErrorCallback(&huart1);
+    }
+}
+
+void HostUart_InjectError(uint32_t error)
+{
+    HostEvent_Start(&hostUartErrEvent, 0, HostUart_Error, (void*)(uintptr_t)error);
+}
+
+HAL_StatusTypeDef HAL_UART_RegisterCallback(UART_HandleTypeDef* huart, HAL_UART_CallbackIDTypeDef CallbackID, pUART_CallbackTypeDef pCallback)
+{
+    switch(CallbackID)
+    {
+    case HAL_UART_TX_COMPLETE_CB_ID:
+        huart->TxCpltCallback = pCallback;
+        return HAL_OK;
+    case HAL_UART_ERROR_CB_ID:
+        huart->ErrorCallback = pCallback;
+        return HAL_OK;
+    default:
+        return HAL_ERROR;
+    }
+}
+
+HAL_StatusTypeDef HAL_UART_RegisterRxEventCallback(UART_HandleTypeDef* huart, pUART_RxEventCallbackTypeDef pCallback)
+{
+    huart->RxEventCallback = pCallback;
+    return HAL_OK;
+}
+
+static void HostUart_TxDone(void* arg)
+{
+    (void)arg;
+    HostOut_Append(hostUartOut, &hostUartOutLen, HOST_UART_OUT_SIZE, hostUartTxData, hostUartTxLen);
+    huart1.gState = HAL_UART_STATE_READY;
+    if(huart1.TxCpltCallback != NULL)
+    {
+        huart1.TxCpltCallback(&huart1);
+    }
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef* huart, const uint8_t* pData, uint16_t Size)
+{
+    if(huart->gState != HAL_UART_STATE_READY)
+    {
+        return HAL_BUSY;
+    }
+    if(pData == NULL || Size == 0)
+    {
+        return HAL_ERROR;
+    }
+
+    // 数据在发送完成时才复制, DMA 读取期间释放或修改缓冲区的错误将反映在输出中
+    huart->gState = HAL_UART_STATE_BUSY_TX;
+    hostUartTxData = pData;
+    hostUartTxLen = Size;
+    hostUartTxCh.CNDTR = Size;
+    HostEvent_Start(&hostUartTxEvent, (uint64_t)Size * hostUartByteUs, HostUart_TxDone, NULL);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef* huart, const uint8_t* pData, uint16_t Size, uint32_t Timeout)
+{
+    (void)Timeout;
+    if(huart->gState != HAL_UART_STATE_READY)
+    {
+        return HAL_BUSY;
+    }
+    if(pData == NULL || Size == 0)
+    {
+        return HAL_ERROR;
+    }
+
+    // 阻塞发送在实际硬件上轮询等待, 此处让出 CPU, 虚拟时间相同
+    huart->gState = HAL_UART_STATE_BUSY_TX;
+    HostOS_DelayUs((uint64_t)Size * hostUartByteUs);
+    HostOut_Append(hostUartOut, &hostUartOutLen, HOST_UART_OUT_SIZE, pData, Size);
+    huart->gState = HAL_UART_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef* huart, uint8_t* pData, uint16_t Size)
+{
+    if(huart->RxState != HAL_UART_STATE_READY)
+    {
+        return HAL_BUSY;
+    }
+    if(pData == NULL || Size == 0)
+    {
+        return HAL_ERROR;
+    }
+
+    huart->pRxBuffPtr = pData;
+    huart->RxXferSize = Size;
+    huart->RxState = HAL_UART_STATE_BUSY_RX;
+    huart->ErrorCode = HAL_UART_ERROR_NONE;
+    hostUartRxMode = HOST_UART_RX_DMA;
+    hostUartRxPos = 0;
+    hostUartRxSinceIdle = 0;
+    hostUartRxCh.CNDTR = Size;
+    hostUartRxCh.CCR = DMA_IT_TC | DMA_IT_HT | DMA_IT_TE;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle(UART_HandleTypeDef* huart, uint8_t* pData, uint16_t Size, uint16_t* RxLen, uint32_t Timeout)
+{
+    if(huart->RxState != HAL_UART_STATE_READY)
+    {
+        return HAL_BUSY;
+    }
+    if(pData == NULL || Size == 0)
+    {
+        return HAL_ERROR;
+    }
+
+    huart->pRxBuffPtr = pData;
+    huart->RxXferSize = Size;
+    huart->RxState = HAL_UART_STATE_BUSY_RX;
+    hostUartRxMode = HOST_UART_RX_BLOCK;
+    hostUartRxPos = 0;
+    hostUartRxSinceIdle = 0;
+    hostUartRxDone = 0;
+
+    uint64_t timeout = (Timeout == HAL_MAX_DELAY) ? UINT64_MAX : (uint64_t)Timeout * 1000;
+    uint64_t beg = HostOS_GetTimeUs();
+    while(!hostUartRxDone)
+    {
+        uint64_t passed = HostOS_GetTimeUs() - beg;
+        if(passed >= timeout || !HostOS_WaitObj(&hostUartRxDone, timeout == UINT64_MAX ? UINT64_MAX : timeout - passed))
+        {
+            if(!hostUartRxDone)
+            {
+                HostUart_RxStop();
+                return HAL_TIMEOUT;
+            }
+        }
+    }
+    *RxLen = hostUartRxPos;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_AbortReceive(UART_HandleTypeDef* huart)
+{
+    hostUartRxMode = HOST_UART_RX_NONE;
+    hostUartRxCh.CCR = 0;
+    huart->RxState = HAL_UART_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_UART_StateTypeDef HAL_UART_GetState(UART_HandleTypeDef* huart)
+{
+    if(huart->gState == HAL_UART_STATE_RESET || huart->gState == HAL_UART_STATE_ERROR)
+    {
+        return huart->gState;
+    }
+    return (HAL_UART_StateTypeDef)(huart->gState | huart->RxState);
+}
+
+//********** I2C **********//
+
+// 最多模拟的从设备数
+#define HOST_I2C_DEV_NUM 8
+
+static DMA_Channel_TypeDef hostI2CRxCh;
+static DMA_Channel_TypeDef hostI2CTxCh;
+DMA_HandleTypeDef hdma_i2c1_rx = {
+    .Instance = &hostI2CRxCh,
+    .Init = {.Mode = DMA_NORMAL}
+};
+DMA_HandleTypeDef hdma_i2c1_tx = {
+    .Instance = &hostI2CTxCh,
+    .Init = {.Mode = DMA_NORMAL}
+};
+I2C_HandleTypeDef hi2c1 = {
+    .hdmatx = &hdma_i2c1_tx,
+    .hdmarx = &hdma_i2c1_rx,
+    .State = HAL_I2C_STATE_READY,
+    .Mode = HAL_I2C_MODE_NONE
+};
+
+static uint32_t hostI2CClock = 400000;
+static HostI2CDev hostI2CDev[HOST_I2C_DEV_NUM];
+static uint32_t hostI2CDevNum = 0;
+static uint8_t hostI2CMemAbort = 0;
+static uint32_t hostI2CAbortNum = 0;
+
+/// @brief 正在进行的 DMA 传输
+typedef struct HOSTI2CXFER
+{
+    uint8_t _active;
+    uint8_t _is_read;
+    // 为 NULL 时设备不应答
+    HostI2CDev* _dev;
+    uint8_t _raddr;
+    uint8_t* _buf;
+    uint16_t _len;
+} HostI2CXfer;
+
+static HostI2CXfer hostI2CXfer;
+static HostEvent hostI2CEvent;
+
+void HostI2C_SetClock(uint32_t clock)
+{
+    hostI2CClock = clock;
+}
+
+HostI2CDev* HostI2C_AddDevice(uint8_t daddr)
+{
+    if(hostI2CDevNum == HOST_I2C_DEV_NUM)
+    {
+        return NULL;
+    }
+    HostI2CDev* dev = &hostI2CDev[hostI2CDevNum++];
+    memset(dev, 0, sizeof(HostI2CDev));
+    dev->_daddr = daddr;
+    dev->_present = 1;
+    return dev;
+}
+
+void HostI2C_SetMemAbort(uint8_t is_support)
+{
+    hostI2CMemAbort = is_support;
+}
+
+uint32_t HostI2C_GetAbortNum()
+{
+    return hostI2CAbortNum;
+}
+
+static HostI2CDev* HostI2C_Find(uint16_t daddr)
+{
+    for(uint32_t i = 0; i < hostI2CDevNum; i++)
+    {
+        if(hostI2CDev[i]._daddr == (daddr & 0xFE) && hostI2CDev[i]._present)
+        {
+            return &hostI2CDev[i];
+        }
+    }
+    return NULL;
+}
+
+// 传输 num 字节 (每字节 9 位) 的时间 (us)
+static uint64_t HostI2C_ByteUs(uint32_t num)
+{
+    return ((uint64_t)num * 9 * 1000000 + hostI2CClock - 1) / hostI2CClock;
+}
+
+static void HostI2C_Copy(HostI2CDev* dev, uint8_t is_read, uint8_t raddr, uint8_t* buf, uint16_t len)
+{
+    for(uint16_t i = 0; i < len; i++)
+    {
+        uint8_t reg = (uint8_t)(raddr + i);
+        if(is_read)
+        {
+            buf[i] = dev->_reg[reg];
+        }
+        else
+        {
+            dev->_reg[reg] = buf[i];
+        }
+    }
+    if(is_read)
+    {
+        dev->_readNum++;
+    }
+    else
+    {
+        dev->_writeNum++;
+    }
+}
+
+// 取消正在进行的 DMA 传输, 之后不会再写入目标缓冲区
+static void HostI2C_Cancel()
+{
+    if(hostI2CXfer._active)
+    {
+        HostEvent_Stop(&hostI2CEvent);
+        hostI2CXfer._active = 0;
+        hostI2CAbortNum++;
+    }
+}
+
+static void HostI2C_XferDone(void* arg)
+{
+    (void)arg;
+    HostI2CXfer* xfer = &hostI2CXfer;
+    xfer->_active = 0;
+    hi2c1.State = HAL_I2C_STATE_READY;
+    hi2c1.Mode = HAL_I2C_MODE_NONE;
+
+    if(xfer->_dev == NULL)
+    {
+        hi2c1.ErrorCode = HAL_I2C_ERROR_AF;
+        if(hi2c1.ErrorCallback != NULL)
+        {
+            hi2c1.ErrorCallback(&hi2c1);
+        }
+        return;
+    }
+
+    HostI2C_Copy(xfer->_dev, xfer->_is_read, xfer->_raddr, xfer->_buf, xfer->_len);
+    pI2C_CallbackTypeDef callBack = xfer->_is_read ? hi2c1.MemRxCpltCallback : hi2c1.MemTxCpltCallback;
+    if(callBack != NULL)
+    {
+        callBack(&hi2c1);
+    }
+}
+
+static void HostI2C_AbortDone(void* arg)
+{
+    (void)arg;
+    hi2c1.State = HAL_I2C_STATE_READY;
+    hi2c1.Mode = HAL_I2C_MODE_NONE;
+    if(hi2c1.AbortCpltCallback != NULL)
+    {
+        hi2c1.AbortCpltCallback(&hi2c1);
+    }
+}
+
+static HAL_StatusTypeDef HostI2C_StartDMA(I2C_HandleTypeDef* hi2c, uint8_t is_read, uint16_t DevAddress, uint16_t MemAddress, uint8_t* pData, uint16_t Size)
+{
+    if(hi2c->State != HAL_I2C_STATE_READY)
+    {
+        return HAL_BUSY;
+    }
+    if(pData == NULL || Size == 0)
+    {
+        return HAL_ERROR;
+    }
+
+    hi2c->State = is_read ? HAL_I2C_STATE_BUSY_RX : HAL_I2C_STATE_BUSY_TX;
+    hi2c->Mode = HAL_I2C_MODE_MEM;
+    hi2c->ErrorCode = HAL_I2C_ERROR_NONE;
+
+    HostI2CXfer* xfer = &hostI2CXfer;
+    xfer->_active = 1;
+    xfer->_is_read = is_read;
+    xfer->_dev = HostI2C_Find(DevAddress);
+    xfer->_raddr = (uint8_t)MemAddress;
+    xfer->_buf = pData;
+    xfer->_len = Size;
+    (is_read ? &hostI2CRxCh : &hostI2CTxCh)->CNDTR = Size;
+
+    // 不应答的设备在地址字节后以 AF 错误结束, 读取需额外发送重复起始与读地址
+    uint64_t time = (xfer->_dev == NULL) ? HostI2C_ByteUs(1) : HostI2C_ByteUs((is_read ? 3 : 2) + Size) + xfer->_dev->_stretch;
+    HostEvent_Start(&hostI2CEvent, time, HostI2C_XferDone, NULL);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read_DMA(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size)
+{
+    (void)MemAddSize;
+    return HostI2C_StartDMA(hi2c, 1, DevAddress, MemAddress, pData, Size);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write_DMA(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size)
+{
+    (void)MemAddSize;
+    return HostI2C_StartDMA(hi2c, 0, DevAddress, MemAddress, pData, Size);
+}
+
+static HAL_StatusTypeDef HostI2C_Blocking(I2C_HandleTypeDef* hi2c, uint8_t is_read, uint16_t DevAddress, uint16_t MemAddress, uint8_t* pData, uint16_t Size, uint32_t Timeout)
+{
+    if(hi2c->State != HAL_I2C_STATE_READY)
+    {
+        return HAL_BUSY;
+    }
+    if(pData == NULL || Size == 0)
+    {
+        return HAL_ERROR;
+    }
+
+    hi2c->State = is_read ? HAL_I2C_STATE_BUSY_RX : HAL_I2C_STATE_BUSY_TX;
+    hi2c->Mode = HAL_I2C_MODE_MEM;
+    hi2c->ErrorCode = HAL_I2C_ERROR_NONE;
+
+    // 阻塞传输在实际硬件上轮询等待, 此处让出 CPU, 虚拟时间相同
+    HAL_StatusTypeDef res = HAL_OK;
+    HostI2CDev* dev = HostI2C_Find(DevAddress);
+    uint64_t time = (dev == NULL) ? HostI2C_ByteUs(1) : HostI2C_ByteUs((is_read ? 3 : 2) + Size) + dev->_stretch;
+    uint64_t timeout = (Timeout == HAL_MAX_DELAY) ? UINT64_MAX : (uint64_t)Timeout * 1000;
+    if(time > timeout)
+    {
+        HostOS_DelayUs(timeout);
+        hi2c->ErrorCode = HAL_I2C_ERROR_TIMEOUT;
+        res = HAL_ERROR;
+    }
+    else
+    {
+        HostOS_DelayUs(time);
+        if(dev == NULL)
+        {
+            hi2c->ErrorCode = HAL_I2C_ERROR_AF;
+            res = HAL_ERROR;
+        }
+        else
+        {
+            HostI2C_Copy(dev, is_read, (uint8_t)MemAddress, pData, Size);
+        }
+    }
+
+    hi2c->State = HAL_I2C_STATE_READY;
+    hi2c->Mode = HAL_I2C_MODE_NONE;
+    return res;
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size, uint32_t Timeout)
+{
+    (void)MemAddSize;
+    return HostI2C_Blocking(hi2c, 1, DevAddress, MemAddress, pData, Size, Timeout);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size, uint32_t Timeout)
+{
+    (void)MemAddSize;
+    return HostI2C_Blocking(hi2c, 0, DevAddress, MemAddress, pData, Size, Timeout);
+}
+
+HAL_StatusTypeDef HAL_I2C_IsDeviceReady(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint32_t Trials, uint32_t Timeout)
+{
+    (void)Timeout;
+    if(hi2c->State != HAL_I2C_STATE_READY)
+    {
+        return HAL_BUSY;
+    }
+
+    hi2c->State = HAL_I2C_STATE_BUSY;
+    HAL_StatusTypeDef res = HAL_ERROR;
+    uint32_t trial = 0;
+    do
+    {
+        HostOS_DelayUs(HostI2C_ByteUs(1));
+        HostI2CDev* dev = HostI2C_Find(DevAddress);
+        if(dev != NULL)
+        {
+            res = HAL_OK;
+            break;
+        }
+    } while(++trial < Trials);
+
+    hi2c->State = HAL_I2C_STATE_READY;
+    return res;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Abort_IT(I2C_HandleTypeDef* hi2c, uint16_t DevAddress)
+{
+    (void)DevAddress;
+    // 与 F1 HAL 相同, 仅能终止主机模式的传输
+    if(hi2c->Mode != HAL_I2C_MODE_MASTER && !(hi2c->Mode == HAL_I2C_MODE_MEM && hostI2CMemAbort))
+    {
+        return HAL_ERROR;
+    }
+
+    HostI2C_Cancel();
+    hi2c->State = HAL_I2C_STATE_ABORT;
+    HostEvent_Start(&hostI2CEvent, HostI2C_ByteUs(1), HostI2C_AbortDone, NULL);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_RegisterCallback(I2C_HandleTypeDef* hi2c, HAL_I2C_CallbackIDTypeDef CallbackID, pI2C_CallbackTypeDef pCallback)
+{
+    switch(CallbackID)
+    {
+    case HAL_I2C_MEM_TX_COMPLETE_CB_ID:
+        hi2c->MemTxCpltCallback = pCallback;
+        return HAL_OK;
+    case HAL_I2C_MEM_RX_COMPLETE_CB_ID:
+        hi2c->MemRxCpltCallback = pCallback;
+        return HAL_OK;
+    case HAL_I2C_ERROR_CB_ID:
+        hi2c->ErrorCallback = pCallback;
+        return HAL_OK;
+    case HAL_I2C_ABORT_CB_ID:
+        hi2c->AbortCpltCallback = pCallback;
+        return HAL_OK;
+    default:
+        return HAL_ERROR;
+    }
+}
+
+HAL_StatusTypeDef HAL_I2C_DeInit(I2C_HandleTypeDef* hi2c)
+{
+    HostI2C_Cancel();
+    HostEvent_Stop(&hostI2CEvent);
+    hi2c->State = HAL_I2C_STATE_RESET;
+    hi2c->Mode = HAL_I2C_MODE_NONE;
+    hi2c->ErrorCode = HAL_I2C_ERROR_NONE;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef* hi2c)
+{
+    // 与 HAL 相同, 从复位状态初始化时回调恢复为默认 (空) 回调
+    if(hi2c->State == HAL_I2C_STATE_RESET)
+    {
+        hi2c->MemTxCpltCallback = NULL;
+        hi2c->MemRxCpltCallback = NULL;
+        hi2c->ErrorCallback = NULL;
+        hi2c->AbortCpltCallback = NULL;
+    }
+    hi2c->State = HAL_I2C_STATE_READY;
+    hi2c->Mode = HAL_I2C_MODE_NONE;
+    hi2c->ErrorCode = HAL_I2C_ERROR_NONE;
+    return HAL_OK;
+}
+
+HAL_I2C_StateTypeDef HAL_I2C_GetState(I2C_HandleTypeDef* hi2c)
+{
+    return hi2c->State;
+}
+
+//********** DMA **********//
+
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef* hdma)
+{
+    if(hdma == &hdma_usart1_rx)
+    {
+        hostUartRxMode = HOST_UART_RX_NONE;
+    }
+    else if((hdma == &hdma_i2c1_rx && hostI2CXfer._is_read) || (hdma == &hdma_i2c1_tx && !hostI2CXfer._is_read))
+    {
+        HostI2C_Cancel();
+    }
+    hdma->Instance->CCR = 0;
+    return HAL_OK;
+}
@@ -0,0 +1,1211 @@
+#define _GNU_SOURCE
+
+#include "host_os.h"
+#include "cmsis_os.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// 任务状态
+#define HOST_THREAD_READY 0
+#define HOST_THREAD_RUNNING 1
+#define HOST_THREAD_BLOCKED 2
+#define HOST_THREAD_DELETED 3
+
+// 任务通知状态
+#define HOST_NOTIFY_NONE 0
+#define HOST_NOTIFY_WAITING 1
+#define HOST_NOTIFY_PENDING 2
+
+// 永远等待的时限
+#define HOST_TIME_FOREVER UINT64_MAX
+// 每个 tick 的虚拟时间 (us)
+#define HOST_TICK_US 1000u
+// 模拟堆的大小, 主机上的指针与结构体更大, 因此大于 configTOTAL_HEAP_SIZE (10240)
+#define HOST_HEAP_SIZE (64u * 1024u)
+// 模拟堆每个内存块的额外开销 (记录长度)
+#define HOST_HEAP_HEAD 16u
+// 测试主线程的优先级, 高于所有任务
+#define HOST_MAIN_PRIORITY osPriorityRealtime7
+// 软件定时器任务的优先级 (CubeMX 默认的 configTIMER_TASK_PRIORITY)
+#define HOST_TIMER_PRIORITY 2
+
+/// @brief 模拟任务
+typedef struct HOSTTHREAD
+{
+    pthread_t _pthread;
+    // 被调度运行时发出的条件变量
+    pthread_cond_t _cond;
+    const char* _name;
+    int32_t _prio;
+    uint8_t _state;
+    // 进入就绪的顺序, 同优先级先就绪的先运行
+    uint64_t _readySeq;
+    // 阻塞等待的对象
+    void* _waitObj;
+    // 阻塞的时限
+    uint64_t _deadline;
+    // 是否因超过时限而结束阻塞
+    uint8_t _timedOut;
+    // 任务通知
+    uint32_t _notifyValue;
+    uint8_t _notifyState;
+    // 线程标志
+    uint32_t _flags;
+    osThreadFunc_t _func;
+    void* _arg;
+    struct HOSTTHREAD* _next;
+} HostThread;
+
+/// @brief 消息队列
+typedef struct HOSTQUEUE
+{
+    uint8_t* _buf;
+    uint32_t _size;
+    uint32_t _itemSize;
+    uint32_t _head;
+    uint32_t _count;
+} HostQueue;
+
+/// @brief 信号量
+typedef struct HOSTSEMAPHORE
+{
+    uint32_t _max;
+    uint32_t _count;
+} HostSemaphore;
+
+/// @brief 软件定时器
+typedef struct HOSTTIMER
+{
+    osTimerFunc_t _func;
+    void* _arg;
+    osTimerType_t _type;
+    uint32_t _period;
+    uint8_t _running;
+    uint64_t _expire;
+    struct HOSTTIMER* _next;
+} HostTimer;
+
+// 内核锁, 保护以下全部状态
+static pthread_mutex_t hostLock = PTHREAD_MUTEX_INITIALIZER;
+// 中断屏蔽锁 (递归), 临界区与模拟中断持有
+static pthread_mutex_t hostIntLock;
+// 模拟堆锁
+static pthread_mutex_t hostHeapLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t hostOnce = PTHREAD_ONCE_INIT;
+
+static HostThread* hostThreadList = NULL;
+static uint64_t hostNow = 0;
+static uint64_t hostSeq = 0;
+static uint32_t hostCpuNum = 1;
+static uint32_t hostRunningNum = 0;
+static uint64_t hostSwitchNum = 0;
+static HostEvent* hostEventList = NULL;
+static struct timespec hostRealBeg;
+
+static HostThread* hostTimerTask = NULL;
+static HostTimer* hostTimerList = NULL;
+// HostOS_Delay 等待的对象, 不会被唤醒
+static uint8_t hostSleepObj;
+
+static __thread HostThread* hostSelf = NULL;
+static __thread uint8_t hostIsIsr = 0;
+static __thread uint32_t hostCritNest = 0;
+
+static uint8_t hostHeapFail = 0;
+static size_t hostHeapBlockNum = 0;
+static size_t hostHeapAllocNum = 0;
+static size_t hostHeapUsed = 0;
+static size_t hostHeapPeak = 0;
+
+static void HostOS_Init()
+{
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&hostIntLock, &attr);
+    pthread_mutexattr_destroy(&attr);
+    clock_gettime(CLOCK_MONOTONIC, &hostRealBeg);
+}
+
+static void HostOS_Fatal(const char* msg)
+{
+    fprintf(stderr, "host_os: %s\n", msg);
+    abort();
+}
+
+static HostThread* HostOS_NewThread(const char* name, int32_t prio)
+{
+    HostThread* t = calloc(1, sizeof(HostThread));
+    if(t == NULL)
+    {
+        HostOS_Fatal("out of host memory");
+    }
+    pthread_cond_init(&t->_cond, NULL);
+    t->_name = name;
+    t->_prio = prio;
+    t->_deadline = HOST_TIME_FOREVER;
+    t->_next = hostThreadList;
+    hostThreadList = t;
+    return t;
+}
+
+/**
+ * @brief 进入内核, 首次调用的线程注册为最高优先级的运行中任务
+ */
+static void HostOS_Lock()
+{
+    pthread_once(&hostOnce, HostOS_Init);
+    pthread_mutex_lock(&hostLock);
+    if(hostSelf == NULL)
+    {
+        hostSelf = HostOS_NewThread("main", HOST_MAIN_PRIORITY);
+        hostSelf->_pthread = pthread_self();
+        hostSelf->_state = HOST_THREAD_RUNNING;
+        hostRunningNum++;
+    }
+}
+
+static void HostOS_Unlock()
+{
+    pthread_mutex_unlock(&hostLock);
+}
+
+static HostThread* HostOS_PickReady()
+{
+    HostThread* best = NULL;
+    for(HostThread* t = hostThreadList; t != NULL; t = t->_next)
+    {
+        if(t->_state == HOST_THREAD_READY &&
+            (best == NULL || t->_prio > best->_prio || (t->_prio == best->_prio && t->_readySeq < best->_readySeq)))
+        {
+            best = t;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief 在空闲的 CPU 上运行优先级最高的就绪任务
+ */
+static void HostOS_Dispatch()
+{
+    HostThread* t = NULL;
+    while(hostRunningNum < hostCpuNum && (t = HostOS_PickReady()) != NULL)
+    {
+        t->_state = HOST_THREAD_RUNNING;
+        hostRunningNum++;
+        hostSwitchNum++;
+        pthread_cond_signal(&t->_cond);
+    }
+}
+
+static void HostOS_Ready(HostThread* t, uint8_t timed_out)
+{
+    if(t->_state == HOST_THREAD_BLOCKED)
+    {
+        t->_state = HOST_THREAD_READY;
+        t->_timedOut = timed_out;
+        t->_readySeq = hostSeq++;
+    }
+}
+
+static void HostOS_WakeObjLocked(void* obj)
+{
+    for(HostThread* t = hostThreadList; t != NULL; t = t->_next)
+    {
+        if(t->_state == HOST_THREAD_BLOCKED && t->_waitObj == obj)
+        {
+            HostOS_Ready(t, 0);
+        }
+    }
+}
+
+static void HostOS_ReportDeadlock()
+{
+    fprintf(stderr, "host_os: deadlock at %llu us, every task waits forever\n", (unsigned long long)hostNow);
+    for(HostThread* t = hostThreadList; t != NULL; t = t->_next)
+    {
+        if(t->_state != HOST_THREAD_DELETED)
+        {
+            fprintf(stderr, "  task %s (prio %d) state %u wait %p\n", t->_name, t->_prio, t->_state, t->_waitObj);
+        }
+    }
+    abort();
+}
+
+/**
+ * @brief 在中断上下文中执行模拟中断
+ */
+static void HostOS_RunIsr(void (*func)(void*), void* arg)
+{
+    uint8_t isIsr = hostIsIsr;
+    hostIsIsr = 1;
+    pthread_mutex_lock(&hostIntLock);
+    func(arg);
+    pthread_mutex_unlock(&hostIntLock);
+    hostIsIsr = isIsr;
+}
+
+/**
+ * @brief 所有任务均阻塞时推进虚拟时间, 处理到期的等待与定时事件, 直到有任务运行
+ * @note 由最后一个阻塞的任务执行, 模拟中断在该线程上执行, 期间没有任务运行
+ */
+static void HostOS_Idle()
+{
+    while(hostRunningNum == 0)
+    {
+        HostOS_Dispatch();
+        if(hostRunningNum > 0)
+        {
+            break;
+        }
+
+        uint64_t next = HOST_TIME_FOREVER;
+        for(HostThread* t = hostThreadList; t != NULL; t = t->_next)
+        {
+            if(t->_state == HOST_THREAD_BLOCKED && t->_deadline < next)
+            {
+                next = t->_deadline;
+            }
+        }
+        if(hostEventList != NULL && hostEventList->_time < next)
+        {
+            next = hostEventList->_time;
+        }
+        if(next == HOST_TIME_FOREVER)
+        {
+            HostOS_ReportDeadlock();
+        }
+        if(next > hostNow)
+        {
+            hostNow = next;
+        }
+
+        for(HostThread* t = hostThreadList; t != NULL; t = t->_next)
+        {
+            if(t->_state == HOST_THREAD_BLOCKED && t->_deadline <= hostNow)
+            {
+                HostOS_Ready(t, 1);
+            }
+        }
+
+        while(hostEventList != NULL && hostEventList->_time <= hostNow)
+        {
+            HostEvent* ev = hostEventList;
+            hostEventList = ev->_next;
+            ev->_active = 0;
+
+            HostOS_Unlock();
+            HostOS_RunIsr(ev->_func, ev->_arg);
+            pthread_mutex_lock(&hostLock);
+        }
+    }
+}
+
+/**
+ * @brief 阻塞当前任务, 直到被唤醒或超过时限
+ *
+ * @return uint8_t 被唤醒时返回 1, 超时返回 0
+ */
+static uint8_t HostOS_WaitOn(void* obj, uint64_t deadline)
+{
+    HostThread* self = hostSelf;
+    if(hostIsIsr)
+    {
+        HostOS_Fatal("blocking call in interrupt context");
+    }
+    if(hostCritNest > 0)
+    {
+        HostOS_Fatal("blocking call in critical section");
+    }
+    if(deadline <= hostNow)
+    {
+        return 0;
+    }
+
+    self->_waitObj = obj;
+    self->_deadline = deadline;
+    self->_state = HOST_THREAD_BLOCKED;
+    hostRunningNum--;
+
+    HostOS_Dispatch();
+    if(hostRunningNum == 0)
+    {
+        HostOS_Idle();
+    }
+    while(self->_state != HOST_THREAD_RUNNING)
+    {
+        pthread_cond_wait(&self->_cond, &hostLock);
+    }
+
+    self->_waitObj = NULL;
+    self->_deadline = HOST_TIME_FOREVER;
+    return !self->_timedOut;
+}
+
+/**
+ * @brief 内核调用结束前重新调度, 有更高优先级的就绪任务时让出 CPU
+ * @note 中断与临界区中推迟到返回 / 退出临界区时
+ */
+static void HostOS_Reschedule()
+{
+    if(hostIsIsr)
+    {
+        return;
+    }
+    HostOS_Dispatch();
+    if(hostCritNest > 0)
+    {
+        return;
+    }
+
+    HostThread* self = hostSelf;
+    HostThread* t = HostOS_PickReady();
+    if(t != NULL && t->_prio > self->_prio)
+    {
+        self->_state = HOST_THREAD_READY;
+        self->_readySeq = hostSeq++;
+        hostRunningNum--;
+        HostOS_Dispatch();
+        while(self->_state != HOST_THREAD_RUNNING)
+        {
+            pthread_cond_wait(&self->_cond, &hostLock);
+        }
+    }
+}
+
+/**
+ * @brief 将等待 tick 数转换为虚拟时间时限, 与 FreeRTOS 相同, 在 tick 边界结束等待
+ */
+static uint64_t HostOS_TickDeadline(uint32_t ticks)
+{
+    if(ticks == osWaitForever)
+    {
+        return HOST_TIME_FOREVER;
+    }
+    return (hostNow / HOST_TICK_US + ticks) * HOST_TICK_US;
+}
+
+static void* HostOS_ThreadEntry(void* arg)
+{
+    HostThread* self = arg;
+    hostSelf = self;
+
+    pthread_mutex_lock(&hostLock);
+    while(self->_state != HOST_THREAD_RUNNING)
+    {
+        pthread_cond_wait(&self->_cond, &hostLock);
+    }
+    HostOS_Unlock();
+
+    self->_func(self->_arg);
+
+    // 任务函数返回时删除任务
+    pthread_mutex_lock(&hostLock);
+    self->_state = HOST_THREAD_DELETED;
+    hostRunningNum--;
+    HostOS_Dispatch();
+    if(hostRunningNum == 0)
+    {
+        HostOS_Idle();
+    }
+    HostOS_Unlock();
+    return NULL;
+}
+
+//********** 测试控制 **********//
+
+void HostOS_SetIsr(uint8_t is_isr)
+{
+    hostIsIsr = is_isr;
+}
+
+void HostOS_SetHeapFail(uint8_t is_fail)
+{
+    pthread_mutex_lock(&hostHeapLock);
+    hostHeapFail = is_fail;
+    pthread_mutex_unlock(&hostHeapLock);
+}
+
+size_t HostOS_GetHeapBlockNum()
+{
+    pthread_mutex_lock(&hostHeapLock);
+    size_t res = hostHeapBlockNum;
+    pthread_mutex_unlock(&hostHeapLock);
+    return res;
+}
+
+size_t HostOS_GetHeapAllocNum()
+{
+    pthread_mutex_lock(&hostHeapLock);
+    size_t res = hostHeapAllocNum;
+    pthread_mutex_unlock(&hostHeapLock);
+    return res;
+}
+
+void HostOS_SetCpuNum(uint32_t num)
+{
+    HostOS_Lock();
+    hostCpuNum = (num == 0) ? 1 : num;
+    HostOS_Reschedule();
+    HostOS_Unlock();
+}
+
+void HostOS_DelayUs(uint64_t us)
+{
+    HostOS_Lock();
+    uint64_t deadline = hostNow + us;
+    while(HostOS_WaitOn(&hostSleepObj, deadline))
+    {
+    }
+    HostOS_Unlock();
+}
+
+void HostOS_Delay(uint32_t tick)
+{
+    HostOS_DelayUs((uint64_t)tick * HOST_TICK_US);
+}
+
+uint64_t HostOS_GetTimeUs()
+{
+    HostOS_Lock();
+    uint64_t res = hostNow;
+    HostOS_Unlock();
+    return res;
+}
+
+uint64_t HostOS_GetRealNs()
+{
+    pthread_once(&hostOnce, HostOS_Init);
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)(now.tv_sec - hostRealBeg.tv_sec) * 1000000000ull + (uint64_t)now.tv_nsec - (uint64_t)hostRealBeg.tv_nsec;
+}
+
+uint64_t HostOS_GetSwitchNum()
+{
+    HostOS_Lock();
+    uint64_t res = hostSwitchNum;
+    HostOS_Unlock();
+    return res;
+}
+
+void HostEvent_Start(HostEvent* ev, uint64_t delay, void (*func)(void*), void* arg)
+{
+    HostOS_Lock();
+    if(ev->_active)
+    {
+        HostEvent** pos = &hostEventList;
+        while(*pos != ev)
+        {
+            pos = &(*pos)->_next;
+        }
+        *pos = ev->_next;
+    }
+
+    ev->_func = func;
+    ev->_arg = arg;
+    ev->_time = hostNow + delay;
+    ev->_seq = hostSeq++;
+    ev->_active = 1;
+
+    HostEvent** pos = &hostEventList;
+    while(*pos != NULL && (*pos)->_time <= ev->_time)
+    {
+        pos = &(*pos)->_next;
+    }
+    ev->_next = *pos;
+    *pos = ev;
+    HostOS_Unlock();
+}
+
+void HostEvent_Stop(HostEvent* ev)
+{
+    HostOS_Lock();
+    if(ev->_active)
+    {
+        HostEvent** pos = &hostEventList;
+        while(*pos != ev)
+        {
+            pos = &(*pos)->_next;
+        }
+        *pos = ev->_next;
+        ev->_active = 0;
+    }
+    HostOS_Unlock();
+}
+
+uint8_t HostOS_WaitObj(void* obj, uint64_t timeout)
+{
+    HostOS_Lock();
+    uint8_t res = HostOS_WaitOn(obj, timeout == HOST_TIME_FOREVER ? HOST_TIME_FOREVER : hostNow + timeout);
+    HostOS_Unlock();
+    return res;
+}
+
+void HostOS_WakeObj(void* obj)
+{
+    HostOS_Lock();
+    HostOS_WakeObjLocked(obj);
+    HostOS_Reschedule();
+    HostOS_Unlock();
+}
+
+//********** 内核与任务 **********//
+
+uint32_t osKernelGetTickCount(void)
+{
+    HostOS_Lock();
+    uint32_t res = (uint32_t)(hostNow / HOST_TICK_US);
+    HostOS_Unlock();
+    return res;
+}
+
+uint32_t osKernelGetTickFreq(void)
+{
+    return 1000000u / HOST_TICK_US;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return osKernelGetTickCount();
+}
+
+TickType_t xTaskGetTickCountFromISR(void)
+{
+    return osKernelGetTickCount();
+}
+
+osThreadId_t osThreadNew(osThreadFunc_t func, void* argument, const osThreadAttr_t* attr)
+{
+    HostOS_Lock();
+    HostThread* t = HostOS_NewThread(
+        (attr != NULL && attr->name != NULL) ? attr->name : "task",
+        (attr != NULL && attr->priority != osPriorityNone) ? attr->priority : osPriorityNormal
+    );
+    t->_func = func;
+    t->_arg = argument;
+    t->_state = HOST_THREAD_READY;
+    t->_readySeq = hostSeq++;
+
+    if(pthread_create(&t->_pthread, NULL, HostOS_ThreadEntry, t) != 0)
+    {
+        HostOS_Fatal("pthread_create failed");
+    }
+    pthread_detach(t->_pthread);
+
+    HostOS_Reschedule();
+    HostOS_Unlock();
+    return t;
+}
+
+osThreadId_t osThreadGetId(void)
+{
+    HostOS_Lock();
+    HostThread* res = hostSelf;
+    HostOS_Unlock();
+    return res;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return osThreadGetId();
+}
+
+uint32_t osThreadFlagsSet(osThreadId_t thread_id, uint32_t flags)
+{
+    HostOS_Lock();
+    HostThread* t = thread_id;
+    t->_flags |= flags;
+    uint32_t res = t->_flags;
+    if(t->_waitObj == &t->_flags)
+    {
+        HostOS_Ready(t, 0);
+    }
+    HostOS_Reschedule();
+    HostOS_Unlock();
+    return res;
+}
+
+uint32_t osThreadFlagsWait(uint32_t flags, uint32_t options, uint32_t timeout)
+{
+    HostOS_Lock();
+    HostThread* self = hostSelf;
+    uint64_t deadline = HostOS_TickDeadline(timeout);
+    uint32_t res = 0;
+    while(1)
+    {
+        uint32_t got = self->_flags & flags;
+        if((options & osFlagsWaitAll) ? (got == flags) : (got != 0))
+        {
+            res = self->_flags;
+            if(!(options & osFlagsNoClear))
+            {
+                self->_flags &= ~flags;
+            }
+            break;
+        }
+        if(timeout == 0 || !HostOS_WaitOn(&self->_flags, deadline))
+        {
+            res = osFlagsErrorTimeout;
+            break;
+        }
+    }
+    HostOS_Unlock();
+    return res;
+}
+
+osStatus_t osDelay(uint32_t ticks)
+{
+    if(xPortIsInsideInterrupt())
+    {
+        return osErrorISR;
+    }
+
+    HostOS_Lock();
+    if(ticks != 0)
+    {
+        uint64_t deadline = HostOS_TickDeadline(ticks);
+        while(HostOS_WaitOn(&hostSleepObj, deadline))
+        {
+        }
+    }
+    HostOS_Unlock();
+    return osOK;
+}
+
+osStatus_t osDelayUntil(uint32_t ticks)
+{
+    HostOS_Lock();
+    uint32_t now = (uint32_t)(hostNow / HOST_TICK_US);
+    uint32_t delay = ticks - now;
+    osStatus_t res = osOK;
+    if(delay == 0 || delay > 0x7FFFFFFFu)
+    {
+        res = osErrorParameter;
+    }
+    else
+    {
+        uint64_t deadline = HostOS_TickDeadline(delay);
+        while(HostOS_WaitOn(&hostSleepObj, deadline))
+        {
+        }
+    }
+    HostOS_Unlock();
+    return res;
+}
+
+//********** 消息队列与信号量 **********//
+
+osMessageQueueId_t osMessageQueueNew(uint32_t msg_count, uint32_t msg_size, const void* attr)
+{
+    (void)attr;
+    HostQueue* q = calloc(1, sizeof(HostQueue));
+    q->_buf = calloc(msg_count, msg_size);
+    q->_size = msg_count;
+    q->_itemSize = msg_size;
+    return q;
+}
+
+osStatus_t osMessageQueuePut(osMessageQueueId_t mq_id, const void* msg_ptr, uint8_t msg_prio, uint32_t timeout)
+{
+    (void)msg_prio;
+    HostQueue* q = mq_id;
+    if(q == NULL || msg_ptr == NULL || (hostIsIsr && timeout != 0))
+    {
+        return osErrorParameter;
+    }
+
+    HostOS_Lock();
+    osStatus_t res = osOK;
+    uint64_t deadline = HostOS_TickDeadline(timeout);
+    while(q->_count == q->_size)
+    {
+        if(timeout == 0)
+        {
+            res = osErrorResource;
+            break;
+        }
+        if(!HostOS_WaitOn(q, deadline))
+        {
+            res = osErrorTimeout;
+            break;
+        }
+    }
+
+    if(res == osOK)
+    {
+        memcpy(q->_buf + ((q->_head + q->_count) % q->_size) * q->_itemSize, msg_ptr, q->_itemSize);
+        q->_count++;
+        HostOS_WakeObjLocked(q);
+        HostOS_Reschedule();
+    }
+    HostOS_Unlock();
+    return res;
+}
+
+osStatus_t osMessageQueueGet(osMessageQueueId_t mq_id, void* msg_ptr, uint8_t* msg_prio, uint32_t timeout)
+{
+    HostQueue* q = mq_id;
+    if(q == NULL || msg_ptr == NULL || (hostIsIsr && timeout != 0))
+    {
+        return osErrorParameter;
+    }
+
+    HostOS_Lock();
+    osStatus_t res = osOK;
+    uint64_t deadline = HostOS_TickDeadline(timeout);
+    while(q->_count == 0)
+    {
+        if(timeout == 0)
+        {
+            res = osErrorResource;
+            break;
+        }
+        if(!HostOS_WaitOn(q, deadline))
+        {
+            res = osErrorTimeout;
+            break;
+        }
+    }
+
+    if(res == osOK)
+    {
+        memcpy(msg_ptr, q->_buf + q->_head * q->_itemSize, q->_itemSize);
+        q->_head = (q->_head + 1) % q->_size;
+        q->_count--;
+        if(msg_prio != NULL)
+        {
+            *msg_prio = 0;
+        }
+        HostOS_WakeObjLocked(q);
+        HostOS_Reschedule();
+    }
+    HostOS_Unlock();
+    return res;
+}
+
+uint32_t osMessageQueueGetCount(osMessageQueueId_t mq_id)
+{
+    HostQueue* q = mq_id;
+    if(q == NULL)
+    {
+        return 0;
+    }
+    HostOS_Lock();
+    uint32_t res = q->_count;
+    HostOS_Unlock();
+    return res;
+}
+
+uint32_t osMessageQueueGetSpace(osMessageQueueId_t mq_id)
+{
+    HostQueue* q = mq_id;
+    if(q == NULL)
+    {
+        return 0;
+    }
+    HostOS_Lock();
+    uint32_t res = q->_size - q->_count;
+    HostOS_Unlock();
+    return res;
+}
+
+osSemaphoreId_t osSemaphoreNew(uint32_t max_count, uint32_t initial_count, const void* attr)
+{
+    (void)attr;
+    HostSemaphore* s = calloc(1, sizeof(HostSemaphore));
+    s->_max = max_count;
+    s->_count = initial_count;
+    return s;
+}
+
+osStatus_t osSemaphoreAcquire(osSemaphoreId_t semaphore_id, uint32_t timeout)
+{
+    HostSemaphore* s = semaphore_id;
+    if(s == NULL || (hostIsIsr && timeout != 0))
+    {
+        return osErrorParameter;
+    }
+
+    HostOS_Lock();
+    osStatus_t res = osOK;
+    uint64_t deadline = HostOS_TickDeadline(timeout);
+    while(s->_count == 0)
+    {
+        if(timeout == 0)
+        {
+            res = osErrorResource;
+            break;
+        }
+        if(!HostOS_WaitOn(s, deadline))
+        {
+            res = osErrorTimeout;
+            break;
+        }
+    }
+    if(res == osOK)
+    {
+        s->_count--;
+    }
+    HostOS_Unlock();
+    return res;
+}
+
+osStatus_t osSemaphoreRelease(osSemaphoreId_t semaphore_id)
+{
+    HostSemaphore* s = semaphore_id;
+    if(s == NULL)
+    {
+        return osErrorParameter;
+    }
+
+    HostOS_Lock();
+    osStatus_t res = osOK;
+    if(s->_count == s->_max)
+    {
+        res = osErrorResource;
+    }
+    else
+    {
+        s->_count++;
+        HostOS_WakeObjLocked(s);
+        HostOS_Reschedule();
+    }
+    HostOS_Unlock();
+    return res;
+}
+
+uint32_t osSemaphoreGetCount(osSemaphoreId_t semaphore_id)
+{
+    HostSemaphore* s = semaphore_id;
+    HostOS_Lock();
+    uint32_t res = s->_count;
+    HostOS_Unlock();
+    return res;
+}
+
+//********** 软件定时器 **********//
+
+// 软件定时器任务, 在到期时执行定时器回调
+static void HostOS_TimerTask(void* arg)
+{
+    (void)arg;
+    HostOS_Lock();
+    while(1)
+    {
+        HostTimer* first = NULL;
+        for(HostTimer* t = hostTimerList; t != NULL; t = t->_next)
+        {
+            if(t->_running && (first == NULL || t->_expire < first->_expire))
+            {
+                first = t;
+            }
+        }
+
+        if(first != NULL && first->_expire <= hostNow)
+        {
+            if(first->_type == osTimerPeriodic)
+            {
+                first->_expire += (uint64_t)first->_period * HOST_TICK_US;
+            }
+            else
+            {
+                first->_running = 0;
+            }
+
+            HostOS_Unlock();
+            first->_func(first->_arg);
+            HostOS_Lock();
+            continue;
+        }
+
+        HostOS_WaitOn(&hostTimerList, first != NULL ? first->_expire : HOST_TIME_FOREVER);
+    }
+}
+
+osTimerId_t osTimerNew(osTimerFunc_t func, osTimerType_t type, void* argument, const void* attr)
+{
+    (void)attr;
+    HostTimer* t = calloc(1, sizeof(HostTimer));
+    t->_func = func;
+    t->_arg = argument;
+    t->_type = type;
+
+    HostOS_Lock();
+    t->_next = hostTimerList;
+    hostTimerList = t;
+    uint8_t is_new = (hostTimerTask == NULL);
+    if(is_new)
+    {
+        // 先占位, 避免重复创建
+        hostTimerTask = hostSelf;
+    }
+    HostOS_Unlock();
+
+    if(is_new)
+    {
+        osThreadAttr_t taskAttr = {
+            .name = "Tmr Svc",
+            .priority = HOST_TIMER_PRIORITY
+        };
+        hostTimerTask = osThreadNew(HostOS_TimerTask, NULL, &taskAttr);
+    }
+    return t;
+}
+
+osStatus_t osTimerStart(osTimerId_t timer_id, uint32_t ticks)
+{
+    HostTimer* t = timer_id;
+    if(t == NULL || ticks == 0)
+    {
+        return osErrorParameter;
+    }
+
+    HostOS_Lock();
+    t->_period = ticks;
+    t->_expire = HostOS_TickDeadline(ticks);
+    t->_running = 1;
+    HostOS_WakeObjLocked(&hostTimerList);
+    HostOS_Reschedule();
+    HostOS_Unlock();
+    return osOK;
+}
+
+osStatus_t osTimerStop(osTimerId_t timer_id)
+{
+    HostTimer* t = timer_id;
+    if(t == NULL)
+    {
+        return osErrorParameter;
+    }
+
+    HostOS_Lock();
+    osStatus_t res = t->_running ? osOK : osErrorResource;
+    t->_running = 0;
+    HostOS_WakeObjLocked(&hostTimerList);
+    HostOS_Unlock();
+    return res;
+}
+
+uint32_t osTimerIsRunning(osTimerId_t timer_id)
+{
+    HostTimer* t = timer_id;
+    HostOS_Lock();
+    uint32_t res = (t != NULL) && t->_running;
+    HostOS_Unlock();
+    return res;
+}
+
+//********** 任务通知 **********//
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action)
+{
+    HostThread* t = task;
+    BaseType_t res = pdPASS;
+
+    HostOS_Lock();
+    uint8_t prev = t->_notifyState;
+    t->_notifyState = HOST_NOTIFY_PENDING;
+    switch(action)
+    {
+    case eSetBits:
+        t->_notifyValue |= value;
+        break;
+    case eIncrement:
+        t->_notifyValue++;
+        break;
+    case eSetValueWithOverwrite:
+        t->_notifyValue = value;
+        break;
+    case eSetValueWithoutOverwrite:
+        if(prev != HOST_NOTIFY_PENDING)
+        {
+            t->_notifyValue = value;
+        }
+        else
+        {
+            res = pdFAIL;
+        }
+        break;
+    default:
+        break;
+    }
+
+    if(prev == HOST_NOTIFY_WAITING && t->_waitObj == &t->_notifyState)
+    {
+        HostOS_Ready(t, 0);
+    }
+    HostOS_Reschedule();
+    HostOS_Unlock();
+    return res;
+}
+
+BaseType_t xTaskNotifyFromISR(TaskHandle_t task, uint32_t value, eNotifyAction action, BaseType_t* woken)
+{
+    if(woken != NULL)
+    {
+        *woken = pdFALSE;
+    }
+    return xTaskNotify(task, value, action);
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t* value, TickType_t timeout)
+{
+    HostOS_Lock();
+    HostThread* self = hostSelf;
+    if(self->_notifyState != HOST_NOTIFY_PENDING)
+    {
+        self->_notifyValue &= ~clear_on_entry;
+        self->_notifyState = HOST_NOTIFY_WAITING;
+        if(timeout != 0)
+        {
+            uint64_t deadline = HostOS_TickDeadline(timeout);
+            while(self->_notifyState == HOST_NOTIFY_WAITING && HostOS_WaitOn(&self->_notifyState, deadline))
+            {
+            }
+        }
+    }
+
+    if(value != NULL)
+    {
+        *value = self->_notifyValue;
+    }
+
+    BaseType_t res = pdFALSE;
+    if(self->_notifyState == HOST_NOTIFY_PENDING)
+    {
+        self->_notifyValue &= ~clear_on_exit;
+        res = pdTRUE;
+    }
+    self->_notifyState = HOST_NOTIFY_NONE;
+    HostOS_Unlock();
+    return res;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t timeout)
+{
+    HostOS_Lock();
+    HostThread* self = hostSelf;
+    if(self->_notifyValue == 0)
+    {
+        self->_notifyState = HOST_NOTIFY_WAITING;
+        if(timeout != 0)
+        {
+            uint64_t deadline = HostOS_TickDeadline(timeout);
+            while(self->_notifyState == HOST_NOTIFY_WAITING && HostOS_WaitOn(&self->_notifyState, deadline))
+            {
+            }
+        }
+    }
+
+    uint32_t res = self->_notifyValue;
+    if(res != 0)
+    {
+        self->_notifyValue = clear_on_exit ? 0 : res - 1;
+    }
+    self->_notifyState = HOST_NOTIFY_NONE;
+    HostOS_Unlock();
+    return res;
+}
+
+//********** 临界区 **********//
+
+BaseType_t xPortIsInsideInterrupt(void)
+{
+    return hostIsIsr;
+}
+
+void vPortEnterCritical(void)
+{
+    pthread_once(&hostOnce, HostOS_Init);
+    pthread_mutex_lock(&hostIntLock);
+    hostCritNest++;
+}
+
+void vPortExitCritical(void)
+{
+    hostCritNest--;
+    pthread_mutex_unlock(&hostIntLock);
+
+    // 推迟到退出临界区时的抢占
+    if(hostCritNest == 0 && !hostIsIsr)
+    {
+        HostOS_Lock();
+        HostOS_Reschedule();
+        HostOS_Unlock();
+    }
+}
+
+UBaseType_t ulPortRaiseBASEPRI(void)
+{
+    vPortEnterCritical();
+    return 0;
+}
+
+void vPortSetBASEPRI(UBaseType_t mask)
+{
+    (void)mask;
+    vPortExitCritical();
+}
+
+//********** 堆 **********//
+
+void* pvPortMalloc(size_t size)
+{
+    pthread_mutex_lock(&hostHeapLock);
+    uint8_t* res = NULL;
+    if(!hostHeapFail && hostHeapUsed + size + HOST_HEAP_HEAD <= HOST_HEAP_SIZE)
+    {
+        res = malloc(size + HOST_HEAP_HEAD);
+    }
+    if(res != NULL)
+    {
+        *(size_t*)res = size;
+        res += HOST_HEAP_HEAD;
+        hostHeapUsed += size + HOST_HEAP_HEAD;
+        if(hostHeapUsed > hostHeapPeak)
+        {
+            hostHeapPeak = hostHeapUsed;
+        }
+        hostHeapBlockNum++;
+        hostHeapAllocNum++;
+    }
+    pthread_mutex_unlock(&hostHeapLock);
+    return res;
+}
+
+void vPortFree(void* mem)
+{
+    if(mem == NULL)
+    {
+        return;
+    }
+
+    uint8_t* head = (uint8_t*)mem - HOST_HEAP_HEAD;
+    pthread_mutex_lock(&hostHeapLock);
+    hostHeapUsed -= *(size_t*)head + HOST_HEAP_HEAD;
+    hostHeapBlockNum--;
+    pthread_mutex_unlock(&hostHeapLock);
+    free(head);
+}
+
+size_t xPortGetFreeHeapSize(void)
+{
+    pthread_mutex_lock(&hostHeapLock);
+    size_t res = HOST_HEAP_SIZE - hostHeapUsed;
+    pthread_mutex_unlock(&hostHeapLock);
+    return res;
+}
+
+size_t xPortGetMinimumEverFreeHeapSize(void)
+{
+    pthread_mutex_lock(&hostHeapLock);
+    size_t res = HOST_HEAP_SIZE - hostHeapPeak;
+    pthread_mutex_unlock(&hostHeapLock);
+    return res;
+}
@@ -0,0 +1,147 @@
+/**
+ * @file host_os.h
+ * @author tonyddg (tonyddg@outlook.com)
+ * @brief 主机模拟内核, 控制 RTOS 行为的函数与模拟外设使用的定时事件
+ * @version 0.1
+ * @date 2024-02-04
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @note 每个任务为一个 pthread 线程, 默认同一时刻只运行一个任务, 按优先级抢占 (与单核 FreeRTOS 一致)
+ * @note 时间为虚拟时间, 仅在所有任务均阻塞时前进到下一个定时事件或等待时限, 任务的计算不消耗虚拟时间
+ * @note 模拟外设的中断以定时事件实现, 在所有任务阻塞时于中断上下文中执行, 因此中断不会打断任务的计算
+ * @note 首次调用内核函数的线程 (测试的主线程) 将自动注册为最高优先级的任务, 以外部观察者的身份驱动测试
+ */
+
+#ifndef HOST_OS_DEF
+#define HOST_OS_DEF
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief 设置当前线程之后的调用是否视为在中断中执行
+ *
+ * @param is_isr 为 1 时 xPortIsInsideInterrupt 返回真, 内存池耗尽时不再回退到堆
+ */
+void HostOS_SetIsr(uint8_t is_isr);
+
+/**
+ * @brief 设置之后的堆分配是否失败
+ *
+ * @param is_fail 为 1 时 pvPortMalloc 总是返回 NULL
+ */
+void HostOS_SetHeapFail(uint8_t is_fail);
+
+/**
+ * @brief 获取尚未释放的堆内存块数, 用于检查泄漏
+ *
+ * @return size_t 尚未释放的内存块数
+ */
+size_t HostOS_GetHeapBlockNum();
+
+/**
+ * @brief 获取累计的堆分配次数
+ *
+ * @return size_t 成功的 pvPortMalloc 调用次数
+ */
+size_t HostOS_GetHeapAllocNum();
+
+/**
+ * @brief 设置同时运行的任务数
+ *
+ * @param num 为 1 时 (默认) 按优先级逐个运行, 大于 1 时就绪任务真正并发运行 (忽略优先级), 用于压力测试无锁结构
+ * @note 并发运行时临界区以全局递归锁互斥
+ */
+void HostOS_SetCpuNum(uint32_t num);
+
+/**
+ * @brief 当前任务阻塞一段虚拟时间, 期间其他任务与模拟中断运行
+ *
+ * @param tick 阻塞的 tick 数 (ms)
+ */
+void HostOS_Delay(uint32_t tick);
+
+/**
+ * @brief 当前任务阻塞一段虚拟时间
+ *
+ * @param us 阻塞的时间 (us)
+ */
+void HostOS_DelayUs(uint64_t us);
+
+/**
+ * @brief 获取虚拟时间
+ *
+ * @return uint64_t 自模拟开始经过的虚拟时间 (us)
+ */
+uint64_t HostOS_GetTimeUs();
+
+/**
+ * @brief 获取自模拟开始经过的实际时间
+ *
+ * @return uint64_t 实际时间 (ns)
+ */
+uint64_t HostOS_GetRealNs();
+
+/**
+ * @brief 获取任务切换次数
+ *
+ * @return uint64_t 从一个任务切换到另一个任务的次数
+ */
+uint64_t HostOS_GetSwitchNum();
+
+/**
+ * @brief 模拟外设的定时事件
+ * @note 回调在中断上下文中执行, 可调用 FromISR 系列函数, 不能阻塞
+ */
+typedef struct HOSTEVENT
+{
+    // 回调函数
+    void (*_func)(void* arg);
+    // 回调参数
+    void* _arg;
+    // 触发时刻 (虚拟时间, us)
+    uint64_t _time;
+    // 同一时刻的事件按启动顺序触发
+    uint64_t _seq;
+    // 是否已启动且尚未触发
+    uint8_t _active;
+    struct HOSTEVENT* _next;
+} HostEvent;
+
+/**
+ * @brief 启动定时事件, 事件已启动时重新设置触发时刻
+ *
+ * @param ev 事件对象, 由调用者分配
+ * @param delay 触发前的虚拟时间 (us)
+ * @param func 回调函数
+ * @param arg 回调参数
+ */
+void HostEvent_Start(HostEvent* ev, uint64_t delay, void (*func)(void*), void* arg);
+
+/**
+ * @brief 取消尚未触发的定时事件
+ *
+ * @param ev 事件对象
+ */
+void HostEvent_Stop(HostEvent* ev);
+
+/**
+ * @brief 当前任务阻塞等待对象被唤醒, 用于模拟外设的阻塞接口
+ *
+ * @param obj 等待的对象
+ * @param timeout 最长等待时间 (us), 为 UINT64_MAX 时永远等待
+ * @return uint8_t 被唤醒时返回 1, 超时返回 0
+ * @note 可能被无关的唤醒提前返回, 调用者需重新检查条件
+ */
+uint8_t HostOS_WaitObj(void* obj, uint64_t timeout);
+
+/**
+ * @brief 唤醒所有等待对象的任务
+ *
+ * @param obj 等待的对象
+ * @note 可在任务与中断中调用
+ */
+void HostOS_WakeObj(void* obj);
+
+#endif
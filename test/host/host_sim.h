@@ -0,0 +1,141 @@
+/**
+ * @file host_sim.h
+ * @author tonyddg (tonyddg@outlook.com)
+ * @brief 主机模拟外设的测试接口, 用于向 huart1, hi2c1 与 USB CDC 输入数据, 取出输出数据并设置故障
+ * @version 0.1
+ * @date 2024-02-04
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @note 外设的传输按波特率 / 时钟频率消耗虚拟时间, 完成与出错回调在中断上下文中执行
+ */
+
+#ifndef HOST_SIM_DEF
+#define HOST_SIM_DEF
+
+#include <stdint.h>
+#include <stddef.h>
+
+//********** UART **********//
+
+/**
+ * @brief 设置 huart1 的波特率, 默认为 115200
+ *
+ * @param baud 波特率, 每字节 10 位
+ */
+void HostUart_SetBaud(uint32_t baud);
+
+/**
+ * @brief 从 RX 线路输入数据, 在之前输入的数据之后按波特率逐字节到达
+ *
+ * @param data 输入的数据
+ * @param len 数据长度
+ * @note 到达时没有启动接收的字节将丢失, 并计入 HostUart_GetLostNum
+ */
+void HostUart_Input(const void* data, size_t len);
+
+/**
+ * @brief 获取 RX 线路上尚未到达的字节数
+ */
+size_t HostUart_GetPendingNum();
+
+/**
+ * @brief 获取到达时没有启动接收而丢失的字节数
+ */
+uint32_t HostUart_GetLostNum();
+
+/**
+ * @brief 取出 TX 线路上已发送完成的数据
+ *
+ * @param buf 目标缓冲区, 总是在末尾补充 \0
+ * @param size 目标缓冲区长度
+ * @return size_t 取出的字节数 (不含 \0)
+ */
+size_t HostUart_GetOutput(char* buf, size_t size);
+
+/**
+ * @brief 在下一个中断时刻触发接收错误, 终止正在进行的接收并调用错误回调
+ *
+ * @param error HAL_UART_ERROR_ 错误码
+ */
+void HostUart_InjectError(uint32_t error);
+
+//********** I2C **********//
+
+// 模拟 I2C 从设备的寄存器数
+#define HOST_I2C_REG_NUM 256
+
+/// @brief 模拟 I2C 从设备, 以 8 位寄存器地址读写
+typedef struct HOSTI2CDEV
+{
+    // 设备地址 (左对齐)
+    uint8_t _daddr;
+    // 是否应答, 为 0 时访问以 AF 错误结束
+    volatile uint8_t _present;
+    // 每次传输额外的时钟延展时间 (us), 可设为大于 I2C 超时以模拟总线挂起
+    volatile uint32_t _stretch;
+    // 寄存器
+    uint8_t _reg[HOST_I2C_REG_NUM];
+    // 完成的读取次数 (数据在传输完成时复制到目标缓冲区)
+    volatile uint32_t _readNum;
+    // 完成的写入次数
+    volatile uint32_t _writeNum;
+} HostI2CDev;
+
+/**
+ * @brief 设置 hi2c1 的时钟频率, 默认为 400kHz
+ *
+ * @param clock 时钟频率 (Hz), 每字节 9 位
+ */
+void HostI2C_SetClock(uint32_t clock);
+
+/**
+ * @brief 在总线上添加一个应答的从设备
+ *
+ * @param daddr 设备地址 (左对齐)
+ * @return HostI2CDev* 从设备, 寄存器初始为 0, 可直接修改
+ */
+HostI2CDev* HostI2C_AddDevice(uint8_t daddr);
+
+/**
+ * @brief 设置 HAL_I2C_Master_Abort_IT 能否终止寄存器读写传输
+ *
+ * @param is_support 默认为 0, 与 F1 HAL 相同, 寄存器读写 (MEM 模式) 时返回 HAL_ERROR; 为 1 时终止传输并调用终止完成回调
+ */
+void HostI2C_SetMemAbort(uint8_t is_support);
+
+/**
+ * @brief 获取被终止 (HAL_I2C_Master_Abort_IT, HAL_DMA_Abort 或 HAL_I2C_DeInit) 的 DMA 传输数
+ */
+uint32_t HostI2C_GetAbortNum();
+
+//********** USB CDC **********//
+
+/**
+ * @brief 主机通过 OUT 端点发送数据, 按最大包长分包, 端点未重新开始接收时回复 NAK 并稍后重发
+ *
+ * @param data 发送的数据
+ * @param len 数据长度
+ */
+void HostUsb_Input(const void* data, size_t len);
+
+/**
+ * @brief 获取 OUT 端点尚未接收的字节数
+ */
+size_t HostUsb_GetPendingNum();
+
+/**
+ * @brief 取出主机通过 IN 端点接收到的数据
+ *
+ * @param buf 目标缓冲区, 总是在末尾补充 \0
+ * @param size 目标缓冲区长度
+ * @return size_t 取出的字节数 (不含 \0)
+ */
+size_t HostUsb_GetOutput(char* buf, size_t size);
+
+/**
+ * @brief 获取 IN 端点发送的零长度包数
+ */
+uint32_t HostUsb_GetZlpNum();
+
+#endif
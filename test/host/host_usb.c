@@ -0,0 +1,173 @@
+#include "host_os.h"
+#include "host_sim.h"
+#include "usbd_cdc_if.h"
+
+#ifdef USE_USB_VPC
+#include "user_usb_vpc.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 模拟 USB CDC 的 OUT 与 IN 端点, 随项目的宏定义编译, 启用 USE_USB_VPC 时调用 user_usb_vpc 的回调
+// 与 CubeMX 生成的 usbd_cdc_if.c 相同, 设备初始化时在 UserRxBufferFS 上开始接收
+
+// 每个数据包的传输时间 (us), 全速设备每帧 (1ms) 可传输多个 64 字节数据包
+#define HOST_USB_PACKET_US 50
+// 主机等待发送的数据
+#define HOST_USB_LINE_SIZE (1u << 16)
+// 主机已接收的数据
+#define HOST_USB_OUT_SIZE (1u << 18)
+
+static uint8_t UserRxBufferFS[APP_RX_DATA_SIZE];
+
+USBD_HandleTypeDef hUsbDeviceFS = {
+    .pRxBuffer = UserRxBufferFS
+};
+PCD_HandleTypeDef hpcd_USB_FS = {
+    .State = HAL_PCD_STATE_READY
+};
+
+// OUT 端点
+static uint8_t hostUsbLine[HOST_USB_LINE_SIZE];
+static size_t hostUsbLineHead = 0;
+static size_t hostUsbLineCount = 0;
+static uint8_t hostUsbRxArmed = 1;
+static HostEvent hostUsbRxEvent;
+
+// IN 端点
+static char hostUsbOut[HOST_USB_OUT_SIZE];
+static size_t hostUsbOutLen = 0;
+static uint32_t hostUsbZlpNum = 0;
+static uint8_t hostUsbTxBusy = 0;
+static const uint8_t* hostUsbTxData = NULL;
+static uint16_t hostUsbTxLen = 0;
+static HostEvent hostUsbTxEvent;
+
+static void HostUsb_RxPacket(void* arg)
+{
+    (void)arg;
+    if(!hostUsbRxArmed || hostUsbLineCount == 0)
+    {
+        return;
+    }
+
+    // 端点接收一个数据包后自动回复 NAK, 直到重新开始接收
+    uint32_t len = (hostUsbLineCount < CDC_DATA_FS_MAX_PACKET_SIZE) ? hostUsbLineCount : CDC_DATA_FS_MAX_PACKET_SIZE;
+    uint8_t* buf = hUsbDeviceFS.pRxBuffer;
+    for(uint32_t i = 0; i < len; i++)
+    {
+        buf[i] = hostUsbLine[hostUsbLineHead];
+        hostUsbLineHead = (hostUsbLineHead + 1) % HOST_USB_LINE_SIZE;
+    }
+    hostUsbLineCount -= len;
+    hostUsbRxArmed = 0;
+
+    #ifdef USE_USB_VPC
+        USB_VPC_ReceiveCmpltCallBack(buf, len);
+    #else
+        USBD_CDC_SetRxBuffer(&hUsbDeviceFS, UserRxBufferFS);
+        USBD_CDC_ReceivePacket(&hUsbDeviceFS);
+    #endif
+}
+
+static void HostUsb_RxSchedule()
+{
+    if(hostUsbRxArmed && hostUsbLineCount > 0 && !hostUsbRxEvent._active)
+    {
+        HostEvent_Start(&hostUsbRxEvent, HOST_USB_PACKET_US, HostUsb_RxPacket, NULL);
+    }
+}
+
+void HostUsb_Input(const void* data, size_t len)
+{
+    const uint8_t* src = data;
+    if(hostUsbLineCount + len > HOST_USB_LINE_SIZE)
+    {
+        fprintf(stderr, "host_usb: OUT input overflow\n");
+        abort();
+    }
+    for(size_t i = 0; i < len; i++)
+    {
+        hostUsbLine[(hostUsbLineHead + hostUsbLineCount) % HOST_USB_LINE_SIZE] = src[i];
+        hostUsbLineCount++;
+    }
+    HostUsb_RxSchedule();
+}
+
+size_t HostUsb_GetPendingNum()
+{
+    return hostUsbLineCount;
+}
+
+uint8_t USBD_CDC_SetRxBuffer(USBD_HandleTypeDef* pdev, uint8_t* pbuff)
+{
+    pdev->pRxBuffer = pbuff;
+    return USBD_OK;
+}
+
+uint8_t USBD_CDC_ReceivePacket(USBD_HandleTypeDef* pdev)
+{
+    (void)pdev;
+    hostUsbRxArmed = 1;
+    HostUsb_RxSchedule();
+    return USBD_OK;
+}
+
+static void HostUsb_TxDone(void* arg)
+{
+    (void)arg;
+    if(hostUsbOutLen + hostUsbTxLen > HOST_USB_OUT_SIZE)
+    {
+        fprintf(stderr, "host_usb: output capture overflow\n");
+        abort();
+    }
+    memcpy(hostUsbOut + hostUsbOutLen, hostUsbTxData, hostUsbTxLen);
+    hostUsbOutLen += hostUsbTxLen;
+    if(hostUsbTxLen == 0)
+    {
+        hostUsbZlpNum++;
+    }
+    hostUsbTxBusy = 0;
+
+    #ifdef USE_USB_VPC
+        USB_VPC_TransmitCmpltCallBack();
+    #endif
+}
+
+uint8_t CDC_Transmit_FS(uint8_t* Buf, uint16_t Len)
+{
+    if(hostUsbTxBusy)
+    {
+        return USBD_BUSY;
+    }
+
+    // 数据在主机确认接收 (传输完成) 时才复制, 传输期间释放或修改缓冲区的错误将反映在输出中
+    hostUsbTxBusy = 1;
+    hostUsbTxData = Buf;
+    hostUsbTxLen = Len;
+    uint32_t packetNum = Len / CDC_DATA_FS_MAX_PACKET_SIZE + ((Len % CDC_DATA_FS_MAX_PACKET_SIZE != 0 || Len == 0) ? 1 : 0);
+    HostEvent_Start(&hostUsbTxEvent, (uint64_t)packetNum * HOST_USB_PACKET_US, HostUsb_TxDone, NULL);
+    return USBD_OK;
+}
+
+size_t HostUsb_GetOutput(char* buf, size_t size)
+{
+    size_t len = (hostUsbOutLen < size - 1) ? hostUsbOutLen : size - 1;
+    memcpy(buf, hostUsbOut, len);
+    buf[len] = 0;
+    memmove(hostUsbOut, hostUsbOut + len, hostUsbOutLen - len);
+    hostUsbOutLen -= len;
+    return len;
+}
+
+uint32_t HostUsb_GetZlpNum()
+{
+    return hostUsbZlpNum;
+}
+
+PCD_StateTypeDef HAL_PCD_GetState(PCD_HandleTypeDef* hpcd)
+{
+    return hpcd->State;
+}
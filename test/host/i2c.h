@@ -0,0 +1,21 @@
+/**
+ * @file i2c.h
+ * @author tonyddg (tonyddg@outlook.com)
+ * @brief 主机模拟使用的 i2c.h, 对应 CubeMX 生成的同名文件, hi2c1 由 host_hal.c 模拟
+ * @version 0.1
+ * @date 2024-02-04
+ * 
+ * @copyright Copyright (c) 2024
+ * 
+ */
+
+#ifndef HOST_I2C_DEF
+#define HOST_I2C_DEF
+
+#include "main.h"
+
+extern I2C_HandleTypeDef hi2c1;
+extern DMA_HandleTypeDef hdma_i2c1_rx;
+extern DMA_HandleTypeDef hdma_i2c1_tx;
+
+#endif
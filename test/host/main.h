@@ -0,0 +1,22 @@
+/**
+ * @file main.h
+ * @author tonyddg (tonyddg@outlook.com)
+ * @brief 主机模拟使用的 main.h, 对应 CubeMX 生成的同名文件
+ * @version 0.1
+ * @date 2024-02-04
+ * 
+ * @copyright Copyright (c) 2024
+ * 
+ */
+
+#ifndef HOST_MAIN_DEF
+#define HOST_MAIN_DEF
+
+#include "stm32f1xx_hal.h"
+
+/**
+ * @brief 错误处理, 主机上输出错误并终止测试
+ */
+void Error_Handler(void);
+
+#endif
@@ -0,0 +1,245 @@
+/**
+ * @file stm32f1xx_hal.h
+ * @author tonyddg (tonyddg@outlook.com)
+ * @brief 主机模拟使用的 HAL, 仅包含 user 中使用的部分, 由 host_hal.c 以虚拟时钟上的定时事件模拟外设
+ * @version 0.1
+ * @date 2024-02-04
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @note 类型, 常量与函数的名称与取值同 STM32F1 HAL, 回调注册相当于启用 USE_HAL_UART_REGISTER_CALLBACKS 与 USE_HAL_I2C_REGISTER_CALLBACKS
+ */
+
+#ifndef HOST_STM32F1XX_HAL_DEF
+#define HOST_STM32F1XX_HAL_DEF
+
+#include <stdint.h>
+
+typedef enum
+{
+    HAL_OK = 0x00U,
+    HAL_ERROR = 0x01U,
+    HAL_BUSY = 0x02U,
+    HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+#define HAL_MAX_DELAY 0xFFFFFFFFU
+
+uint32_t HAL_GetTick(void);
+
+//********** 内核 **********//
+
+extern uint32_t SystemCoreClock;
+
+typedef struct
+{
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct
+{
+    volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+/**
+ * @brief 更新并返回模拟的 DWT, 周期计数由虚拟时间与实际经过的时间按 SystemCoreClock 换算
+ */
+DWT_Type* HostDWT_Get(void);
+extern CoreDebug_Type hostCoreDebug;
+
+#define DWT (HostDWT_Get())
+#define CoreDebug (&hostCoreDebug)
+#define DWT_CTRL_CYCCNTENA_Msk (1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk (1UL << 24)
+
+//********** GPIO **********//
+
+typedef struct
+{
+    volatile uint32_t ODR;
+} GPIO_TypeDef;
+
+extern GPIO_TypeDef hostGPIOC;
+#define GPIOC (&hostGPIOC)
+#define GPIO_PIN_13 ((uint16_t)0x2000)
+
+void HAL_GPIO_TogglePin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin);
+
+//********** DMA **********//
+
+typedef struct
+{
+    volatile uint32_t CCR;
+    volatile uint32_t CNDTR;
+} DMA_Channel_TypeDef;
+
+typedef struct
+{
+    uint32_t Mode;
+} DMA_InitTypeDef;
+
+typedef struct __DMA_HandleTypeDef
+{
+    DMA_Channel_TypeDef* Instance;
+    DMA_InitTypeDef Init;
+} DMA_HandleTypeDef;
+
+#define DMA_NORMAL 0x00000000U
+#define DMA_CIRCULAR 0x00000020U
+
+#define DMA_IT_TC 0x00000002U
+#define DMA_IT_HT 0x00000004U
+#define DMA_IT_TE 0x00000008U
+
+#define __HAL_DMA_GET_COUNTER(__HANDLE__) ((__HANDLE__)->Instance->CNDTR)
+#define __HAL_DMA_DISABLE_IT(__HANDLE__, __INTERRUPT__) ((__HANDLE__)->Instance->CCR &= ~(__INTERRUPT__))
+
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef* hdma);
+
+//********** UART **********//
+
+typedef enum
+{
+    HAL_UART_STATE_RESET = 0x00U,
+    HAL_UART_STATE_READY = 0x20U,
+    HAL_UART_STATE_BUSY = 0x24U,
+    HAL_UART_STATE_BUSY_TX = 0x21U,
+    HAL_UART_STATE_BUSY_RX = 0x22U,
+    HAL_UART_STATE_BUSY_TX_RX = 0x23U,
+    HAL_UART_STATE_TIMEOUT = 0xA0U,
+    HAL_UART_STATE_ERROR = 0xE0U
+} HAL_UART_StateTypeDef;
+
+typedef enum
+{
+    HAL_UART_TX_HALFCOMPLETE_CB_ID = 0x00U,
+    HAL_UART_TX_COMPLETE_CB_ID = 0x01U,
+    HAL_UART_RX_HALFCOMPLETE_CB_ID = 0x02U,
+    HAL_UART_RX_COMPLETE_CB_ID = 0x03U,
+    HAL_UART_ERROR_CB_ID = 0x04U
+} HAL_UART_CallbackIDTypeDef;
+
+#define HAL_UART_ERROR_NONE 0x00000000U
+#define HAL_UART_ERROR_PE 0x00000001U
+#define HAL_UART_ERROR_NE 0x00000002U
+#define HAL_UART_ERROR_FE 0x00000004U
+#define HAL_UART_ERROR_ORE 0x00000008U
+#define HAL_UART_ERROR_DMA 0x00000010U
+
+typedef struct __UART_HandleTypeDef UART_HandleTypeDef;
+typedef void (*pUART_CallbackTypeDef)(UART_HandleTypeDef* huart);
+typedef void (*pUART_RxEventCallbackTypeDef)(UART_HandleTypeDef* huart, uint16_t Pos);
+
+struct __UART_HandleTypeDef
+{
+    uint8_t* pRxBuffPtr;
+    uint16_t RxXferSize;
+    DMA_HandleTypeDef* hdmatx;
+    DMA_HandleTypeDef* hdmarx;
+    volatile HAL_UART_StateTypeDef gState;
+    volatile HAL_UART_StateTypeDef RxState;
+    volatile uint32_t ErrorCode;
+    pUART_CallbackTypeDef TxCpltCallback;
+    pUART_CallbackTypeDef ErrorCallback;
+    pUART_RxEventCallbackTypeDef RxEventCallback;
+};
+
+HAL_StatusTypeDef HAL_UART_RegisterCallback(UART_HandleTypeDef* huart, HAL_UART_CallbackIDTypeDef CallbackID, pUART_CallbackTypeDef pCallback);
+HAL_StatusTypeDef HAL_UART_RegisterRxEventCallback(UART_HandleTypeDef* huart, pUART_RxEventCallbackTypeDef pCallback);
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef* huart, const uint8_t* pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef* huart, const uint8_t* pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle(UART_HandleTypeDef* huart, uint8_t* pData, uint16_t Size, uint16_t* RxLen, uint32_t Timeout);
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef* huart, uint8_t* pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_AbortReceive(UART_HandleTypeDef* huart);
+HAL_UART_StateTypeDef HAL_UART_GetState(UART_HandleTypeDef* huart);
+
+//********** I2C **********//
+
+typedef enum
+{
+    HAL_I2C_STATE_RESET = 0x00U,
+    HAL_I2C_STATE_READY = 0x20U,
+    HAL_I2C_STATE_BUSY = 0x24U,
+    HAL_I2C_STATE_BUSY_TX = 0x21U,
+    HAL_I2C_STATE_BUSY_RX = 0x22U,
+    HAL_I2C_STATE_ABORT = 0x60U,
+    HAL_I2C_STATE_TIMEOUT = 0xA0U,
+    HAL_I2C_STATE_ERROR = 0xE0U
+} HAL_I2C_StateTypeDef;
+
+typedef enum
+{
+    HAL_I2C_MODE_NONE = 0x00U,
+    HAL_I2C_MODE_MASTER = 0x10U,
+    HAL_I2C_MODE_SLAVE = 0x20U,
+    HAL_I2C_MODE_MEM = 0x40U
+} HAL_I2C_ModeTypeDef;
+
+typedef enum
+{
+    HAL_I2C_MASTER_TX_COMPLETE_CB_ID = 0x00U,
+    HAL_I2C_MASTER_RX_COMPLETE_CB_ID = 0x01U,
+    HAL_I2C_MEM_TX_COMPLETE_CB_ID = 0x06U,
+    HAL_I2C_MEM_RX_COMPLETE_CB_ID = 0x07U,
+    HAL_I2C_ERROR_CB_ID = 0x08U,
+    HAL_I2C_ABORT_CB_ID = 0x09U
+} HAL_I2C_CallbackIDTypeDef;
+
+#define HAL_I2C_ERROR_NONE 0x00000000U
+#define HAL_I2C_ERROR_BERR 0x00000001U
+#define HAL_I2C_ERROR_ARLO 0x00000002U
+#define HAL_I2C_ERROR_AF 0x00000004U
+#define HAL_I2C_ERROR_OVR 0x00000008U
+#define HAL_I2C_ERROR_DMA 0x00000010U
+#define HAL_I2C_ERROR_TIMEOUT 0x00000020U
+
+#define I2C_MEMADD_SIZE_8BIT 0x00000001U
+#define I2C_MEMADD_SIZE_16BIT 0x00000010U
+
+typedef struct __I2C_HandleTypeDef I2C_HandleTypeDef;
+typedef void (*pI2C_CallbackTypeDef)(I2C_HandleTypeDef* hi2c);
+
+struct __I2C_HandleTypeDef
+{
+    DMA_HandleTypeDef* hdmatx;
+    DMA_HandleTypeDef* hdmarx;
+    volatile HAL_I2C_StateTypeDef State;
+    volatile HAL_I2C_ModeTypeDef Mode;
+    volatile uint32_t ErrorCode;
+    pI2C_CallbackTypeDef MemTxCpltCallback;
+    pI2C_CallbackTypeDef MemRxCpltCallback;
+    pI2C_CallbackTypeDef ErrorCallback;
+    pI2C_CallbackTypeDef AbortCpltCallback;
+};
+
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef* hi2c);
+HAL_StatusTypeDef HAL_I2C_DeInit(I2C_HandleTypeDef* hi2c);
+HAL_StatusTypeDef HAL_I2C_RegisterCallback(I2C_HandleTypeDef* hi2c, HAL_I2C_CallbackIDTypeDef CallbackID, pI2C_CallbackTypeDef pCallback);
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Mem_Write_DMA(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size);
+HAL_StatusTypeDef HAL_I2C_Mem_Read_DMA(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size);
+HAL_StatusTypeDef HAL_I2C_IsDeviceReady(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint32_t Trials, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Master_Abort_IT(I2C_HandleTypeDef* hi2c, uint16_t DevAddress);
+HAL_I2C_StateTypeDef HAL_I2C_GetState(I2C_HandleTypeDef* hi2c);
+
+//********** PCD **********//
+
+typedef enum
+{
+    HAL_PCD_STATE_RESET = 0x00U,
+    HAL_PCD_STATE_READY = 0x01U,
+    HAL_PCD_STATE_ERROR = 0x02U,
+    HAL_PCD_STATE_BUSY = 0x03U,
+    HAL_PCD_STATE_TIMEOUT = 0x04U
+} PCD_StateTypeDef;
+
+typedef struct
+{
+    volatile PCD_StateTypeDef State;
+} PCD_HandleTypeDef;
+
+PCD_StateTypeDef HAL_PCD_GetState(PCD_HandleTypeDef* hpcd);
+
+#endif
@@ -0,0 +1,21 @@
+/**
+ * @file usart.h
+ * @author tonyddg (tonyddg@outlook.com)
+ * @brief 主机模拟使用的 usart.h, 对应 CubeMX 生成的同名文件, huart1 由 host_hal.c 模拟
+ * @version 0.1
+ * @date 2024-02-04
+ * 
+ * @copyright Copyright (c) 2024
+ * 
+ */
+
+#ifndef HOST_USART_DEF
+#define HOST_USART_DEF
+
+#include "main.h"
+
+extern UART_HandleTypeDef huart1;
+extern DMA_HandleTypeDef hdma_usart1_rx;
+extern DMA_HandleTypeDef hdma_usart1_tx;
+
+#endif
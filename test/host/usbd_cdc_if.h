@@ -0,0 +1,41 @@
+/**
+ * @file usbd_cdc_if.h
+ * @author tonyddg (tonyddg@outlook.com)
+ * @brief 主机模拟使用的 usbd_cdc_if.h, 包含 USB 中间件中 user 使用的部分, 由 host_usb.c 模拟 CDC 端点
+ * @version 0.1
+ * @date 2024-02-04
+ * 
+ * @copyright Copyright (c) 2024
+ * 
+ */
+
+#ifndef HOST_USBD_CDC_IF_DEF
+#define HOST_USBD_CDC_IF_DEF
+
+#include "main.h"
+
+#define APP_RX_DATA_SIZE 1000
+#define APP_TX_DATA_SIZE 1000
+#define CDC_DATA_FS_MAX_PACKET_SIZE 64U
+
+typedef enum
+{
+    USBD_OK = 0U,
+    USBD_BUSY,
+    USBD_EMEM,
+    USBD_FAIL
+} USBD_StatusTypeDef;
+
+typedef struct
+{
+    // OUT 端点接收缓冲区
+    uint8_t* pRxBuffer;
+} USBD_HandleTypeDef;
+
+extern USBD_HandleTypeDef hUsbDeviceFS;
+
+uint8_t CDC_Transmit_FS(uint8_t* Buf, uint16_t Len);
+uint8_t USBD_CDC_SetRxBuffer(USBD_HandleTypeDef* pdev, uint8_t* pbuff);
+uint8_t USBD_CDC_ReceivePacket(USBD_HandleTypeDef* pdev);
+
+#endif
@@ -0,0 +1,139 @@
+#include "bin_frame.h"
+#include "host_os.h"
+#include "test_util.h"
+
+// 模拟分段接收: 依次返回预先准备的数据块, 之后超时
+static ConstBuf* recChunk[16];
+static size_t recChunkNum = 0;
+static size_t recChunkIdx = 0;
+
+static ConstBuf* Receive(uint32_t timeout)
+{
+    if(recChunkIdx < recChunkNum)
+    {
+        return recChunk[recChunkIdx++];
+    }
+    HostOS_Delay(timeout);
+    return NULL;
+}
+
+/**
+ * @brief 将数据按 step 字节切分为接收数据块 (作为字符串接收, 末尾补充 \0)
+ */
+static void FeedChunks(const uint8_t* data, size_t len, size_t step)
+{
+    recChunkNum = 0;
+    recChunkIdx = 0;
+    while(len > 0 && recChunkNum < 16)
+    {
+        size_t segLen = (len < step) ? len : step;
+        ConstBuf* chunk = ConstBuf_CreateEmpty(segLen + 1);
+        memcpy(chunk->_buf, data, segLen);
+        chunk->_buf[segLen] = 0;
+        recChunk[recChunkNum++] = chunk;
+        data += segLen;
+        len -= segLen;
+    }
+}
+
+static void TestCrc()
+{
+    // CRC-16/CCITT-FALSE 的标准校验值
+    TEST_CHECK(BinFrame_Crc16(0xFFFF, (const uint8_t*)"123456789", 9) == 0x29B1);
+    // 分段计算与一次计算结果相同
+    uint16_t crc = BinFrame_Crc16(0xFFFF, (const uint8_t*)"1234", 4);
+    TEST_CHECK(BinFrame_Crc16(crc, (const uint8_t*)"56789", 5) == 0x29B1);
+}
+
+static void TestEncode()
+{
+    const uint8_t data[] = {0x11, 0x00, 0x22};
+    ConstBuf* frame = BinFrame_Encode(data, sizeof(data));
+    TEST_CHECK(frame != NULL);
+    if(frame == NULL)
+    {
+        return;
+    }
+
+    // 编码结果中只有帧结尾为 0x00
+    TEST_CHECK(frame->_len <= BIN_FRAME_ENCODE_SIZE(sizeof(data)));
+    TEST_CHECK(frame->_buf[frame->_len - 1] == 0);
+    TEST_CHECK(memchr(frame->_buf, 0, frame->_len - 1) == NULL);
+    ConstBuf_Delete(frame);
+}
+
+static void TestRoundTrip(size_t len, size_t step)
+{
+    uint8_t data[300];
+    for(size_t i = 0; i < len; i++)
+    {
+        // 包含 0x00 以及长度超过 254 的非零段
+        data[i] = (len > 254) ? (uint8_t)(i % 255 + 1) : (uint8_t)(i * 7);
+    }
+
+    ConstBuf* frame = BinFrame_Encode(data, len);
+    TEST_CHECK(frame != NULL);
+    if(frame == NULL)
+    {
+        return;
+    }
+    TEST_CHECK(frame->_len <= BIN_FRAME_ENCODE_SIZE(len));
+    FeedChunks(frame->_buf, frame->_len, step);
+    ConstBuf_Delete(frame);
+
+    BinFrameReader reader;
+    TEST_CHECK(BinFrameReader_Init(&reader, 300, 1) == 1);
+    ConstBuf* res = BinFrameReader_Read(&reader, Receive, 10);
+    TEST_CHECK(res != NULL);
+    if(res != NULL)
+    {
+        TEST_CHECK(res->_len == len);
+        TEST_CHECK_MEM(res->_buf, data, len);
+        ConstBuf_Delete(res);
+    }
+    TEST_CHECK(reader._crcErrorNum == 0);
+
+    // 没有更多数据时超时
+    TEST_CHECK(BinFrameReader_Read(&reader, Receive, 10) == NULL);
+}
+
+static void TestCrcError()
+{
+    const uint8_t data[] = {1, 2, 3, 4};
+    ConstBuf* bad = BinFrame_Encode(data, sizeof(data));
+    ConstBuf* good = BinFrame_Encode(data, sizeof(data));
+    if(bad == NULL || good == NULL)
+    {
+        TEST_CHECK(0);
+        return;
+    }
+
+    // 修改第一帧的一个数据字节 (不改变 COBS 结构), 校验失败后应继续取出第二帧
+    uint8_t stream[32];
+    memcpy(stream, bad->_buf, bad->_len);
+    stream[2] ^= 0x40;
+    memcpy(stream + bad->_len, good->_buf, good->_len);
+    FeedChunks(stream, bad->_len + good->_len, 5);
+
+    BinFrameReader reader;
+    TEST_CHECK(BinFrameReader_Init(&reader, 16, 1) == 1);
+    ConstBuf* res = BinFrameReader_Read(&reader, Receive, 10);
+    TEST_CHECK(res != NULL && res->_len == sizeof(data) && memcmp(res->_buf, data, sizeof(data)) == 0);
+    TEST_CHECK(reader._crcErrorNum == 1);
+
+    ConstBuf_Delete(res);
+    ConstBuf_Delete(bad);
+    ConstBuf_Delete(good);
+}
+
+int main()
+{
+    TestCrc();
+    TestEncode();
+    TestRoundTrip(0, 1);
+    TestRoundTrip(3, 1);
+    TestRoundTrip(40, 7);
+    TestRoundTrip(300, 64);
+    TestCrcError();
+    return TEST_RESULT();
+}
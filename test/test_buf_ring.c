@@ -0,0 +1,219 @@
+#include "buf_ring.h"
+#include "cmsis_os.h"
+#include "host_os.h"
+#include "test_util.h"
+
+#include <stdlib.h>
+
+// 并发压力测试中插入的数据块数
+#define STRESS_NUM 2000000
+// 并发压力测试的队列长度, 较短的队列使插入时丢弃与取出频繁竞争
+#define STRESS_RING_SIZE 4
+
+static void TestFifo()
+{
+    ConstBuf* item[4];
+    BufRing ring;
+    BufRing_Init(&ring, item, 4);
+
+    ConstBuf* a = ConstBuf_CreateByByte('a');
+    ConstBuf* b = ConstBuf_CreateByByte('b');
+    TEST_CHECK(BufRing_Push(&ring, a) == NULL);
+    TEST_CHECK(BufRing_Push(&ring, b) == NULL);
+    TEST_CHECK(BufRing_GetCount(&ring) == 2);
+
+    TEST_CHECK(BufRing_Pop(&ring, 0) == a);
+    TEST_CHECK(BufRing_Pop(&ring, 0) == b);
+    TEST_CHECK(BufRing_Pop(&ring, 0) == NULL);
+    TEST_CHECK(BufRing_GetCount(&ring) == 0);
+
+    ConstBuf_Delete(a);
+    ConstBuf_Delete(b);
+}
+
+static void TestDropOldest()
+{
+    ConstBuf* item[4];
+    BufRing ring;
+    BufRing_Init(&ring, item, 4);
+
+    ConstBuf* data[6];
+    for(size_t i = 0; i < 6; i++)
+    {
+        data[i] = ConstBuf_CreateByByte((uint8_t)i);
+    }
+
+    // 队列满时返回最早的数据块并计数
+    for(size_t i = 0; i < 4; i++)
+    {
+        TEST_CHECK(BufRing_Push(&ring, data[i]) == NULL);
+    }
+    TEST_CHECK(BufRing_Push(&ring, data[4]) == data[0]);
+    TEST_CHECK(BufRing_Push(&ring, data[5]) == data[1]);
+    TEST_CHECK(ring._dropNum == 2);
+    TEST_CHECK(BufRing_GetCount(&ring) == 4);
+
+    for(size_t i = 2; i < 6; i++)
+    {
+        TEST_CHECK(BufRing_Pop(&ring, 0) == data[i]);
+    }
+    TEST_CHECK(BufRing_Pop(&ring, 0) == NULL);
+
+    for(size_t i = 0; i < 6; i++)
+    {
+        ConstBuf_Delete(data[i]);
+    }
+}
+
+static void TestWrap()
+{
+    ConstBuf* item[2];
+    BufRing ring;
+    BufRing_Init(&ring, item, 2);
+
+    // 反复插入与取出, 计数跨过数组长度多次
+    ConstBuf* data = ConstBuf_CreateByByte(1);
+    for(size_t i = 0; i < 1000; i++)
+    {
+        TEST_CHECK(BufRing_Push(&ring, data) == NULL);
+        TEST_CHECK(BufRing_Pop(&ring, 0) == data);
+    }
+    TEST_CHECK(ring._dropNum == 0);
+    ConstBuf_Delete(data);
+}
+
+static void TestPopTimeout()
+{
+    // 等待时绑定的信号需在绑定后保持有效, 因此使用静态对象
+    static ConstBuf* item[2];
+    static BufRing ring;
+    BufRing_Init(&ring, item, 2);
+
+    // 队列为空时等待到超时
+    uint32_t beg = osKernelGetTickCount();
+    TEST_CHECK(BufRing_Pop(&ring, 20) == NULL);
+    TEST_CHECK(osKernelGetTickCount() - beg >= 20);
+
+    // 等待者已绑定, 之后插入的数据块发出信号, 可被等待取出
+    ConstBuf* data = ConstBuf_CreateByByte(1);
+    HostOS_SetIsr(1);
+    TEST_CHECK(BufRing_Push(&ring, data) == NULL);
+    HostOS_SetIsr(0);
+    TEST_CHECK(BufRing_Pop(&ring, osWaitForever) == data);
+    ConstBuf_Delete(data);
+}
+
+//********** 并发压力测试 **********//
+
+// 队列不访问数据块的内容, 压力测试中直接以序号 (从 1 开始) 作为数据块句柄
+#define STRESS_ITEM(seq) ((ConstBuf*)(uintptr_t)(seq))
+#define STRESS_SEQ(item) ((uint32_t)(uintptr_t)(item))
+
+static ConstBuf* stressItem[STRESS_RING_SIZE];
+static BufRing stressRing;
+// 每个序号被取出或丢弃的次数, 应恰好为 1
+static uint8_t* stressSeen = NULL;
+static volatile uint8_t stressDone = 0;
+static uint32_t stressPopNum = 0;
+static uint32_t stressDropNum = 0;
+static uint32_t stressOrderErr = 0;
+
+static void StressProducerTask(void* args)
+{
+    (void)args;
+    uint32_t lastDrop = 0;
+    for(uint32_t seq = 1; seq <= STRESS_NUM; seq++)
+    {
+        ConstBuf* drop = BufRing_Push(&stressRing, STRESS_ITEM(seq));
+        if(drop != NULL)
+        {
+            // 丢弃的总是最早的数据块, 序号递增
+            if(STRESS_SEQ(drop) <= lastDrop)
+            {
+                stressOrderErr++;
+            }
+            lastDrop = STRESS_SEQ(drop);
+            stressSeen[lastDrop]++;
+            stressDropNum++;
+        }
+    }
+    stressDone = 1;
+}
+
+static void StressConsumerTask(void* args)
+{
+    (void)args;
+    uint32_t last = 0;
+    while(1)
+    {
+        // 队列为空时阻塞等待, 生产者结束后所有任务阻塞, 虚拟时间推进而超时退出
+        ConstBuf* data = BufRing_Pop(&stressRing, 1);
+        if(data == NULL)
+        {
+            if(stressDone && BufRing_GetCount(&stressRing) == 0)
+            {
+                break;
+            }
+            continue;
+        }
+        if(STRESS_SEQ(data) <= last)
+        {
+            stressOrderErr++;
+        }
+        last = STRESS_SEQ(data);
+        stressSeen[last]++;
+        stressPopNum++;
+    }
+}
+
+static void TestStress()
+{
+    // 生产者与消费者在两个线程上真正并发运行, 队列满时插入的丢弃与取出竞争同一个数据块
+    // 每个数据块恰好被取出或丢弃一次, 且取出与丢弃的顺序均与插入顺序一致
+    stressSeen = calloc(STRESS_NUM + 1, 1);
+    BufRing_Init(&stressRing, stressItem, STRESS_RING_SIZE);
+
+    osThreadAttr_t attr = {
+        .name = "Producer",
+        .priority = osPriorityNormal
+    };
+    HostOS_SetCpuNum(2);
+    uint64_t beg = HostOS_GetRealNs();
+    osThreadNew(StressProducerTask, NULL, &attr);
+    attr.name = "Consumer";
+    osThreadNew(StressConsumerTask, NULL, &attr);
+
+    // 两个任务均退出后主线程才会被唤醒
+    HostOS_Delay(1);
+    uint64_t ns = HostOS_GetRealNs() - beg;
+    HostOS_SetCpuNum(1);
+
+    uint32_t missNum = 0;
+    for(uint32_t seq = 1; seq <= STRESS_NUM; seq++)
+    {
+        if(stressSeen[seq] != 1)
+        {
+            missNum++;
+        }
+    }
+    TEST_CHECK(missNum == 0);
+    TEST_CHECK(stressOrderErr == 0);
+    TEST_CHECK(stressPopNum + stressDropNum == STRESS_NUM);
+    TEST_CHECK(stressRing._dropNum == stressDropNum);
+    TEST_CHECK(BufRing_GetCount(&stressRing) == 0);
+    free(stressSeen);
+
+    printf("stress: %u pushed, %u popped, %u dropped, %.2f M ops/s\n",
+        STRESS_NUM, stressPopNum, stressDropNum,
+        (double)(STRESS_NUM + stressPopNum) * 1000.0 / (double)ns);
+}
+
+int main()
+{
+    TestFifo();
+    TestDropOldest();
+    TestWrap();
+    TestPopTimeout();
+    TestStress();
+    return TEST_RESULT();
+}
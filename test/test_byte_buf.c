@@ -0,0 +1,402 @@
+#include "byte_buf.h"
+#include "cmsis_os.h"
+#include "host_os.h"
+#include "test_util.h"
+
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+// 内存池总块数 (16 + 8 + 4)
+#define POOL_BLOCK_NUM 28
+// 压力测试与性能测试的循环次数
+#define POOL_CYCLE_NUM 2000000
+// 格式化输出性能测试的循环次数
+#define PRINTF_CYCLE_NUM 1000000
+
+static uint8_t* releaseBuf = NULL;
+static uint32_t releaseNum = 0;
+
+static void Release(uint8_t* buf)
+{
+    releaseBuf = buf;
+    releaseNum++;
+}
+
+/**
+ * @brief 在中断中 (不回退到堆) 分配 1 字节对象直到内存池耗尽, 之后全部释放
+ *
+ * @return size_t 可分配的对象数
+ */
+static size_t PoolCapacity()
+{
+    ConstBuf* hold[POOL_BLOCK_NUM + 1];
+    size_t holdNum = 0;
+
+    HostOS_SetIsr(1);
+    while(holdNum < POOL_BLOCK_NUM + 1 && (hold[holdNum] = ConstBuf_CreateEmpty(1)) != NULL)
+    {
+        holdNum++;
+    }
+    for(size_t i = 0; i < holdNum; i++)
+    {
+        ConstBuf_Delete(hold[i]);
+    }
+    HostOS_SetIsr(0);
+
+    return holdNum;
+}
+
+static void TestPrintf()
+{
+    ByteBuf* buf = ByteBuf_Create(32);
+    ConstBuf* data = ConstBuf_CreateByConst((const uint8_t*)"\x01\xAB", 2);
+
+    TEST_CHECK(ByteBuf_Printf(buf, 1, "%s %u %02X %H", "a", 12u, 5u, data) == 1);
+    TEST_CHECK(strcmp((const char*)buf->_buf, "a 12 05 01AB") == 0);
+    TEST_CHECK(buf->_len == 13);
+
+    TEST_CHECK(ByteBuf_Printf(buf, 1, "%d|%5d|%-0d|%x|%c%%", -12, 34, 0, 0xBEEFu, 'z') == 0);
+    TEST_CHECK(ByteBuf_Printf(buf, 1, "%d|%5d|%05d|%x|%c%%", -12, 34, -7, 0xBEEFu, 'z') == 1);
+    TEST_CHECK(strcmp((const char*)buf->_buf, "-12|   34|-0007|beef|z%") == 0);
+
+    // 追加空间不足时不修改有效内容
+    ByteBuf_Flush(buf);
+    TEST_CHECK(ByteBuf_AppendStr(buf, "0123456789") == 1);
+    TEST_CHECK(ByteBuf_AppendPrintf(buf, "%s%s%s", "0123456789", "0123456789", "0123456789") == 0);
+    TEST_CHECK(buf->_len == 10);
+
+    // 空间不足时截断, _len 为实际写入的长度
+    TEST_CHECK(ByteBuf_Printf(buf, 0, "%s%s%s%s", "0123456789", "0123456789", "0123456789", "0123456789") == 0);
+    TEST_CHECK(buf->_len == 32 && memcmp(buf->_buf, "01234567890123456789012345678901", 32) == 0);
+    TEST_CHECK(ByteBuf_Printf(buf, 1, "%s%s%s%s", "0123456789", "0123456789", "0123456789", "0123456789") == 0);
+    TEST_CHECK(buf->_len == 32 && buf->_buf[31] == 0);
+
+    ConstBuf_Delete(data);
+    ByteBuf_Delete(buf);
+}
+
+static void TestPrintfModifier()
+{
+    ByteBuf* buf = ByteBuf_Create(64);
+
+    // NULL 字符串与 printf 相同输出 (null)
+    TEST_CHECK(ByteBuf_Printf(buf, 1, "[%s]", (const char*)NULL) == 1);
+    TEST_CHECK(strcmp((const char*)buf->_buf, "[(null)]") == 0);
+
+    // l 与 z 按对应类型读取参数, 之后的参数不错位
+    TEST_CHECK(ByteBuf_Printf(buf, 1, "%lu %ld %08lX %zu %zx %u", 4000000000ul, -5l, 0xABCDul, (size_t)77, (size_t)0x1F, 9u) == 1);
+    TEST_CHECK(strcmp((const char*)buf->_buf, "4000000000 -5 0000ABCD 77 1f 9") == 0);
+
+    // ll 等不支持的修饰符, 以及用于非整数的修饰符返回 0
+    TEST_CHECK(ByteBuf_Printf(buf, 1, "%llu", 1ull) == 0);
+    TEST_CHECK(ByteBuf_Printf(buf, 1, "%ls", "x") == 0);
+    TEST_CHECK(ByteBuf_Printf(buf, 1, "%hu", 1u) == 0);
+    if(sizeof(long) > 4)
+    {
+        // 仅在 long 为 64 位的主机上可能超出 32 位
+        TEST_CHECK(ByteBuf_Printf(buf, 1, "%lu", (unsigned long)UINT32_MAX + 1u) == 0);
+        TEST_CHECK(ByteBuf_Printf(buf, 1, "%ld", (long)INT32_MIN - 1) == 0);
+    }
+    TEST_CHECK(ByteBuf_Printf(buf, 1, "%ld", (long)INT32_MIN) == 1);
+    TEST_CHECK(strcmp((const char*)buf->_buf, "-2147483648") == 0);
+
+    ByteBuf_Delete(buf);
+}
+
+/**
+ * @brief 与 ByteBuf_Printf 相同的接口, 使用 C 库的 vsnprintf 实现 (原实现)
+ */
+static uint8_t LibcPrintf(ByteBuf* obj, const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf((char*)obj->_buf, obj->_size, format, args);
+    va_end(args);
+    obj->_len = (len < 0) ? 0 : (size_t)len;
+    return len >= 0 && (size_t)len < obj->_size;
+}
+
+static void TestPrintfBench()
+{
+    // 以项目中实际使用的格式比较自带的格式化输出与 vsnprintf (主机 glibc, 与目标上的 newlib-nano 不同)
+    // 与工程相同, 测试不开启优化编译, 而 C 库为优化编译的预编译库
+    ByteBuf* buf = ByteBuf_Create(128);
+    ConstBuf* data = ConstBuf_CreateByConst((const uint8_t*)"\x68\x00\x12\x34\xAB\xCD", 6);
+    const char* rec = "hello world";
+
+    uint64_t beg = HostOS_GetRealNs();
+    for(uint32_t i = 0; i < PRINTF_CYCLE_NUM; i++)
+    {
+        ByteBuf_Printf(buf, 0, "[REC]%s[REC]\r\n", rec);
+    }
+    uint64_t recNs = HostOS_GetRealNs() - beg;
+    TEST_CHECK(strcmp((const char*)buf->_buf, "[REC]hello world[REC]\r\n") == 0);
+
+    beg = HostOS_GetRealNs();
+    for(uint32_t i = 0; i < PRINTF_CYCLE_NUM; i++)
+    {
+        LibcPrintf(buf, "[REC]%s[REC]\r\n", rec);
+    }
+    uint64_t recLibcNs = HostOS_GetRealNs() - beg;
+
+    beg = HostOS_GetRealNs();
+    for(uint32_t i = 0; i < PRINTF_CYCLE_NUM; i++)
+    {
+        ByteBuf_Printf(buf, 0, "Live: byte=%u const=%u bytes=%u\r\n", i, 12u, 4096u);
+    }
+    uint64_t statNs = HostOS_GetRealNs() - beg;
+
+    beg = HostOS_GetRealNs();
+    for(uint32_t i = 0; i < PRINTF_CYCLE_NUM; i++)
+    {
+        LibcPrintf(buf, "Live: byte=%u const=%u bytes=%u\r\n", i, 12u, 4096u);
+    }
+    uint64_t statLibcNs = HostOS_GetRealNs() - beg;
+
+    // %H 没有对应的 printf 格式, 与逐字节 %02X 比较
+    beg = HostOS_GetRealNs();
+    for(uint32_t i = 0; i < PRINTF_CYCLE_NUM; i++)
+    {
+        ByteBuf_Printf(buf, 0, "Rec: %H\r\n", data);
+    }
+    uint64_t hexNs = HostOS_GetRealNs() - beg;
+    TEST_CHECK(strcmp((const char*)buf->_buf, "Rec: 68001234ABCD\r\n") == 0);
+
+    beg = HostOS_GetRealNs();
+    for(uint32_t i = 0; i < PRINTF_CYCLE_NUM; i++)
+    {
+        const uint8_t* p = data->_buf;
+        LibcPrintf(buf, "Rec: %02X%02X%02X%02X%02X%02X\r\n", p[0], p[1], p[2], p[3], p[4], p[5]);
+    }
+    uint64_t hexLibcNs = HostOS_GetRealNs() - beg;
+    TEST_CHECK(strcmp((const char*)buf->_buf, "Rec: 68001234ABCD\r\n") == 0);
+
+    printf("printf \"[REC]%%s[REC]\": %.1f ns, vsnprintf %.1f ns\n",
+        (double)recNs / PRINTF_CYCLE_NUM, (double)recLibcNs / PRINTF_CYCLE_NUM);
+    printf("printf \"Live: ...%%u\": %.1f ns, vsnprintf %.1f ns\n",
+        (double)statNs / PRINTF_CYCLE_NUM, (double)statLibcNs / PRINTF_CYCLE_NUM);
+    printf("printf \"Rec: %%H\" (6 bytes): %.1f ns, vsnprintf %%02X x6 %.1f ns\n",
+        (double)hexNs / PRINTF_CYCLE_NUM, (double)hexLibcNs / PRINTF_CYCLE_NUM);
+
+    ConstBuf_Delete(data);
+    ByteBuf_Delete(buf);
+}
+
+static void TestSliceRef()
+{
+    ConstBuf* parent = ConstBuf_CreateExtBuf((const uint8_t*)"hello world", 11, 0, 11, 0);
+    TEST_CHECK(parent != NULL && parent->_len == 11);
+
+    ConstBuf* slice = ConstBuf_Slice(parent, 6, 0);
+    TEST_CHECK(slice != NULL && slice->_len == 5 && memcmp(slice->_buf, "world", 5) == 0);
+    TEST_CHECK(ConstBuf_Slice(parent, 11, 0) == NULL);
+
+    // 原数据在切片销毁后才被销毁
+    ConstBuf_Delete(parent);
+    TEST_CHECK(parent->_ref == 1);
+    TEST_CHECK(ConstBuf_Ref(slice) == slice);
+    ConstBuf_Delete(slice);
+    TEST_CHECK(memcmp(slice->_buf, "world", 5) == 0);
+    ConstBuf_Delete(slice);
+}
+
+static void TestBorrow()
+{
+    static uint8_t recBuf[8] = "abc";
+    releaseNum = 0;
+
+    ConstBuf* data = ConstBuf_CreateByBorrow(recBuf, 3, Release);
+    TEST_CHECK(data != NULL && data->_buf == recBuf);
+    ConstBuf* slice = ConstBuf_Slice(data, 1, 2);
+    ConstBuf_Delete(data);
+    TEST_CHECK(releaseNum == 0);
+
+    // 最后一个引用销毁时归还数据区
+    ConstBuf_Delete(slice);
+    TEST_CHECK(releaseNum == 1 && releaseBuf == recBuf);
+}
+
+static void TestSemaphore()
+{
+    // 切片持有原数据的引用, 原数据最终销毁时才释放信号量
+    osSemaphoreId_t sem = osSemaphoreNew(1, 0, NULL);
+    ConstBuf* data = ConstBuf_CreateByStr("xy");
+    ConstBuf_BindSemaphore(data, sem);
+    ConstBuf* slice = ConstBuf_Slice(data, 1, 0);
+    ConstBuf_Delete(data);
+    TEST_CHECK(osSemaphoreGetCount(sem) == 0);
+    ConstBuf_Delete(slice);
+    TEST_CHECK(osSemaphoreGetCount(sem) == 1);
+}
+
+static void TestHex()
+{
+    // 编码为大写 16 进制字符串, 末尾补充 \0
+    ConstBuf* hex = ConstBuf_BufToHex((const uint8_t*)"\x12\xEF\x00", 3);
+    TEST_CHECK(hex != NULL && hex->_len == 7 && strcmp((const char*)hex->_buf, "12EF00") == 0);
+    ConstBuf_Delete(hex);
+
+    hex = ConstBuf_BufToHex(NULL, 0);
+    TEST_CHECK(hex != NULL && hex->_len == 1 && hex->_buf[0] == 0);
+    ConstBuf_Delete(hex);
+}
+
+static void TestResolveText()
+{
+    ConstBuf* body = NULL;
+    ConstBuf* args = NULL;
+
+    // 命令体为字符串, 在原数据销毁后仍然有效
+    ConstBuf* text = ConstBuf_CreateByStr("SEND  d06b80");
+    TEST_CHECK(CommandResolveText(text, &body, &args) == 1);
+    ConstBuf_Delete(text);
+    TEST_CHECK(body->_len == 5 && strcmp((const char*)body->_buf, "SEND") == 0);
+    TEST_CHECK(args->_len == 3 && memcmp(args->_buf, "\xD0\x6B\x80", 3) == 0);
+    ConstBuf_Delete(body);
+    ConstBuf_Delete(args);
+
+    // 参数在第一个非 16 进制字符处结束, 命令体可以为空
+    const ConstBuf* constText = ConstBuf_CreateByStr(" 12\r\n");
+    TEST_CHECK(CommandResolveText(constText, &body, &args) == 1);
+    TEST_CHECK(body->_len == 1 && body->_buf[0] == 0);
+    TEST_CHECK(args->_len == 1 && args->_buf[0] == 0x12);
+    ConstBuf_Delete(body);
+    ConstBuf_Delete(args);
+    ConstBuf_Delete((ConstBuf*)constText);
+
+    // 没有参数时失败
+    text = ConstBuf_CreateByConst((const uint8_t*)"SEND ", 5);
+    TEST_CHECK(CommandResolveText(text, &body, &args) == 0);
+    ConstBuf_Delete(text);
+}
+
+static void TestAllocFail()
+{
+    size_t heapNum = HostOS_GetHeapBlockNum();
+
+    // 在中断中耗尽内存池后, 所有创建函数返回 NULL
+    HostOS_SetIsr(1);
+    ConstBuf* hold[64];
+    size_t holdNum = 0;
+    while(holdNum < 64 && (hold[holdNum] = ConstBuf_CreateEmpty(1)) != NULL)
+    {
+        holdNum++;
+    }
+    TEST_CHECK(holdNum == POOL_BLOCK_NUM);
+
+    static uint8_t recBuf[4];
+    TEST_CHECK(ConstBuf_CreateEmpty(0) == NULL);
+    TEST_CHECK(ConstBuf_CreateByByte(1) == NULL);
+    TEST_CHECK(ConstBuf_CreateByStr("x") == NULL);
+    TEST_CHECK(ConstBuf_CreateByConst(recBuf, 4) == NULL);
+    TEST_CHECK(ConstBuf_CreateByBorrow(recBuf, 4, Release) == NULL);
+    TEST_CHECK(ConstBuf_CreateExtBuf(recBuf, 4, 0, 4, 0) == NULL);
+    TEST_CHECK(ConstBuf_Slice(hold[0], 0, 1) == NULL);
+    TEST_CHECK(ConstBuf_BufToHex(recBuf, 4) == NULL);
+    TEST_CHECK(ByteBuf_Create(4) == NULL);
+    HostOS_SetIsr(0);
+
+    // 任务中内存池耗尽时回退到堆, 堆也耗尽时返回 NULL
+    ConstBuf* heapBuf = ConstBuf_CreateEmpty(1);
+    TEST_CHECK(heapBuf != NULL && HostOS_GetHeapBlockNum() == heapNum + 1);
+    ConstBuf_Delete(heapBuf);
+    HostOS_SetHeapFail(1);
+    TEST_CHECK(ConstBuf_CreateEmpty(1) == NULL);
+    HostOS_SetHeapFail(0);
+
+    ConstBuf_Delete(NULL);
+    for(size_t i = 0; i < holdNum; i++)
+    {
+        ConstBuf_Delete(hold[i]);
+    }
+
+    // 归还后可以再次从内存池分配
+    TEST_CHECK(PoolCapacity() == POOL_BLOCK_NUM);
+    TEST_CHECK(HostOS_GetHeapBlockNum() == heapNum);
+}
+
+static void TestPoolChurn()
+{
+    // 随机长度的对象以随机顺序创建与销毁, 同时存活的对象超过内存池容量时部分回退到堆
+    ConstBuf* slot[40] = {NULL};
+    size_t heapNum = HostOS_GetHeapBlockNum();
+    size_t heapAlloc = HostOS_GetHeapAllocNum();
+    srand(1);
+
+    for(uint32_t i = 0; i < POOL_CYCLE_NUM; i++)
+    {
+        size_t idx = rand() % 40;
+        if(slot[idx] != NULL)
+        {
+            ConstBuf_Delete(slot[idx]);
+            slot[idx] = NULL;
+        }
+        else
+        {
+            slot[idx] = ConstBuf_CreateEmpty(rand() % 300);
+            TEST_CHECK(slot[idx] != NULL);
+        }
+    }
+    for(size_t i = 0; i < 40; i++)
+    {
+        ConstBuf_Delete(slot[i]);
+    }
+
+    // 没有泄漏, 且没有内存池块丢失 (内存池不会产生碎片)
+    TEST_CHECK(HostOS_GetHeapBlockNum() == heapNum);
+    TEST_CHECK(PoolCapacity() == POOL_BLOCK_NUM);
+    printf("pool churn: %u cycles, %u fell back to heap\n",
+        POOL_CYCLE_NUM, (uint32_t)(HostOS_GetHeapAllocNum() - heapAlloc));
+}
+
+static void TestPoolBench()
+{
+    // 比较固定大小对象从内存池与从堆分配的耗时, 内存池中的分配不访问堆
+    // 主机上的堆为 malloc 加互斥锁, 与 FreeRTOS heap_4 的耗时不同, 结果仅用于比较同一主机上的改动
+    size_t heapAlloc = HostOS_GetHeapAllocNum();
+    uint64_t beg = HostOS_GetRealNs();
+    for(uint32_t i = 0; i < POOL_CYCLE_NUM; i++)
+    {
+        ConstBuf_Delete(ConstBuf_CreateEmpty(16));
+    }
+    uint64_t poolNs = HostOS_GetRealNs() - beg;
+    TEST_CHECK(HostOS_GetHeapAllocNum() == heapAlloc);
+
+    beg = HostOS_GetRealNs();
+    for(uint32_t i = 0; i < POOL_CYCLE_NUM; i++)
+    {
+        vPortFree(pvPortMalloc(sizeof(ConstBuf) + 16));
+    }
+    uint64_t heapNs = HostOS_GetRealNs() - beg;
+    TEST_CHECK(HostOS_GetHeapAllocNum() == heapAlloc + POOL_CYCLE_NUM);
+
+    // 每次创建与销毁各进入一次临界区, 模拟内核的临界区远慢于目标上的关中断, 单独列出
+    beg = HostOS_GetRealNs();
+    for(uint32_t i = 0; i < POOL_CYCLE_NUM; i++)
+    {
+        UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+        taskEXIT_CRITICAL_FROM_ISR(mask);
+    }
+    uint64_t critNs = HostOS_GetRealNs() - beg;
+
+    printf("create/delete: pool %.1f ns (%.1f ns excluding critical sections), heap %.1f ns\n",
+        (double)poolNs / POOL_CYCLE_NUM, ((double)poolNs - 2.0 * critNs) / POOL_CYCLE_NUM,
+        (double)heapNs / POOL_CYCLE_NUM);
+}
+
+int main()
+{
+    TestPrintf();
+    TestPrintfModifier();
+    TestPrintfBench();
+    TestSliceRef();
+    TestBorrow();
+    TestSemaphore();
+    TestHex();
+    TestResolveText();
+    TestAllocFail();
+    TestPoolChurn();
+    TestPoolBench();
+    return TEST_RESULT();
+}
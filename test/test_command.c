@@ -0,0 +1,279 @@
+#include "command.h"
+#include "host_os.h"
+#include "test_util.h"
+
+// 分发性能测试中每条指令的重复次数
+#define BENCH_NUM 200000
+
+// 记录最近一次被调用的处理函数与参数
+static const char* lastName = NULL;
+static uint8_t lastArgs[8];
+static size_t lastArgLen = 0;
+
+static void Record(const char* name, ConstBuf* args)
+{
+    lastName = name;
+    lastArgLen = args->_len;
+    memcpy(lastArgs, args->_buf, args->_len < sizeof(lastArgs) ? args->_len : sizeof(lastArgs));
+}
+
+static void CmdPing(ConstBuf* args, ByteBuf* printBuf)
+{
+    Record("PING", args);
+    ByteBuf_AppendStr(printBuf, "PONG");
+}
+
+static void CmdRec(ConstBuf* args, ByteBuf* printBuf)
+{
+    Record("REC", args);
+}
+
+static void CmdSend(ConstBuf* args, ByteBuf* printBuf)
+{
+    Record("SEND", args);
+}
+
+// 按指令名的字节序排列
+static const CommandEntry cmdTable[] = {
+    {"PING", 0, 0, CmdPing},
+    {"REC", 3, 3, CmdRec},
+    {"SEND", 2, 8, CmdSend},
+};
+#define CMD_NUM (sizeof(cmdTable) / sizeof(CommandEntry))
+
+static CommandResult Dispatch(const char* text, ByteBuf* printBuf, size_t* argLen, size_t* errPos)
+{
+    ConstBuf* cmd = ConstBuf_CreateByStr(text);
+    lastName = NULL;
+    CommandResult res = Command_Dispatch(cmdTable, CMD_NUM, cmd, printBuf, argLen, errPos);
+    ConstBuf_Delete(cmd);
+    return res;
+}
+
+static void TestFind()
+{
+    TEST_CHECK(Command_Find(cmdTable, CMD_NUM, (const uint8_t*)"REC", 3) == &cmdTable[1]);
+    TEST_CHECK(Command_Find(cmdTable, CMD_NUM, (const uint8_t*)"SEND", 4) == &cmdTable[2]);
+    TEST_CHECK(Command_Find(cmdTable, CMD_NUM, (const uint8_t*)"PING", 4) == &cmdTable[0]);
+    // 前缀与更长的名称均不匹配
+    TEST_CHECK(Command_Find(cmdTable, CMD_NUM, (const uint8_t*)"RE", 2) == NULL);
+    TEST_CHECK(Command_Find(cmdTable, CMD_NUM, (const uint8_t*)"SENDX", 5) == NULL);
+    TEST_CHECK(Command_Find(cmdTable, 0, (const uint8_t*)"REC", 3) == NULL);
+}
+
+static void TestDispatch()
+{
+    ByteBuf* printBuf = ByteBuf_Create(32);
+    size_t argLen = 0;
+    size_t errPos = 0;
+
+    TEST_CHECK(Dispatch("PING", printBuf, &argLen, &errPos) == COMMAND_OK);
+    TEST_CHECK(lastName != NULL && strcmp(lastName, "PING") == 0 && lastArgLen == 0);
+    TEST_CHECK(printBuf->_len == 4 && memcmp(printBuf->_buf, "PONG", 4) == 0);
+
+    TEST_CHECK(Dispatch("REC  d03b06", printBuf, &argLen, &errPos) == COMMAND_OK);
+    TEST_CHECK(lastName != NULL && strcmp(lastName, "REC") == 0);
+    TEST_CHECK(argLen == 3 && lastArgLen == 3 && memcmp(lastArgs, "\xD0\x3B\x06", 3) == 0);
+
+    TEST_CHECK(Dispatch("STOP", printBuf, &argLen, &errPos) == COMMAND_UNKNOWN);
+    TEST_CHECK(Dispatch("REC D03B", printBuf, &argLen, &errPos) == COMMAND_BAD_ARGS);
+    TEST_CHECK(argLen == 2);
+    TEST_CHECK(Dispatch(" D03B06", printBuf, &argLen, &errPos) == COMMAND_BAD_FORMAT);
+    TEST_CHECK(errPos == 0);
+
+    TEST_CHECK(Dispatch("SEND D0ZZ", printBuf, &argLen, &errPos) == COMMAND_BAD_FORMAT);
+    TEST_CHECK(errPos == 7);
+    TEST_CHECK(lastName == NULL);
+
+    ByteBuf_Delete(printBuf);
+}
+
+static void TestOddArgs()
+{
+    ByteBuf* printBuf = ByteBuf_Create(32);
+    size_t argLen = 0;
+    size_t errPos = 0;
+
+    // 奇数个参数字符在分配参数数据块之前即被拒绝, 错误位置为缺少的字符
+    TEST_CHECK(Dispatch("SEND D06B8", printBuf, &argLen, &errPos) == COMMAND_BAD_FORMAT);
+    TEST_CHECK(errPos == 10);
+    TEST_CHECK(lastName == NULL);
+
+    // 同时存在非 16 进制字符时, 错误位置为该字符
+    TEST_CHECK(Dispatch("SEND D0x6B", printBuf, &argLen, &errPos) == COMMAND_BAD_FORMAT);
+    TEST_CHECK(errPos == 7);
+
+    ByteBuf_Delete(printBuf);
+}
+
+static void TestNoMemory()
+{
+    ByteBuf* printBuf = ByteBuf_Create(32);
+    ConstBuf* cmd = ConstBuf_CreateByStr("SEND D06B80");
+    ConstBuf* odd = ConstBuf_CreateByStr("SEND D06B8");
+
+    // 在中断中耗尽能容纳参数的最小一级内存池, 之后的参数数据块无法分配
+    HostOS_SetIsr(1);
+    ConstBuf* hold[64];
+    size_t holdNum = 0;
+    while(holdNum < 64 && (hold[holdNum] = ConstBuf_CreateEmpty(3)) != NULL)
+    {
+        holdNum++;
+    }
+    ByteBuf* big = ByteBuf_Create(1024);
+    TEST_CHECK(big == NULL);
+
+    lastName = NULL;
+    TEST_CHECK(Command_Dispatch(cmdTable, CMD_NUM, cmd, printBuf, NULL, NULL) == COMMAND_NO_MEMORY);
+    TEST_CHECK(lastName == NULL);
+
+    // 奇数个参数字符在分配之前即被拒绝, 不受内存不足影响
+    TEST_CHECK(Command_Dispatch(cmdTable, CMD_NUM, odd, printBuf, NULL, NULL) == COMMAND_BAD_FORMAT);
+    HostOS_SetIsr(0);
+
+    for(size_t i = 0; i < holdNum; i++)
+    {
+        ConstBuf_Delete(hold[i]);
+    }
+    TEST_CHECK(Command_Dispatch(cmdTable, CMD_NUM, cmd, printBuf, NULL, NULL) == COMMAND_OK);
+
+    ConstBuf_Delete(odd);
+    ConstBuf_Delete(cmd);
+    ByteBuf_Delete(printBuf);
+}
+
+static void TestLineEnd()
+{
+    ByteBuf* printBuf = ByteBuf_Create(32);
+    size_t argLen = 0;
+    size_t errPos = 0;
+
+    // 末尾的 \r\n, \n 与 \0 不属于指令, 与不带行尾的指令结果相同
+    TEST_CHECK(Dispatch("REC D03B06\r\n", printBuf, &argLen, &errPos) == COMMAND_OK);
+    TEST_CHECK(lastName != NULL && strcmp(lastName, "REC") == 0);
+    TEST_CHECK(argLen == 3 && memcmp(lastArgs, "\xD0\x3B\x06", 3) == 0);
+
+    TEST_CHECK(Dispatch("PING\r\n", printBuf, &argLen, &errPos) == COMMAND_OK);
+    TEST_CHECK(lastName != NULL && strcmp(lastName, "PING") == 0 && lastArgLen == 0);
+    TEST_CHECK(Dispatch("SEND D06B80\n", printBuf, &argLen, &errPos) == COMMAND_OK);
+    TEST_CHECK(lastArgLen == 3 && memcmp(lastArgs, "\xD0\x6B\x80", 3) == 0);
+
+    // 补充的 \0 之前的行尾同样被忽略
+    ConstBuf* cmd = ConstBuf_CreateByConst((const uint8_t*)"REC D03B06\r\n\0", 13);
+    TEST_CHECK(Command_Dispatch(cmdTable, CMD_NUM, cmd, printBuf, &argLen, NULL) == COMMAND_OK);
+    TEST_CHECK(argLen == 3);
+    ConstBuf_Delete(cmd);
+
+    // 参数中间的 \r 仍为格式错误
+    TEST_CHECK(Dispatch("REC D0\r3B06", printBuf, &argLen, &errPos) == COMMAND_BAD_FORMAT);
+    TEST_CHECK(errPos == 6);
+
+    // 只有行尾时指令名为空
+    TEST_CHECK(Dispatch("\r\n", printBuf, &argLen, &errPos) == COMMAND_BAD_FORMAT);
+
+    ByteBuf_Delete(printBuf);
+}
+
+//********** 分发性能 **********//
+
+static void CmdNop(ConstBuf* args, ByteBuf* printBuf)
+{
+    (void)args;
+    (void)printBuf;
+}
+
+// 与 I2C 控制台相同规模的指令表 (按字节序排列)
+static const CommandEntry benchTable[] = {
+    {"CACHE",   3,  4,  CmdNop},
+    {"CSTAT",   1,  1,  CmdNop},
+    {"FLUSH",   1,  1,  CmdNop},
+    {"I2CSTAT", 0,  0,  CmdNop},
+    {"QSTAT",   0,  0,  CmdNop},
+    {"REC",     3,  3,  CmdNop},
+    {"SAMPLE",  5,  5,  CmdNop},
+    {"SEND",    3,  26, CmdNop},
+    {"SREAD",   0,  0,  CmdNop},
+    {"STATS",   0,  0,  CmdNop},
+    {"TOUCH",   2,  2,  CmdNop},
+};
+#define BENCH_CMD_NUM (sizeof(benchTable) / sizeof(CommandEntry))
+
+/**
+ * @brief 原有的分发方式: 复制指令体与参数, 依次以 strcmp 比较指令名, 再检查参数长度
+ */
+static CommandResult StrcmpDispatch(const ConstBuf* cmd, ByteBuf* printBuf)
+{
+    ConstBuf* body = NULL;
+    ConstBuf* args = NULL;
+    if(!CommandResolveText(cmd, &body, &args))
+    {
+        return COMMAND_BAD_FORMAT;
+    }
+
+    CommandResult res = COMMAND_UNKNOWN;
+    for(size_t i = 0; i < BENCH_CMD_NUM; i++)
+    {
+        if(strcmp((const char*)body->_buf, benchTable[i]._name) == 0)
+        {
+            if(args->_len < benchTable[i]._minArgs || args->_len > benchTable[i]._maxArgs)
+            {
+                res = COMMAND_BAD_ARGS;
+            }
+            else
+            {
+                benchTable[i]._handler(args, printBuf);
+                res = COMMAND_OK;
+            }
+            break;
+        }
+    }
+    ConstBuf_Delete(body);
+    ConstBuf_Delete(args);
+    return res;
+}
+
+static void TestDispatchBench()
+{
+    // 比较指令表分发与原有方式的单条指令耗时 (表首, 表中与表尾的指令)
+    // 原有方式的指令必须带有参数, 因此均使用带参数的指令
+    const char* benchCmd[] = {"CACHE D0750101", "REC D03B06", "TOUCH D001"};
+    ByteBuf* printBuf = ByteBuf_Create(32);
+
+    for(size_t c = 0; c < sizeof(benchCmd) / sizeof(benchCmd[0]); c++)
+    {
+        ConstBuf* cmd = ConstBuf_CreateByStr(benchCmd[c]);
+        uint32_t okNum = 0;
+
+        uint64_t beg = HostOS_GetRealNs();
+        for(uint32_t i = 0; i < BENCH_NUM; i++)
+        {
+            okNum += Command_Dispatch(benchTable, BENCH_CMD_NUM, cmd, printBuf, NULL, NULL) == COMMAND_OK;
+        }
+        uint64_t tableNs = HostOS_GetRealNs() - beg;
+
+        beg = HostOS_GetRealNs();
+        for(uint32_t i = 0; i < BENCH_NUM; i++)
+        {
+            okNum += StrcmpDispatch(cmd, printBuf) == COMMAND_OK;
+        }
+        uint64_t strcmpNs = HostOS_GetRealNs() - beg;
+
+        TEST_CHECK(okNum == 2 * BENCH_NUM);
+        printf("dispatch \"%s\": table %.1f ns, strcmp chain %.1f ns\n", benchCmd[c],
+            (double)tableNs / BENCH_NUM, (double)strcmpNs / BENCH_NUM);
+        ConstBuf_Delete(cmd);
+    }
+
+    ByteBuf_Delete(printBuf);
+}
+
+int main()
+{
+    TestFind();
+    TestDispatch();
+    TestOddArgs();
+    TestNoMemory();
+    TestLineEnd();
+    TestDispatchBench();
+    return TEST_RESULT();
+}
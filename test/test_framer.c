@@ -0,0 +1,359 @@
+#include "framer.h"
+#include "bin_frame.h"
+#include "host_os.h"
+#include "test_util.h"
+
+#include <stdlib.h>
+
+// 随机切分测试中每种分帧方式的数据帧数
+#define RANDOM_FRAME_NUM 20000
+// 随机切分测试的最大帧长度
+#define RANDOM_MAX_LEN 200
+// 随机切分测试的最低处理速率 (MB/s), 远低于实际速率, 仅用于发现退化为逐字节多次处理的实现
+#define RANDOM_MIN_RATE 5.0
+
+/**
+ * @brief 将一段数据逐段输入分帧器, 依次取出所有数据帧
+ * 
+ * @param step 每段输入的长度, 用于检查任意切分时的结果一致
+ * @return size_t 取出的数据帧数
+ */
+static size_t PushAll(Framer* framer, const uint8_t* data, size_t len, size_t step, ConstBuf** frames, size_t num)
+{
+    size_t res = 0;
+    while(len > 0)
+    {
+        size_t segLen = (len < step) ? len : step;
+        const uint8_t* seg = data;
+        size_t left = segLen;
+        ConstBuf* frame = NULL;
+        while((frame = Framer_Push(framer, &seg, &left)) != NULL)
+        {
+            if(res < num)
+            {
+                frames[res] = frame;
+            }
+            else
+            {
+                ConstBuf_Delete(frame);
+            }
+            res++;
+        }
+        data += segLen;
+        len -= segLen;
+    }
+    return res;
+}
+
+static void DeleteAll(ConstBuf** frames, size_t num)
+{
+    for(size_t i = 0; i < num; i++)
+    {
+        ConstBuf_Delete(frames[i]);
+    }
+}
+
+static void TestLine()
+{
+    const char* stream = "SEND D06B80\r\n\nREC D03B06\nPING";
+    for(size_t step = 1; step <= 8; step++)
+    {
+        Framer framer;
+        Framer_Init(&framer, FRAMER_LINE, 32);
+
+        ConstBuf* frames[4];
+        size_t num = PushAll(&framer, (const uint8_t*)stream, strlen(stream), step, frames, 4);
+        TEST_CHECK(num == 2);
+        if(num == 2)
+        {
+            // 数据帧不含行尾, 并以 \0 结尾, 空行被忽略
+            TEST_CHECK(frames[0]->_len == 12 && strcmp((const char*)frames[0]->_buf, "SEND D06B80") == 0);
+            TEST_CHECK(frames[1]->_len == 11 && strcmp((const char*)frames[1]->_buf, "REC D03B06") == 0);
+            DeleteAll(frames, num);
+        }
+
+        // 未结束的一行在补充行尾后输出
+        const uint8_t* data = (const uint8_t*)"\n";
+        size_t len = 1;
+        ConstBuf* frame = Framer_Push(&framer, &data, &len);
+        TEST_CHECK(frame != NULL && strcmp((const char*)frame->_buf, "PING") == 0);
+        ConstBuf_Delete(frame);
+    }
+}
+
+static void TestLineTooLong()
+{
+    Framer framer;
+    Framer_Init(&framer, FRAMER_LINE, 8);
+
+    const char* stream = "0123456789ABCDEF\nOK\n";
+    ConstBuf* frames[2];
+    size_t num = PushAll(&framer, (const uint8_t*)stream, strlen(stream), 3, frames, 2);
+    TEST_CHECK(num == 1);
+    TEST_CHECK(framer._dropNum == 1);
+    if(num == 1)
+    {
+        TEST_CHECK(strcmp((const char*)frames[0]->_buf, "OK") == 0);
+        DeleteAll(frames, num);
+    }
+}
+
+static void TestLength()
+{
+    const uint8_t stream[] = {0x00, 0x03, 'a', 'b', 'c', 0x00, 0x00, 0x00, 0x01, 'z', 0x00, 0x10, 1, 2};
+    for(size_t step = 1; step <= sizeof(stream); step++)
+    {
+        Framer framer;
+        Framer_Init(&framer, FRAMER_LENGTH, 8);
+
+        ConstBuf* frames[4];
+        size_t num = PushAll(&framer, stream, sizeof(stream), step, frames, 4);
+        TEST_CHECK(num == 3);
+        if(num == 3)
+        {
+            TEST_CHECK(frames[0]->_len == 3 && memcmp(frames[0]->_buf, "abc", 3) == 0);
+            TEST_CHECK(frames[1]->_len == 0);
+            TEST_CHECK(frames[2]->_len == 1 && frames[2]->_buf[0] == 'z');
+            DeleteAll(frames, num);
+        }
+    }
+}
+
+static void TestCobs()
+{
+    // 11 22 00 33 与 00 的编码, 以及连续的帧结尾
+    const uint8_t stream[] = {0x03, 0x11, 0x22, 0x02, 0x33, 0x00, 0x00, 0x01, 0x01, 0x00};
+    for(size_t step = 1; step <= sizeof(stream); step++)
+    {
+        Framer framer;
+        Framer_Init(&framer, FRAMER_COBS, 8);
+
+        ConstBuf* frames[4];
+        size_t num = PushAll(&framer, stream, sizeof(stream), step, frames, 4);
+        TEST_CHECK(num == 2);
+        if(num == 2)
+        {
+            TEST_CHECK(frames[0]->_len == 4 && memcmp(frames[0]->_buf, "\x11\x22\x00\x33", 4) == 0);
+            TEST_CHECK(frames[1]->_len == 1 && frames[1]->_buf[0] == 0);
+            DeleteAll(frames, num);
+        }
+    }
+}
+
+static void TestCobsBroken()
+{
+    Framer framer;
+    Framer_Init(&framer, FRAMER_COBS, 8);
+
+    // 编码块声明 4 字节但只有 1 字节时帧结束, 应丢弃
+    const uint8_t stream[] = {0x05, 0x11, 0x00, 0x02, 0x44, 0x00};
+    ConstBuf* frames[2];
+    size_t num = PushAll(&framer, stream, sizeof(stream), sizeof(stream), frames, 2);
+    TEST_CHECK(num == 1);
+    TEST_CHECK(framer._dropNum == 1);
+    if(num == 1)
+    {
+        TEST_CHECK(frames[0]->_len == 1 && frames[0]->_buf[0] == 0x44);
+        DeleteAll(frames, num);
+    }
+}
+
+static void TestAllocFail()
+{
+    Framer framer;
+    Framer_Init(&framer, FRAMER_LINE, 300);
+
+    // 在中断中内存池耗尽时不回退到堆, 无法分配的数据帧被丢弃并计数
+    char line[282];
+    memset(line, 'x', 280);
+    line[280] = '\n';
+    line[281] = 0;
+
+    HostOS_SetIsr(1);
+    ConstBuf* frames[8];
+    size_t num = 0;
+    for(size_t i = 0; i < 8; i++)
+    {
+        num += PushAll(&framer, (const uint8_t*)line, 281, 281, frames + num, 8 - num);
+    }
+    HostOS_SetIsr(0);
+
+    TEST_CHECK(num == 0);
+    TEST_CHECK(framer._dropNum == 8);
+}
+
+static void TestInitFail()
+{
+    // 无法分配帧缓冲区时初始化失败
+    Framer framer;
+    BinFrameReader reader;
+    HostOS_SetHeapFail(1);
+    TEST_CHECK(Framer_Init(&framer, FRAMER_LINE, 1024) == 0);
+    TEST_CHECK(framer._buf == NULL);
+    TEST_CHECK(BinFrameReader_Init(&reader, 1024, 0) == 0);
+    HostOS_SetHeapFail(0);
+
+    TEST_CHECK(Framer_Init(&framer, FRAMER_LINE, 1024) == 1);
+    ByteBuf_Delete(framer._buf);
+}
+
+//********** 随机切分 **********//
+
+/**
+ * @brief 生成随机数据帧
+ * 
+ * @param mode 分帧方式, FRAMER_LINE 下内容为不含行尾的可见字符, 且不为空
+ * @return size_t 数据帧长度
+ */
+static size_t RandomFrame(FramerMode mode, uint8_t* frame)
+{
+    size_t len = rand() % (RANDOM_MAX_LEN + 1);
+    if(mode == FRAMER_LINE)
+    {
+        len = (len == 0) ? 1 : len;
+        for(size_t i = 0; i < len; i++)
+        {
+            frame[i] = ' ' + rand() % 95;
+        }
+    }
+    else
+    {
+        for(size_t i = 0; i < len; i++)
+        {
+            // 较多的 0x00 以覆盖 COBS 的短编码块
+            frame[i] = (rand() % 4 == 0) ? 0 : (uint8_t)rand();
+        }
+    }
+    return len;
+}
+
+/**
+ * @brief 以给定方式编码数据帧
+ * 
+ * @return size_t 编码后的长度
+ */
+static size_t EncodeFrame(FramerMode mode, const uint8_t* frame, size_t len, uint8_t* out)
+{
+    size_t res = 0;
+    if(mode == FRAMER_LINE)
+    {
+        memcpy(out, frame, len);
+        res = len;
+        if(rand() % 2)
+        {
+            out[res++] = '\r';
+        }
+        out[res++] = '\n';
+    }
+    else if(mode == FRAMER_LENGTH)
+    {
+        out[0] = (uint8_t)(len >> 8);
+        out[1] = (uint8_t)len;
+        memcpy(out + 2, frame, len);
+        res = len + 2;
+    }
+    else
+    {
+        size_t code = res++;
+        for(size_t i = 0; i < len; i++)
+        {
+            if(frame[i] == 0)
+            {
+                out[code] = (uint8_t)(res - code);
+                code = res++;
+            }
+            else
+            {
+                out[res++] = frame[i];
+                if(res - code == 0xFF)
+                {
+                    out[code] = 0xFF;
+                    code = res++;
+                }
+            }
+        }
+        out[code] = (uint8_t)(res - code);
+        out[res++] = 0;
+    }
+    return res;
+}
+
+static void TestRandomChunk(FramerMode mode, const char* name)
+{
+    // 随机数据帧以随机长度 (1 ~ 64 字节) 切分输入, 取出的数据帧与原数据帧完全一致
+    srand(mode + 1);
+    size_t cap = RANDOM_FRAME_NUM * (RANDOM_MAX_LEN + RANDOM_MAX_LEN / 254 + 3);
+    uint8_t* stream = malloc(cap);
+    uint8_t* expect = malloc(RANDOM_FRAME_NUM * RANDOM_MAX_LEN);
+    size_t* expectLen = malloc(RANDOM_FRAME_NUM * sizeof(size_t));
+    size_t streamLen = 0;
+    size_t expectPos = 0;
+    for(size_t i = 0; i < RANDOM_FRAME_NUM; i++)
+    {
+        expectLen[i] = RandomFrame(mode, expect + expectPos);
+        streamLen += EncodeFrame(mode, expect + expectPos, expectLen[i], stream + streamLen);
+        expectPos += expectLen[i];
+    }
+
+    // FRAMER_LINE 下最大帧长度包含行尾的 \r
+    Framer framer;
+    TEST_CHECK(Framer_Init(&framer, mode, (mode == FRAMER_LINE) ? RANDOM_MAX_LEN + 1 : RANDOM_MAX_LEN));
+
+    size_t frameNum = 0;
+    size_t errNum = 0;
+    expectPos = 0;
+    size_t pos = 0;
+    uint64_t beg = HostOS_GetRealNs();
+    while(pos < streamLen)
+    {
+        size_t left = 1 + rand() % 64;
+        left = (left > streamLen - pos) ? streamLen - pos : left;
+        const uint8_t* seg = stream + pos;
+        pos += left;
+
+        ConstBuf* frame = NULL;
+        while((frame = Framer_Push(&framer, &seg, &left)) != NULL)
+        {
+            // FRAMER_LINE 下数据帧末尾补充有 \0
+            size_t len = (mode == FRAMER_LINE) ? frame->_len - 1 : frame->_len;
+            if(frameNum >= RANDOM_FRAME_NUM || len != expectLen[frameNum] ||
+                memcmp(frame->_buf, expect + expectPos, len) != 0)
+            {
+                errNum++;
+            }
+            else
+            {
+                expectPos += len;
+            }
+            frameNum++;
+            ConstBuf_Delete(frame);
+        }
+    }
+    uint64_t ns = HostOS_GetRealNs() - beg;
+
+    TEST_CHECK(frameNum == RANDOM_FRAME_NUM && errNum == 0);
+    TEST_CHECK(framer._dropNum == 0);
+    double rate = (double)streamLen * 1000.0 / (double)ns;
+    TEST_CHECK(rate > RANDOM_MIN_RATE);
+    printf("random chunk %s: %u frames, %u bytes, %.1f MB/s\n", name, (uint32_t)frameNum, (uint32_t)streamLen, rate);
+
+    ByteBuf_Delete(framer._buf);
+    free(stream);
+    free(expect);
+    free(expectLen);
+}
+
+int main()
+{
+    TestLine();
+    TestLineTooLong();
+    TestLength();
+    TestCobs();
+    TestCobsBroken();
+    TestAllocFail();
+    TestInitFail();
+    TestRandomChunk(FRAMER_LINE, "line");
+    TestRandomChunk(FRAMER_LENGTH, "length");
+    TestRandomChunk(FRAMER_COBS, "cobs");
+    return TEST_RESULT();
+}
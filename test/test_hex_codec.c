@@ -0,0 +1,64 @@
+#include "hex_codec.h"
+#include "test_util.h"
+
+static void TestEncode()
+{
+    const uint8_t src[] = {0x00, 0x1F, 0xA5, 0xFF};
+    uint8_t dst[8];
+    TEST_CHECK(HexCodec_Encode(dst, src, sizeof(src)) == 8);
+    TEST_CHECK_MEM(dst, "001FA5FF", 8);
+}
+
+static void TestDecode()
+{
+    uint8_t dst[4] = {0};
+    size_t errPos = 0;
+
+    // 大小写混合, 长度覆盖 4 字符一组与逐字符两种路径
+    TEST_CHECK(HexCodec_Decode(dst, (const uint8_t*)"a1B2c3", 6, &errPos) == 1);
+    TEST_CHECK_MEM(dst, "\xA1\xB2\xC3", 3);
+
+    TEST_CHECK(HexCodec_Decode(dst, (const uint8_t*)"00ff10Ee", 8, &errPos) == 1);
+    TEST_CHECK_MEM(dst, "\x00\xFF\x10\xEE", 4);
+
+    // 非 16 进制字符的位置
+    TEST_CHECK(HexCodec_Decode(dst, (const uint8_t*)"0011zz", 6, &errPos) == 0);
+    TEST_CHECK(errPos == 4);
+    TEST_CHECK(HexCodec_Decode(dst, (const uint8_t*)"0g", 2, &errPos) == 0);
+    TEST_CHECK(errPos == 1);
+}
+
+static void TestDecodeOdd()
+{
+    // 输出缓冲区只有 len / 2 字节, 奇数长度时不能写入输出缓冲区
+    uint8_t dst[3] = {0x55, 0x55, 0x55};
+    size_t errPos = 0;
+
+    TEST_CHECK(HexCodec_Decode(dst, (const uint8_t*)"12345", 5, &errPos) == 0);
+    TEST_CHECK(errPos == 5);
+    TEST_CHECK_MEM(dst, "\x55\x55\x55", 3);
+
+    // 同时存在非 16 进制字符时报告该字符的位置
+    TEST_CHECK(HexCodec_Decode(dst, (const uint8_t*)"12x45", 5, &errPos) == 0);
+    TEST_CHECK(errPos == 2);
+    TEST_CHECK_MEM(dst, "\x55\x55\x55", 3);
+
+    TEST_CHECK(HexCodec_Decode(dst, (const uint8_t*)"1", 1, NULL) == 0);
+    TEST_CHECK(dst[0] == 0x55);
+}
+
+static void TestSpan()
+{
+    TEST_CHECK(HexCodec_Span((const uint8_t*)"0aF9 12", 7) == 4);
+    TEST_CHECK(HexCodec_Span((const uint8_t*)"", 0) == 0);
+    TEST_CHECK(HexCodec_Span((const uint8_t*)"abc", 3) == 3);
+}
+
+int main()
+{
+    TestEncode();
+    TestDecode();
+    TestDecodeOdd();
+    TestSpan();
+    return TEST_RESULT();
+}
@@ -0,0 +1,281 @@
+#include "rx_ring.h"
+#include "cmsis_os.h"
+#include "host_os.h"
+#include "test_util.h"
+
+#define RING_SIZE 16
+
+// 模拟循环 DMA: 依次写入环形缓冲区, 并返回写入后的位置
+static uint8_t ringBuf[RING_SIZE];
+static size_t dmaPos = 0;
+static uint8_t dmaByte = 0;
+
+static size_t DmaWrite(size_t len)
+{
+    for(size_t i = 0; i < len; i++)
+    {
+        ringBuf[dmaPos] = dmaByte++;
+        dmaPos = (dmaPos + 1) % RING_SIZE;
+    }
+    return dmaPos;
+}
+
+static void Reset(RxRing* ring)
+{
+    dmaPos = 0;
+    dmaByte = 0;
+    memset(ringBuf, 0, sizeof(ringBuf));
+    RxRing_Init(ring, ringBuf, RING_SIZE);
+}
+
+static void TestRead()
+{
+    RxRing ring;
+    Reset(&ring);
+    uint8_t dst[RING_SIZE];
+
+    TEST_CHECK(RxRing_Produce(&ring, DmaWrite(5)) == 5);
+    TEST_CHECK(RxRing_GetCount(&ring) == 5);
+    TEST_CHECK(RxRing_Read(&ring, dst, 3) == 3);
+    TEST_CHECK_MEM(dst, "\x00\x01\x02", 3);
+
+    // 跨过缓冲区末尾, 分两段复制
+    TEST_CHECK(RxRing_Produce(&ring, DmaWrite(12)) == 12);
+    TEST_CHECK(RxRing_GetCount(&ring) == 14);
+    TEST_CHECK(RxRing_Read(&ring, dst, RING_SIZE) == 14);
+    for(size_t i = 0; i < 14; i++)
+    {
+        TEST_CHECK(dst[i] == i + 3);
+    }
+    TEST_CHECK(RxRing_Read(&ring, dst, RING_SIZE) == 0);
+    TEST_CHECK(ring._overrunNum == 0);
+
+    // DMA 写满一整圈时写入位置为缓冲区长度
+    TEST_CHECK(RxRing_Produce(&ring, RING_SIZE) == RING_SIZE - dmaPos);
+}
+
+static void TestOverrun()
+{
+    RxRing ring;
+    Reset(&ring);
+    uint8_t dst[RING_SIZE];
+
+    // 未读数据超过一整圈时只保留最新的一整圈
+    RxRing_Produce(&ring, DmaWrite(10));
+    RxRing_Produce(&ring, DmaWrite(10));
+    TEST_CHECK(ring._overrunNum == 1);
+    TEST_CHECK(ring._overrunBytes == 4);
+    TEST_CHECK(RxRing_GetCount(&ring) == RING_SIZE);
+
+    TEST_CHECK(RxRing_Read(&ring, dst, RING_SIZE) == RING_SIZE);
+    for(size_t i = 0; i < RING_SIZE; i++)
+    {
+        TEST_CHECK(dst[i] == i + 4);
+    }
+}
+
+static void TestSkip()
+{
+    RxRing ring;
+    Reset(&ring);
+    uint8_t dst[RING_SIZE];
+
+    RxRing_Produce(&ring, DmaWrite(6));
+    TEST_CHECK(RxRing_Skip(&ring, 4) == 4);
+    TEST_CHECK(RxRing_Skip(&ring, 10) == 2);
+    TEST_CHECK(RxRing_GetCount(&ring) == 0);
+
+    // 跳过的数据不计为溢出
+    RxRing_Produce(&ring, DmaWrite(2));
+    TEST_CHECK(RxRing_Read(&ring, dst, RING_SIZE) == 2);
+    TEST_CHECK(dst[0] == 6 && dst[1] == 7);
+    TEST_CHECK(ring._overrunNum == 0);
+}
+
+static void TestReset()
+{
+    RxRing ring;
+    Reset(&ring);
+
+    RxRing_Produce(&ring, DmaWrite(5));
+    RxRing_Reset(&ring);
+    TEST_CHECK(RxRing_GetCount(&ring) == 0);
+    TEST_CHECK(ring._overrunNum == 1 && ring._overrunBytes == 5);
+}
+
+static void TestRestart()
+{
+    RxRing ring;
+    uint8_t dst[RING_SIZE];
+
+    // 重新启动时保留未读数据, 以及 DMA 停止前写入但尚未产生事件的数据, 不计为溢出
+    // 分别检查未读数据跨过与不跨过缓冲区末尾
+    for(size_t skip = 0; skip < RING_SIZE; skip += 5)
+    {
+        Reset(&ring);
+        RxRing_Produce(&ring, DmaWrite(skip));
+        RxRing_Skip(&ring, skip);
+
+        RxRing_Produce(&ring, DmaWrite(6));
+        TEST_CHECK(RxRing_Read(&ring, dst, 2) == 2);
+        TEST_CHECK(RxRing_Restart(&ring, DmaWrite(3)) == 3);
+        TEST_CHECK(RxRing_GetCount(&ring) == 7);
+        TEST_CHECK(ring._wpos == 0 && ring._overrunNum == 0);
+
+        // DMA 从缓冲区起点重新写入
+        dmaPos = 0;
+        RxRing_Produce(&ring, DmaWrite(4));
+        TEST_CHECK(RxRing_Read(&ring, dst, RING_SIZE) == 11);
+        for(size_t i = 0; i < 11; i++)
+        {
+            TEST_CHECK(dst[i] == skip + 2 + i);
+        }
+    }
+
+    // 未读数据为一整圈时全部保留
+    Reset(&ring);
+    RxRing_Produce(&ring, DmaWrite(5));
+    RxRing_Restart(&ring, DmaWrite(11));
+    TEST_CHECK(RxRing_GetCount(&ring) == RING_SIZE);
+    TEST_CHECK(RxRing_Read(&ring, dst, RING_SIZE) == RING_SIZE);
+    for(size_t i = 0; i < RING_SIZE; i++)
+    {
+        TEST_CHECK(dst[i] == i);
+    }
+}
+
+//********** 模拟 DMA 生产者 **********//
+
+// 生产者与接收者并发运行时使用的环形缓冲区
+#define STREAM_RING_SIZE 64
+
+static uint8_t streamBuf[STREAM_RING_SIZE];
+static RxRing streamRing;
+static HostEvent streamEvent;
+// 每个字节的传输时间 (us)
+static uint32_t streamByteUs = 0;
+// 剩余待写入的字节数
+static uint32_t streamLeft = 0;
+static uint32_t streamPos = 0;
+static uint8_t streamByte = 0;
+
+// 接收者每次读取之间的处理时间 (tick)
+static uint32_t readerDelay = 0;
+static uint32_t readerNum = 0;
+static uint32_t readerErrNum = 0;
+static uint8_t readerByte = 0;
+static uint32_t readerOverrun = 0;
+static volatile uint8_t readerStop = 0;
+
+// 与 DMA 相同, 逐字节写入, 在半满, 全满与传输结束 (空闲) 时产生事件
+static void StreamByte(void* arg)
+{
+    (void)arg;
+    streamBuf[streamPos++] = streamByte++;
+    streamLeft--;
+
+    if(streamPos == STREAM_RING_SIZE / 2 || streamPos == STREAM_RING_SIZE || streamLeft == 0)
+    {
+        RxRing_Produce(&streamRing, streamPos);
+    }
+    if(streamPos == STREAM_RING_SIZE)
+    {
+        streamPos = 0;
+    }
+    if(streamLeft > 0)
+    {
+        HostEvent_Start(&streamEvent, streamByteUs, StreamByte, NULL);
+    }
+}
+
+// 接收者在每次处理之后读出全部未读数据, 读出的数据应连续, 溢出时从最新的一整圈继续
+static void ReaderTask(void* args)
+{
+    (void)args;
+    uint8_t dst[STREAM_RING_SIZE];
+    while(!readerStop)
+    {
+        osDelay(readerDelay);
+
+        // 跳过被覆盖的数据 (模拟中断只在所有任务阻塞时发生, 读取期间不会溢出)
+        readerByte += streamRing._overrunBytes - readerOverrun;
+        readerOverrun = streamRing._overrunBytes;
+        size_t len = RxRing_Read(&streamRing, dst, sizeof(dst));
+        for(size_t i = 0; i < len; i++)
+        {
+            if(dst[i] != readerByte++)
+            {
+                readerErrNum++;
+            }
+        }
+        readerNum += len;
+    }
+}
+
+/**
+ * @brief 以给定速率写入数据, 接收者以给定间隔读取
+ *
+ * @param byte_us 每个字节的传输时间 (us)
+ * @param delay 接收者每次读取的间隔 (tick)
+ * @param len 写入的字节数
+ */
+static void StreamRun(uint32_t byte_us, uint32_t delay, uint32_t len)
+{
+    RxRing_Init(&streamRing, streamBuf, STREAM_RING_SIZE);
+    streamByteUs = byte_us;
+    streamLeft = len;
+    streamPos = 0;
+    streamByte = 0;
+    readerDelay = delay;
+    readerNum = 0;
+    readerErrNum = 0;
+    readerByte = 0;
+    readerOverrun = 0;
+    readerStop = 0;
+
+    osThreadAttr_t attr = {
+        .name = "Reader",
+        .priority = osPriorityNormal
+    };
+    osThreadNew(ReaderTask, NULL, &attr);
+    HostEvent_Start(&streamEvent, byte_us, StreamByte, NULL);
+    HostOS_DelayUs((uint64_t)byte_us * len + (uint64_t)delay * 2000u + 2000u);
+
+    // 接收者在下一次读取后退出
+    readerStop = 1;
+    HostOS_Delay(delay + 1);
+}
+
+static void TestStream()
+{
+    // 115200 波特率 (87us / 字节), 每 1ms 读取一次, 不溢出
+    StreamRun(87, 1, 20000);
+    TEST_CHECK(readerNum == 20000 && readerErrNum == 0);
+    TEST_CHECK(streamRing._overrunNum == 0);
+    printf("stream 87us/byte, read every 1ms: %u bytes, overrun %u\n",
+        readerNum, streamRing._overrunBytes);
+
+    // 1Mbps (10us / 字节), 每 1ms 读取一次, 一次间隔内到达 100 字节, 必然溢出
+    // 未读取的字节全部计入溢出; 溢出只能以事件为粒度检测, 被覆盖但尚未产生事件的数据将读出错误的内容
+    StreamRun(10, 1, 20000);
+    TEST_CHECK(streamRing._overrunNum > 0);
+    TEST_CHECK(readerNum + streamRing._overrunBytes == 20000);
+    printf("stream 10us/byte, read every 1ms: %u bytes, overrun %u, overwritten before event %u\n",
+        readerNum, streamRing._overrunBytes, readerErrNum);
+
+    // 一次间隔内到达的数据 (25 字节) 与尚未产生事件的数据 (最多半圈) 之和不足一圈时, 不溢出且数据正确
+    StreamRun(40, 1, 20000);
+    TEST_CHECK(readerNum == 20000 && readerErrNum == 0);
+    TEST_CHECK(streamRing._overrunNum == 0);
+}
+
+int main()
+{
+    TestRead();
+    TestOverrun();
+    TestSkip();
+    TestReset();
+    TestRestart();
+    TestStream();
+    return TEST_RESULT();
+}
@@ -0,0 +1,186 @@
+#include "cmsis_os.h"
+#include "host_os.h"
+#include "host_sim.h"
+#include "test_util.h"
+#include "byte_buf.h"
+
+// 回显项目 (uart_io 与 usb_vpc) 的模拟测试, 以项目的任务表启动全部任务, 通过模拟外设输入并检查回显
+
+void LedBlinkTask(void* argument);
+void MainLoopTask(void* argument);
+
+#ifdef USE_UART
+void UART1SendTask(void* args);
+void UART1ReceiveTask(void* args);
+#define SimInput HostUart_Input
+#define SimGetOutput HostUart_GetOutput
+#else
+void USB_VPC_ReceiveTask(void* args);
+void USB_VPC_SendTask(void* args);
+#define SimInput HostUsb_Input
+#define SimGetOutput HostUsb_GetOutput
+#endif
+
+typedef struct SIMTASK
+{
+    const char* _name;
+    osThreadFunc_t _func;
+    osPriority_t _prio;
+} SimTask;
+
+// 与 project 中 .ioc 的任务表相同 (创建顺序与优先级)
+static const SimTask simTask[] = {
+#ifdef USE_UART
+    {"LedBlink", LedBlinkTask, osPriorityNormal},
+    {"UART1Send", UART1SendTask, osPriorityHigh},
+    {"UART1Receive", UART1ReceiveTask, osPriorityLow},
+    {"MainLoop", MainLoopTask, osPriorityLow},
+#else
+    {"LedBlink", LedBlinkTask, osPriorityNormal},
+    {"MainLoop", MainLoopTask, osPriorityLow},
+    {"USB_VPC_Receive", USB_VPC_ReceiveTask, osPriorityHigh},
+    {"USB_VPC_Send", USB_VPC_SendTask, osPriorityLow},
+#endif
+};
+
+static char output[4096];
+
+static void SimStart()
+{
+    for(size_t i = 0; i < sizeof(simTask) / sizeof(simTask[0]); i++)
+    {
+        osThreadAttr_t attr = {
+            .name = simTask[i]._name,
+            .priority = simTask[i]._prio
+        };
+        osThreadNew(simTask[i]._func, NULL, &attr);
+    }
+    // 测试主线程优先级最高, 阻塞后各任务才开始运行, 与 osKernelStart 相同
+    HostOS_Delay(10);
+}
+
+static void SimSend(const char* str, uint32_t wait)
+{
+    SimInput(str, strlen(str));
+    HostOS_Delay(wait);
+}
+
+static void TestEcho()
+{
+    SimSend("hello", 20);
+    SimGetOutput(output, sizeof(output));
+    TEST_CHECK(strcmp(output, "[REC]hello[REC]\r\n") == 0);
+}
+
+static void TestEchoOrder()
+{
+    // 间隔到达的数据块分别回显, 且保持顺序
+    SimInput("one", 3);
+    HostOS_Delay(5);
+    SimInput("two", 3);
+    HostOS_Delay(5);
+    SimInput("three", 5);
+    HostOS_Delay(20);
+
+    SimGetOutput(output, sizeof(output));
+    TEST_CHECK(strcmp(output, "[REC]one[REC]\r\n[REC]two[REC]\r\n[REC]three[REC]\r\n") == 0);
+}
+
+#ifndef USE_UART
+
+static void TestPacketSplit()
+{
+    // 超过最大包长的数据按 64 字节分包接收, 每个数据包单独回显
+    char data[101];
+    for(size_t i = 0; i < 100; i++)
+    {
+        data[i] = 'a' + i % 26;
+    }
+    data[100] = 0;
+    SimSend(data, 20);
+
+    char expect[256];
+    snprintf(expect, sizeof(expect), "[REC]%.64s[REC]\r\n[REC]%s[REC]\r\n", data, data + 64);
+    SimGetOutput(output, sizeof(output));
+    TEST_CHECK(strcmp(output, expect) == 0);
+}
+
+#endif
+
+static void TestNoLeak()
+{
+    // 回显不泄漏内存
+    size_t blockNum = HostOS_GetHeapBlockNum();
+    for(int i = 0; i < 50; i++)
+    {
+        SimSend("leak check", 10);
+    }
+    SimGetOutput(output, sizeof(output));
+    TEST_CHECK(HostOS_GetHeapBlockNum() == blockNum);
+}
+
+#if (BYTE_BUF_USE_STAT == 1)
+
+static void TestStatBalance()
+{
+    // 回显结束后, 缓冲区对象统计中的存活对象数与字节数 (总体与各创建位置) 恢复原值
+    BufStat beg, end;
+    BufStatSite begSite[BUF_STAT_SITE_NUM], endSite;
+    BufStat_Get(&beg);
+    for(uint32_t i = 0; i < BUF_STAT_SITE_NUM; i++)
+    {
+        BufStat_GetSite(i, &begSite[i]);
+    }
+
+    for(int i = 0; i < 50; i++)
+    {
+        SimSend("stat check", 10);
+    }
+    SimGetOutput(output, sizeof(output));
+
+    BufStat_Get(&end);
+    TEST_CHECK(end._liveByteBuf == beg._liveByteBuf);
+    TEST_CHECK(end._liveConstBuf == beg._liveConstBuf);
+    TEST_CHECK(end._liveBytes == beg._liveBytes);
+    TEST_CHECK(end._peakNum > end._liveByteBuf + end._liveConstBuf);
+    TEST_CHECK(end._allocFail == 0);
+
+    // 创建位置为调用创建函数的源文件与行号, 回显路径上的对象均由外设模块与主任务创建, 且没有合并统计的位置
+    uint32_t siteNum = 0;
+    for(uint32_t i = 0; i < BUF_STAT_SITE_NUM; i++)
+    {
+        if(!BufStat_GetSite(i, &endSite))
+        {
+            continue;
+        }
+        siteNum++;
+        TEST_CHECK(endSite._file != NULL && endSite._line > 0);
+        TEST_CHECK(endSite._liveNum == begSite[i]._liveNum && endSite._liveBytes == begSite[i]._liveBytes);
+        TEST_CHECK(endSite._file != NULL && (strstr(endSite._file, "user_uart.c") != NULL || strstr(endSite._file, "user_main.c") != NULL));
+        printf("site %s:%u live=%u peak=%u\n",
+            strrchr(endSite._file, '/') ? strrchr(endSite._file, '/') + 1 : endSite._file, endSite._line, endSite._liveNum, endSite._peakBytes);
+    }
+    TEST_CHECK(siteNum > 0 && siteNum < BUF_STAT_SITE_NUM);
+}
+
+#endif
+
+int main()
+{
+    SimStart();
+
+    TestEcho();
+    TestEchoOrder();
+#ifndef USE_UART
+    TestPacketSplit();
+#endif
+    TestNoLeak();
+#if (BYTE_BUF_USE_STAT == 1)
+    TestStatBalance();
+#endif
+#ifdef USE_UART
+    TEST_CHECK(HostUart_GetLostNum() == 0);
+#endif
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,253 @@
+#include "cmsis_os.h"
+#include "i2c.h"
+#include "host_os.h"
+#include "host_sim.h"
+#include "test_util.h"
+#include "user_i2c.h"
+
+// I2C 任务帧链式执行的模拟测试, 直接通过 user_i2c.h 的接口提交任务帧 (以 I2C_USE_STAT 编译)
+// 测量任务帧之间的总线空闲时间, 并检查超时传输的终止, HAL 忙时的重新启动与分配失败
+
+void I2CManageTask(void* args);
+
+// 每帧读取的字节数 (MPU6050 加速度, 温度与角速度)
+#define FRAME_LEN 14
+// 测量总线空闲时间的任务帧数
+#define FRAME_NUM 200
+
+// MPU6050
+static HostI2CDev* mpu = NULL;
+// 时钟延展超过 I2C 超时的设备, 模拟总线挂起
+static HostI2CDev* hang = NULL;
+
+static uint32_t recSuccess = 0;
+static uint32_t recFail = 0;
+static uint32_t recBad = 0;
+static uint64_t recLastUs = 0;
+
+static void RecDone(uint8_t is_success, ConstBuf* data)
+{
+    if(!is_success)
+    {
+        recFail++;
+        return;
+    }
+    recSuccess++;
+    recLastUs = HostOS_GetTimeUs();
+    for(uint32_t i = 0; i < FRAME_LEN; i++)
+    {
+        if(data->_buf[i] != mpu->_reg[0x3B + i])
+        {
+            recBad++;
+            break;
+        }
+    }
+    ConstBuf_Delete(data);
+}
+
+static uint32_t normalSuccess = 0;
+static uint32_t normalFail = 0;
+
+static void NormalDone(uint8_t is_success)
+{
+    if(is_success)
+    {
+        normalSuccess++;
+    }
+    else
+    {
+        normalFail++;
+    }
+}
+
+static uint32_t resultFail = 0;
+
+static void ResultDone(uint8_t is_success, ConstBuf* data, void* ctx)
+{
+    if(!is_success)
+    {
+        resultFail++;
+    }
+    ConstBuf_Delete(data);
+}
+
+static void SimStart()
+{
+    mpu = HostI2C_AddDevice(0xD0);
+    for(uint32_t i = 0; i < FRAME_LEN; i++)
+    {
+        mpu->_reg[0x3B + i] = (uint8_t)(0x10 + i);
+    }
+    hang = HostI2C_AddDevice(0xA0);
+    hang->_stretch = 1000000;
+
+    osThreadAttr_t attr = {
+        .name = "I2CManage",
+        .priority = osPriorityHigh
+    };
+    osThreadNew(I2CManageTask, NULL, &attr);
+    HostOS_Delay(10);
+}
+
+static void TestBusIdle()
+{
+    // 每帧在总线上的时间: 设备地址, 寄存器地址, 重复起始后的读地址与数据, 每字节 9 位
+    const uint64_t frameUs = ((3 + FRAME_LEN) * 9 * 1000000 + 400000 - 1) / 400000;
+    I2CStat beg;
+    I2CGetStat(&beg);
+
+    uint32_t success = recSuccess;
+    uint64_t begUs = HostOS_GetTimeUs();
+    for(uint32_t i = 0; i < FRAME_NUM; i++)
+    {
+        TEST_CHECK(I2CRecData(0xD0, 0x3B, FRAME_LEN, RecDone, osWaitForever) == osOK);
+    }
+    HostOS_Delay(10);
+    TEST_CHECK(recSuccess - success == FRAME_NUM);
+    TEST_CHECK(recBad == 0);
+
+    I2CStat end;
+    I2CGetStat(&end);
+    uint32_t idleNum = end._idleNum - beg._idleNum;
+    TEST_CHECK(end._frameNum - beg._frameNum == FRAME_NUM);
+    // 除第一帧外, 提交者阻塞在任务队列上, 每帧开始时都有等待的任务帧
+    TEST_CHECK(idleNum >= FRAME_NUM - 2);
+
+    // 下一帧在完成中断中启动, 总线时间之外不占用虚拟时间
+    uint64_t busyUs = FRAME_NUM * frameUs;
+    uint64_t totalUs = recLastUs - begUs;
+    TEST_CHECK(totalUs == busyUs);
+
+    // 空闲的周期数只包含中断中启动下一帧的实际耗时, 应远小于一帧的时间
+    double idleUs = (double)(end._idleSum - beg._idleSum) / idleNum / (SystemCoreClock / 1000000);
+    TEST_CHECK(idleUs < frameUs);
+    printf("bus: %u frames in %llu us, utilization %.1f%%, idle avg %.2f us max %.2f us\n",
+        FRAME_NUM, (unsigned long long)totalUs, 100.0 * busyUs / totalUs, idleUs,
+        (double)end._idleMax / (SystemCoreClock / 1000000));
+}
+
+/**
+ * @brief 向挂起的设备读取, 之后的读取应在其超时后正常完成
+ */
+static void CheckHang()
+{
+    size_t blockNum = HostOS_GetHeapBlockNum();
+    uint32_t abortNum = HostI2C_GetAbortNum();
+    uint32_t success = recSuccess;
+    uint32_t fail = recFail;
+    uint32_t mpuReadNum = mpu->_readNum;
+
+    TEST_CHECK(I2CRecData(0xA0, 0x00, 4, RecDone, osWaitForever) == osOK);
+    TEST_CHECK(I2CRecData(0xD0, 0x3B, FRAME_LEN, RecDone, osWaitForever) == osOK);
+    TEST_CHECK(I2CRecData(0xD0, 0x3B, FRAME_LEN, RecDone, osWaitForever) == osOK);
+
+    // 超时前后一帧仍在等待
+    HostOS_Delay(50);
+    TEST_CHECK(recFail == fail);
+    TEST_CHECK(recSuccess == success);
+
+    HostOS_Delay(400);
+    TEST_CHECK(recFail - fail == 1);
+    TEST_CHECK(recSuccess - success == 2);
+    TEST_CHECK(mpu->_readNum - mpuReadNum == 2);
+    TEST_CHECK(HostI2C_GetAbortNum() - abortNum == 1);
+
+    // 挂起的传输已被终止, 延展结束后也不会再写入已释放的数据块
+    HostOS_Delay(1200);
+    TEST_CHECK(hang->_readNum == 0);
+    TEST_CHECK(HostOS_GetHeapBlockNum() == blockNum);
+
+    // 之后的传输不受影响
+    TEST_CHECK(I2CRecData(0xD0, 0x3B, FRAME_LEN, RecDone, osWaitForever) == osOK);
+    HostOS_Delay(5);
+    TEST_CHECK(recSuccess - success == 3);
+    TEST_CHECK(recBad == 0);
+}
+
+static void TestAbort()
+{
+    // 以 HAL_I2C_Master_Abort_IT 终止, 在终止完成回调中启动下一帧
+    HostI2C_SetMemAbort(1);
+    CheckHang();
+}
+
+static void TestReset()
+{
+    // 与 F1 HAL 相同, 寄存器读写不能终止, 停止 DMA 并重新初始化 I2C, 回调需重新注册
+    HostI2C_SetMemAbort(0);
+    CheckHang();
+}
+
+static void TestHalBusy()
+{
+    // HAL 忙时 (如仍在终止上一传输) 任务帧不应以失败清空任务队列
+    uint32_t success = recSuccess;
+    uint32_t fail = recFail;
+    hi2c1.State = HAL_I2C_STATE_BUSY;
+    for(uint32_t i = 0; i < 3; i++)
+    {
+        TEST_CHECK(I2CRecData(0xD0, 0x3B, FRAME_LEN, RecDone, osWaitForever) == osOK);
+    }
+    HostOS_Delay(20);
+    TEST_CHECK(recSuccess == success);
+    TEST_CHECK(recFail == fail);
+
+    hi2c1.State = HAL_I2C_STATE_READY;
+    HostOS_Delay(10);
+    TEST_CHECK(recSuccess - success == 3);
+    TEST_CHECK(recFail == fail);
+
+    // 一直忙时只有第一帧在 I2C_WAIT_TIMEOUT 后失败, 其余任务帧在恢复后完成
+    hi2c1.State = HAL_I2C_STATE_BUSY;
+    TEST_CHECK(I2CRecData(0xD0, 0x3B, FRAME_LEN, RecDone, osWaitForever) == osOK);
+    TEST_CHECK(I2CRecData(0xD0, 0x3B, FRAME_LEN, RecDone, osWaitForever) == osOK);
+    HostOS_Delay(150);
+    TEST_CHECK(recFail - fail == 1);
+    hi2c1.State = HAL_I2C_STATE_READY;
+    HostOS_Delay(10);
+    TEST_CHECK(recSuccess - success == 4);
+}
+
+static void TestNoMemory()
+{
+    size_t blockNum = HostOS_GetHeapBlockNum();
+    uint32_t fail = recFail;
+    ConstBuf* data = ConstBuf_CreateByConst((const uint8_t*)"\x00", 1);
+    I2CStep step = {I2C_STEP_WRITE, 0xD0, 0x6B, 0, 0, 1, (const uint8_t*)"\x00"};
+    I2CRequest req = {
+        ._actType = I2C_ACT_REC,
+        ._daddr = 0xD0,
+        ._raddr = 0x3B,
+        ._len = FRAME_LEN,
+        ._callBack = ResultDone,
+        ._priority = I2C_PRIO_NORMAL
+    };
+
+    // 分配失败时返回 osErrorNoMemory, 释放数据块并以失败回调
+    HostOS_SetHeapFail(1);
+    TEST_CHECK(I2CSendData(0xD0, 0x6B, data, NormalDone, osWaitForever) == osErrorNoMemory);
+    TEST_CHECK(I2CRecData(0xD0, 0x3B, FRAME_LEN, RecDone, osWaitForever) == osErrorNoMemory);
+    TEST_CHECK(I2CTouch(0xD0, 1, NormalDone, osWaitForever) == osErrorNoMemory);
+    TEST_CHECK(I2CSubmit(&req, osWaitForever) == osErrorNoMemory);
+    TEST_CHECK(I2CSubmitTransaction(&step, 1, ResultDone, NULL, osWaitForever) == osErrorNoMemory);
+    HostOS_SetHeapFail(0);
+
+    TEST_CHECK(normalFail == 2);
+    TEST_CHECK(recFail - fail == 1);
+    TEST_CHECK(resultFail == 2);
+    TEST_CHECK(HostOS_GetHeapBlockNum() == blockNum);
+    TEST_CHECK(mpu->_writeNum == 0);
+}
+
+int main()
+{
+    SimStart();
+
+    TestBusIdle();
+    TestAbort();
+    TestReset();
+    TestHalBusy();
+    TestNoMemory();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,150 @@
+#include "cmsis_os.h"
+#include "host_os.h"
+#include "host_sim.h"
+#include "test_util.h"
+
+// I2C 指令项目 (i2c_cmd_uart 与 i2c_cmd_usb_vpc) 的模拟测试, 总线上挂载模拟的 MPU6050, 通过指令读写寄存器
+
+void LedBlinkTask(void* argument);
+void MainLoopTask(void* argument);
+void I2CManageTask(void* args);
+
+#ifdef USE_UART
+void UART1SendTask(void* args);
+void UART1ReceiveTask(void* args);
+#define SimInput HostUart_Input
+#define SimGetOutput HostUart_GetOutput
+#else
+void USB_VPC_ReceiveTask(void* args);
+void USB_VPC_SendTask(void* args);
+#define SimInput HostUsb_Input
+#define SimGetOutput HostUsb_GetOutput
+#endif
+
+typedef struct SIMTASK
+{
+    const char* _name;
+    osThreadFunc_t _func;
+    osPriority_t _prio;
+} SimTask;
+
+// 与 project 中 .ioc 的任务表相同 (创建顺序与优先级)
+static const SimTask simTask[] = {
+#ifdef USE_UART
+    {"LedBlink", LedBlinkTask, osPriorityNormal},
+    {"UART1Send", UART1SendTask, osPriorityHigh},
+    {"UART1Receive", UART1ReceiveTask, osPriorityLow},
+    {"MainLoop", MainLoopTask, osPriorityLow},
+    {"I2CManage", I2CManageTask, osPriorityHigh},
+#else
+    {"LedBlink", LedBlinkTask, osPriorityNormal},
+    {"MainLoop", MainLoopTask, osPriorityLow},
+    {"I2CManage", I2CManageTask, osPriorityHigh},
+    {"USB_VPC_Receive", USB_VPC_ReceiveTask, osPriorityHigh},
+    {"USB_VPC_Send", USB_VPC_SendTask, osPriorityHigh},
+#endif
+};
+
+// MPU6050
+static HostI2CDev* mpu = NULL;
+static char output[4096];
+
+static void SimStart()
+{
+    mpu = HostI2C_AddDevice(0xD0);
+    // WHO_AM_I
+    mpu->_reg[0x75] = 0x68;
+    // PWR_MGMT_1 复位值
+    mpu->_reg[0x6B] = 0x40;
+
+    for(size_t i = 0; i < sizeof(simTask) / sizeof(simTask[0]); i++)
+    {
+        osThreadAttr_t attr = {
+            .name = simTask[i]._name,
+            .priority = simTask[i]._prio
+        };
+        osThreadNew(simTask[i]._func, NULL, &attr);
+    }
+    HostOS_Delay(10);
+}
+
+/**
+ * @brief 发送一条指令并取出其全部回复
+ */
+static const char* SimCommand(const char* cmd)
+{
+    SimInput(cmd, strlen(cmd));
+    HostOS_Delay(50);
+    SimGetOutput(output, sizeof(output));
+    return output;
+}
+
+static void TestRec()
+{
+    const char* res = SimCommand("REC D07501");
+    TEST_CHECK(strstr(res, "[REC]REC D07501[REC]\r\n") == res);
+    TEST_CHECK(strstr(res, "Rec Done\r\n") != NULL);
+    TEST_CHECK(strstr(res, "Rec: 68\r\n") != NULL);
+    TEST_CHECK(mpu->_readNum == 1);
+}
+
+static void TestSend()
+{
+    const char* res = SimCommand("SEND D06B00");
+    TEST_CHECK(strstr(res, "Send Done\r\n") != NULL);
+    TEST_CHECK(strstr(res, "Success!\r\n") != NULL);
+    TEST_CHECK(mpu->_reg[0x6B] == 0x00);
+    TEST_CHECK(mpu->_writeNum == 1);
+
+    // 写入后读回
+    res = SimCommand("REC D06B01");
+    TEST_CHECK(strstr(res, "Rec: 00\r\n") != NULL);
+}
+
+static void TestTouch()
+{
+    const char* res = SimCommand("TOUCH D001");
+    TEST_CHECK(strstr(res, "Touch Done\r\n") != NULL);
+    TEST_CHECK(strstr(res, "Success!\r\n") != NULL);
+
+    // SSD1306 不在总线上
+    res = SimCommand("TOUCH 7801");
+    TEST_CHECK(strstr(res, "Touch Done\r\n") != NULL);
+    TEST_CHECK(strstr(res, "Fail!\r\n") != NULL);
+
+    res = SimCommand("REC 787501");
+    TEST_CHECK(strstr(res, "Fail!\r\n") != NULL);
+}
+
+static void TestBadCommand()
+{
+    const char* res = SimCommand("FOO D0");
+    TEST_CHECK(strstr(res, "Unknown Body\r\n") != NULL);
+
+    res = SimCommand("REC D075");
+    TEST_CHECK(strstr(res, "Incorrect Args: 2\r\n") != NULL);
+}
+
+static void TestNoLeak()
+{
+    size_t blockNum = HostOS_GetHeapBlockNum();
+    for(int i = 0; i < 20; i++)
+    {
+        SimCommand("REC D07501");
+        SimCommand("SEND D06B00");
+    }
+    TEST_CHECK(HostOS_GetHeapBlockNum() == blockNum);
+}
+
+int main()
+{
+    SimStart();
+
+    TestRec();
+    TestSend();
+    TestTouch();
+    TestBadCommand();
+    TestNoLeak();
+
+    return TEST_RESULT();
+}
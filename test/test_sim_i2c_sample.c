@@ -0,0 +1,287 @@
+#include "cmsis_os.h"
+#include "host_os.h"
+#include "host_sim.h"
+#include "test_util.h"
+#include "user_i2c.h"
+
+#include <string.h>
+
+// I2C 周期采样调度器的模拟测试, 总线上挂载多个模拟的传感器
+// 虚拟时钟在所有任务阻塞时直接推进, 数十秒的采样只需很短的实际时间
+
+void I2CManageTask(void* args);
+
+// 模拟运行的时长 (ms)
+#define SIM_TIME 60000
+// 使用者批量读取的间隔 (ms), 期间的采样数不超过环形缓冲区容量
+#define READ_INTERVAL 40
+
+// MPU6050, 读取加速度, 温度与角速度
+static HostI2CDev* mpu = NULL;
+// BMP280, 读取气压与温度
+static HostI2CDev* bmp = NULL;
+// 每次读取都延展时钟的慢速设备
+static HostI2CDev* slow = NULL;
+
+/**
+ * @brief 注册采样任务时的期望结果
+ */
+typedef struct SAMPLECASE
+{
+    HostI2CDev* _dev;
+    uint8_t _raddr;
+    uint8_t _len;
+    uint32_t _period;
+    // 注册得到的编号
+    int32_t _job;
+    // 采样的相位, -1 为尚未收到采样
+    int32_t _phase;
+    // 上一次采样的时刻
+    uint32_t _last;
+    // 取出的采样数
+    uint32_t _num;
+} SampleCase;
+
+static I2CSample samples[I2C_SAMPLE_RING_SIZE];
+// 取出的数据与设备寄存器不一致, 时刻不满足周期或相位, 或采样顺序错误的次数
+static uint32_t sampleBadNum = 0;
+// 不同任务在同一时刻采样的次数
+static uint32_t sampleCollideNum = 0;
+
+static void SimStart()
+{
+    mpu = HostI2C_AddDevice(0xD0);
+    for(uint32_t i = 0; i < 14; i++)
+    {
+        mpu->_reg[0x3B + i] = (uint8_t)(0x10 + i);
+    }
+    bmp = HostI2C_AddDevice(0xEC);
+    for(uint32_t i = 0; i < 6; i++)
+    {
+        bmp->_reg[0xF7 + i] = (uint8_t)(0x80 + i);
+    }
+    slow = HostI2C_AddDevice(0x90);
+    slow->_reg[0x00] = 0x19;
+    slow->_reg[0x01] = 0x40;
+
+    osThreadAttr_t attr = {
+        .name = "I2CManage",
+        .priority = osPriorityHigh
+    };
+    osThreadNew(I2CManageTask, NULL, &attr);
+    HostOS_Delay(10);
+}
+
+static void CaseAdd(SampleCase* cases, size_t num)
+{
+    for(size_t i = 0; i < num; i++)
+    {
+        cases[i]._job = I2CSampleAdd(cases[i]._dev->_daddr, cases[i]._raddr, cases[i]._len, cases[i]._period);
+        cases[i]._phase = -1;
+        cases[i]._num = 0;
+        TEST_CHECK(cases[i]._job >= 0);
+    }
+}
+
+static void CaseRemove(SampleCase* cases, size_t num)
+{
+    for(size_t i = 0; i < num; i++)
+    {
+        I2CSampleRemove(cases[i]._job);
+    }
+    // 等待已放入任务队列的采样完成, 并清空环形缓冲区
+    HostOS_Delay(50);
+    while(I2CSampleRead(samples, I2C_SAMPLE_RING_SIZE) > 0)
+    {
+    }
+}
+
+/**
+ * @brief 批量取出采样结果并逐条检查
+ *
+ * @param is_strict 是否要求每个计划时刻都按时采样
+ */
+static void CaseRead(SampleCase* cases, size_t num, uint8_t is_strict)
+{
+    static uint32_t lastTick = 0;
+    static int32_t lastJob = -1;
+
+    size_t n = I2CSampleRead(samples, I2C_SAMPLE_RING_SIZE);
+    for(size_t i = 0; i < n; i++)
+    {
+        I2CSample* sample = &samples[i];
+        SampleCase* c = NULL;
+        for(size_t j = 0; j < num; j++)
+        {
+            if(cases[j]._job == sample->_job)
+            {
+                c = &cases[j];
+            }
+        }
+        if(c == NULL || sample->_len != c->_len || memcmp(sample->_data, c->_dev->_reg + c->_raddr, c->_len) != 0)
+        {
+            sampleBadNum++;
+            continue;
+        }
+
+        // 按采样顺序取出, 时刻不减
+        if((int32_t)(sample->_tick - lastTick) < 0)
+        {
+            sampleBadNum++;
+        }
+        if(sample->_tick == lastTick && sample->_job != lastJob)
+        {
+            sampleCollideNum++;
+        }
+        lastTick = sample->_tick;
+        lastJob = sample->_job;
+
+        if(is_strict)
+        {
+            // 按时采样时, 每个任务的采样时刻相位固定, 间隔为一个周期
+            int32_t phase = sample->_tick % c->_period;
+            if((c->_phase >= 0 && phase != c->_phase) || (c->_num > 0 && sample->_tick - c->_last != c->_period))
+            {
+                sampleBadNum++;
+            }
+            c->_phase = phase;
+        }
+        c->_last = sample->_tick;
+        c->_num++;
+    }
+}
+
+static void TestSchedule()
+{
+    SampleCase cases[] = {
+        {mpu, 0x3B, 14, 10},
+        {bmp, 0xF7, 6, 20},
+        {mpu, 0x43, 6, 10},
+        {bmp, 0xFA, 3, 50},
+    };
+    const size_t num = sizeof(cases) / sizeof(cases[0]);
+    CaseAdd(cases, num);
+
+    size_t allocNum = HostOS_GetHeapAllocNum();
+    uint64_t realNs = HostOS_GetRealNs();
+    for(uint32_t t = 0; t < SIM_TIME; t += READ_INTERVAL)
+    {
+        HostOS_Delay(READ_INTERVAL);
+        CaseRead(cases, num, 1);
+    }
+    realNs = HostOS_GetRealNs() - realNs;
+
+    // 采样不分配内存, 结果也没有因缓冲区已满而丢弃
+    TEST_CHECK(HostOS_GetHeapAllocNum() == allocNum);
+    TEST_CHECK(I2CSampleGetDropNum() == 0);
+    TEST_CHECK(sampleBadNum == 0);
+    // 相位对齐后各任务的计划时刻不重合
+    TEST_CHECK(sampleCollideNum == 0);
+
+    for(size_t i = 0; i < num; i++)
+    {
+        I2CSampleStat stat;
+        TEST_CHECK(I2CSampleGetStat(cases[i]._job, &stat));
+        uint32_t expect = SIM_TIME / cases[i]._period;
+        TEST_CHECK(cases[i]._num + 1 >= expect && cases[i]._num <= expect + 1);
+        TEST_CHECK(stat._sampleNum == cases[i]._num);
+        TEST_CHECK(stat._failNum == 0);
+        TEST_CHECK(stat._missNum == 0);
+        TEST_CHECK(stat._lateMax == 0);
+    }
+
+    // 两个 10ms 的任务与 20ms, 50ms 的任务两两错开
+    TEST_CHECK(cases[0]._phase % 10 != cases[2]._phase % 10);
+    TEST_CHECK(cases[1]._phase % 10 != cases[0]._phase % 10);
+    TEST_CHECK(cases[1]._phase % 10 != cases[2]._phase % 10);
+    TEST_CHECK(cases[3]._phase % 10 != cases[0]._phase % 10);
+    TEST_CHECK(cases[3]._phase % 10 != cases[1]._phase % 10);
+    TEST_CHECK(cases[3]._phase % 10 != cases[2]._phase % 10);
+
+    printf("sample: %u s simulated in %.1f ms real time, %u samples\n", SIM_TIME / 1000, realNs / 1e6,
+        cases[0]._num + cases[1]._num + cases[2]._num + cases[3]._num);
+    CaseRemove(cases, num);
+}
+
+static void TestLateAndFail()
+{
+    // 慢速设备每次读取延展 15ms, 超过其周期, 其后的计划时刻被错过
+    slow->_stretch = 15000;
+    SampleCase cases[] = {
+        {slow, 0x00, 2, 10},
+        {mpu, 0x3B, 14, 10},
+    };
+    const size_t num = sizeof(cases) / sizeof(cases[0]);
+    CaseAdd(cases, num);
+    // 不存在的设备, 每次读取都失败
+    int32_t absent = I2CSampleAdd(0x92, 0x00, 2, 20);
+    TEST_CHECK(absent >= 0);
+
+    for(uint32_t t = 0; t < 10000; t += READ_INTERVAL)
+    {
+        HostOS_Delay(READ_INTERVAL);
+        CaseRead(cases, num, 0);
+    }
+    TEST_CHECK(sampleBadNum == 0);
+    TEST_CHECK(I2CSampleGetDropNum() == 0);
+
+    I2CSampleStat stat;
+    TEST_CHECK(I2CSampleGetStat(cases[0]._job, &stat));
+    TEST_CHECK(stat._sampleNum == cases[0]._num);
+    TEST_CHECK(stat._missNum > 0);
+    TEST_CHECK(stat._lateMax > 0 && stat._lateMax < cases[0]._period);
+    // 错过的计划时刻被跳过, 采样与错过的总数与计划时刻数相当
+    TEST_CHECK(stat._sampleNum + stat._missNum + 2 >= 10000 / cases[0]._period);
+    printf("slow job: %u samples, %u missed, late max %u ms avg %.2f ms\n", stat._sampleNum, stat._missNum,
+        stat._lateMax, (double)stat._lateSum / (stat._sampleNum + stat._failNum));
+
+    // 同一总线上的其他任务也被推迟, 延迟记录在统计中
+    TEST_CHECK(I2CSampleGetStat(cases[1]._job, &stat));
+    TEST_CHECK(stat._sampleNum == cases[1]._num && stat._sampleNum > 0);
+    TEST_CHECK(stat._lateMax > 0);
+
+    // 失败的读取不写入环形缓冲区
+    TEST_CHECK(I2CSampleGetStat(absent, &stat));
+    TEST_CHECK(stat._sampleNum == 0);
+    TEST_CHECK(stat._failNum + 2 >= 10000 / 20 / 2);
+
+    I2CSampleRemove(absent);
+    CaseRemove(cases, num);
+    slow->_stretch = 0;
+}
+
+static void TestDrop()
+{
+    SampleCase cases[] = {
+        {mpu, 0x3B, 14, 5},
+    };
+    CaseAdd(cases, 1);
+
+    // 使用者停止读取时丢弃最旧的结果, 保留最近的 I2C_SAMPLE_RING_SIZE 条
+    uint32_t drop = I2CSampleGetDropNum();
+    HostOS_Delay(1000);
+    uint32_t now = osKernelGetTickCount();
+    TEST_CHECK(I2CSampleGetDropNum() - drop + I2C_SAMPLE_RING_SIZE + 1 >= 1000 / 5);
+
+    size_t n = I2CSampleRead(samples, I2C_SAMPLE_RING_SIZE);
+    TEST_CHECK(n == I2C_SAMPLE_RING_SIZE);
+    // 使用者优先级更高, 可能先于同一时刻的采样醒来
+    TEST_CHECK(now - samples[n - 1]._tick <= 5);
+    for(size_t i = 1; i < n; i++)
+    {
+        TEST_CHECK(samples[i]._tick - samples[i - 1]._tick == 5);
+    }
+
+    CaseRemove(cases, 1);
+}
+
+int main()
+{
+    SimStart();
+
+    TestSchedule();
+    TestLateAndFail();
+    TestDrop();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,168 @@
+#include "task_signal.h"
+#include "cmsis_os.h"
+#include "host_os.h"
+#include "test_util.h"
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// 往返测试的次数
+#define PING_NUM 20000
+
+// 测试主线程绑定的信号 (每个任务只能绑定一个信号)
+static TaskSignal mainSignal;
+static HostEvent isrEvent;
+
+static void IsrGive(void* arg)
+{
+    TaskSignal_Give(&mainSignal, (uint32_t)(uintptr_t)arg);
+}
+
+static void IsrPost(void* arg)
+{
+    (void)arg;
+    TaskSignal_Post(&mainSignal);
+}
+
+static void TestIsrSignal()
+{
+    uint32_t value = 0;
+    TaskSignal_Bind(&mainSignal);
+
+    // 中断中发出的信号值被等待的任务接收, 且唤醒时间与中断时刻相同
+    uint64_t beg = HostOS_GetTimeUs();
+    HostEvent_Start(&isrEvent, 300, IsrGive, (void*)(uintptr_t)(TASK_SIGNAL_ERROR | 5u));
+    TEST_CHECK(TaskSignal_Wait(&mainSignal, 10, &value) == 1);
+    TEST_CHECK(value == (TASK_SIGNAL_ERROR | 5u));
+    TEST_CHECK(HostOS_GetTimeUs() - beg == 300);
+
+    // 超时
+    beg = HostOS_GetTimeUs();
+    TEST_CHECK(TaskSignal_Wait(&mainSignal, 3, &value) == 0);
+    TEST_CHECK(HostOS_GetTimeUs() - beg >= 2000);
+
+    // 计数信号不会丢失
+    HostEvent_Start(&isrEvent, 100, IsrPost, NULL);
+    HostOS_DelayUs(200);
+    HostEvent_Start(&isrEvent, 100, IsrPost, NULL);
+    HostOS_DelayUs(200);
+    TEST_CHECK(TaskSignal_Pend(&mainSignal, 0) == 1);
+    TEST_CHECK(TaskSignal_Pend(&mainSignal, 0) == 1);
+    TEST_CHECK(TaskSignal_Pend(&mainSignal, 1) == 0);
+}
+
+static TaskSignal otherSignal;
+
+static void TestSingleBind()
+{
+    // 重复绑定同一信号是允许的
+    TaskSignal_Bind(&mainSignal);
+    TEST_CHECK(mainSignal._task == xTaskGetCurrentTaskHandle());
+
+    // 同一任务绑定第二个信号时进入 Error_Handler (在子进程中检查)
+    fflush(NULL);
+    pid_t pid = fork();
+    if(pid == 0)
+    {
+        TaskSignal_Bind(&otherSignal);
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    TEST_CHECK(WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT);
+    TEST_CHECK(otherSignal._task == NULL);
+}
+
+//********** 唤醒延迟 **********//
+
+static TaskSignal toTask;
+static osSemaphoreId_t toTaskSem;
+static osSemaphoreId_t toMainSem;
+static uint32_t pongErrNum = 0;
+
+static void SignalPongTask(void* args)
+{
+    (void)args;
+    TaskSignal_Bind(&toTask);
+    TaskSignal_Give(&mainSignal, 0);
+    for(uint32_t i = 0; i < PING_NUM; i++)
+    {
+        uint32_t value = 0;
+        TaskSignal_Wait(&toTask, osWaitForever, &value);
+        if(value != i)
+        {
+            pongErrNum++;
+        }
+        TaskSignal_Give(&mainSignal, value);
+    }
+}
+
+static void SemaphorePongTask(void* args)
+{
+    (void)args;
+    for(uint32_t i = 0; i < PING_NUM; i++)
+    {
+        osSemaphoreAcquire(toTaskSem, osWaitForever);
+        osSemaphoreRelease(toMainSem);
+    }
+}
+
+static void TestLatency()
+{
+    // 两个任务之间来回唤醒, 比较任务通知与二值信号量的往返耗时
+    // 主机上的耗时主要为线程切换, 仅用于比较两种方式; 目标上的唤醒延迟可通过 TASK_SIGNAL_USE_STAT 测量
+    osThreadAttr_t attr = {
+        .name = "Pong",
+        .priority = osPriorityNormal
+    };
+
+    osThreadNew(SignalPongTask, NULL, &attr);
+    TaskSignal_Wait(&mainSignal, osWaitForever, NULL);
+
+    uint64_t switchNum = HostOS_GetSwitchNum();
+    uint64_t beg = HostOS_GetRealNs();
+    for(uint32_t i = 0; i < PING_NUM; i++)
+    {
+        uint32_t value = 0;
+        TaskSignal_Give(&toTask, i);
+        TaskSignal_Wait(&mainSignal, osWaitForever, &value);
+        if(value != i)
+        {
+            pongErrNum++;
+        }
+    }
+    uint64_t signalNs = HostOS_GetRealNs() - beg;
+    uint64_t signalSwitch = HostOS_GetSwitchNum() - switchNum;
+    TEST_CHECK(pongErrNum == 0);
+    // 等待任务退出
+    HostOS_Delay(1);
+
+    toTaskSem = osSemaphoreNew(1, 0, NULL);
+    toMainSem = osSemaphoreNew(1, 0, NULL);
+    osThreadNew(SemaphorePongTask, NULL, &attr);
+
+    switchNum = HostOS_GetSwitchNum();
+    beg = HostOS_GetRealNs();
+    for(uint32_t i = 0; i < PING_NUM; i++)
+    {
+        osSemaphoreRelease(toTaskSem);
+        osSemaphoreAcquire(toMainSem, osWaitForever);
+    }
+    uint64_t semNs = HostOS_GetRealNs() - beg;
+    uint64_t semSwitch = HostOS_GetSwitchNum() - switchNum;
+
+    // 两种方式每次往返均切换两次任务
+    TEST_CHECK(signalSwitch == 2 * PING_NUM);
+    TEST_CHECK(semSwitch == 2 * PING_NUM);
+    printf("round trip: task signal %.0f ns, semaphore %.0f ns (%u round trips)\n",
+        (double)signalNs / PING_NUM, (double)semNs / PING_NUM, PING_NUM);
+}
+
+int main()
+{
+    TestIsrSignal();
+    TestSingleBind();
+    TestLatency();
+    return TEST_RESULT();
+}
@@ -0,0 +1,39 @@
+/**
+ * @file test_util.h
+ * @author tonyddg (tonyddg@outlook.com)
+ * @brief 主机单元测试使用的断言宏
+ * @version 0.1
+ * @date 2024-02-04
+ * 
+ * @copyright Copyright (c) 2024
+ * 
+ */
+
+#ifndef TEST_UTIL_DEF
+#define TEST_UTIL_DEF
+
+#include <stdio.h>
+#include <string.h>
+
+// 失败的断言数, 各测试程序以其作为返回值
+static int testFailNum = 0;
+
+// 断言失败时输出位置并计数, 之后的断言继续执行
+#define TEST_CHECK(cond) \
+    do \
+    { \
+        if(!(cond)) \
+        { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            testFailNum++; \
+        } \
+    } while(0)
+
+// 比较两段内存是否相同
+#define TEST_CHECK_MEM(a, b, len) TEST_CHECK(memcmp((a), (b), (len)) == 0)
+
+// 输出结果并作为测试程序的返回值
+#define TEST_RESULT() \
+    (fprintf(testFailNum == 0 ? stdout : stderr, "%s: %d check(s) failed\n", __FILE__, testFailNum), testFailNum != 0)
+
+#endif
@@ -3,19 +3,26 @@ set(CMAKE_SYSTEM_NAME Generic)
 set(CMAKE_SYSTEM_PROCESSOR arm)
 set(CMAKE_TRY_COMPILE_TARGET_TYPE STATIC_LIBRARY)
 
+# 可执行文件后缀, 仅 Windows 下为 .exe
+if(CMAKE_HOST_WIN32)
+    set(TOOLCHAIN_EXT ".exe")
+else()
+    set(TOOLCHAIN_EXT "")
+endif()
+
 # 指定工具链
 set(CMAKE_C_COMPILER_FORCED TRUE) # skip compiler test
 set(CMAKE_CXX_COMPILER_FORCED TRUE)
 
-set(CMAKE_C_COMPILER ${TOOLCHAIN_PATH}/arm-none-eabi-gcc.exe)
-set(CMAKE_CXX_COMPILER ${TOOLCHAIN_PATH}/arm-none-eabi-g++.exe)
-set(CMAKE_ASM_COMPILER ${TOOLCHAIN_PATH}/arm-none-eabi-gcc.exe)
-set(CMAKE_LINKER ${TOOLCHAIN_PATH}/arm-none-eabi-ld.exe) # 根据知乎介绍补充
+set(CMAKE_C_COMPILER ${TOOLCHAIN_PATH}/arm-none-eabi-gcc${TOOLCHAIN_EXT})
+set(CMAKE_CXX_COMPILER ${TOOLCHAIN_PATH}/arm-none-eabi-g++${TOOLCHAIN_EXT})
+set(CMAKE_ASM_COMPILER ${TOOLCHAIN_PATH}/arm-none-eabi-gcc${TOOLCHAIN_EXT})
+set(CMAKE_LINKER ${TOOLCHAIN_PATH}/arm-none-eabi-ld${TOOLCHAIN_EXT}) # 根据知乎介绍补充
 
-set(CMAKE_OBJCOPY ${TOOLCHAIN_PATH}/arm-none-eabi-objcopy.exe)
-set(CMAKE_OBJDUMP ${TOOLCHAIN_PATH}/arm-none-eabi-objdump.exe)
-set(SIZE ${TOOLCHAIN_PATH}/arm-none-eabi-size.exe) 
-set(CMAKE_AR ${TOOLCHAIN_PATH}/arm-none-eabi-ar.exe)
+set(CMAKE_OBJCOPY ${TOOLCHAIN_PATH}/arm-none-eabi-objcopy${TOOLCHAIN_EXT})
+set(CMAKE_OBJDUMP ${TOOLCHAIN_PATH}/arm-none-eabi-objdump${TOOLCHAIN_EXT})
+set(SIZE ${TOOLCHAIN_PATH}/arm-none-eabi-size${TOOLCHAIN_EXT}) 
+set(CMAKE_AR ${TOOLCHAIN_PATH}/arm-none-eabi-ar${TOOLCHAIN_EXT})
 
 # cube 自动生成的 .ld 链接脚本 
 set(LINK_SCRIPT ${CMAKE_SOURCE_DIR}/STM32F103C8Tx_FLASH.ld) 
@@ -39,7 +46,7 @@ set(CMAKE_EXE_LINKER_FLAGS -T${LINK_SCRIPT})
 # OpenOCD 设置
 
 # 可执行文件地址
-set(OpenOCDPath ${OpenOCDRoot}/bin/openocd.exe)
+set(OpenOCDPath ${OpenOCDRoot}/bin/openocd${TOOLCHAIN_EXT})
 # 烧录器配置路径
 set(OpenOCPInterface ${OpenOCDRoot}/share/openocd/scripts/interface/cmsis-dap.cfg)
 # 目标芯片路径
@@ -0,0 +1,152 @@
+"""
+二进制数据帧 (COBS 编码, CRC-16/CCITT-FALSE 校验, 以 0x00 结尾) 的上位机编解码, 与 user/bin_frame.c 一致
+
+作为模块使用:
+    from bin_frame import encode, FrameDecoder
+
+直接运行时, 比较二进制数据帧与 I2C 控制台十六进制文本指令的线上字节数与编解码速度:
+    python bin_frame.py --count 20000
+"""
+
+import argparse
+import random
+import time
+
+
+def _make_table():
+    table = []
+    for i in range(256):
+        crc = i << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+        table.append(crc & 0xFFFF)
+    return table
+
+
+CRC_TABLE = _make_table()
+
+
+def crc16(data, crc=0xFFFF):
+    for b in data:
+        crc = ((crc << 8) & 0xFFFF) ^ CRC_TABLE[((crc >> 8) ^ b) & 0xFF]
+    return crc
+
+
+def cobs_encode(data):
+    out = bytearray(b"\x00")
+    code_idx = 0
+    code = 1
+    for b in data:
+        if b == 0:
+            out[code_idx] = code
+            code_idx = len(out)
+            out.append(0)
+            code = 1
+        else:
+            out.append(b)
+            code += 1
+            if code == 0xFF:
+                out[code_idx] = code
+                code_idx = len(out)
+                out.append(0)
+                code = 1
+    out[code_idx] = code
+    return bytes(out)
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            raise ValueError("COBS 格式错误")
+        out += data[i + 1:i + code]
+        i += code
+        if code != 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def encode(payload):
+    """将数据编码为完整的数据帧 (含结尾的 0x00)"""
+    crc = crc16(payload)
+    return cobs_encode(payload + bytes([crc >> 8, crc & 0xFF])) + b"\x00"
+
+
+class FrameDecoder:
+    """从任意切分的数据流中取出校验通过的数据帧"""
+
+    def __init__(self):
+        self.buf = bytearray()
+        self.crc_error = 0
+
+    def feed(self, data):
+        frames = []
+        self.buf += data
+        while True:
+            end = self.buf.find(b"\x00")
+            if end < 0:
+                break
+            raw = bytes(self.buf[:end])
+            del self.buf[:end + 1]
+            if not raw:
+                continue
+            try:
+                frame = cobs_decode(raw)
+            except ValueError:
+                self.crc_error += 1
+                continue
+            if len(frame) < 2 or crc16(frame) != 0:
+                self.crc_error += 1
+                continue
+            frames.append(frame[:-2])
+        return frames
+
+
+def hex_encode(name, payload):
+    """I2C 控制台的十六进制文本指令, 如 SEND 78008D14\\r\\n"""
+    return name + b" " + payload.hex().upper().encode() + b"\r\n"
+
+
+def hex_decode(line):
+    name, _, args = line.rstrip(b"\r\n").partition(b" ")
+    return name, bytes.fromhex(args.decode())
+
+
+def bench(args):
+    rng = random.Random(args.seed)
+    # 模拟控制台指令: 1 字节指令, 设备地址, 寄存器地址与数据
+    payloads = [bytes(rng.randrange(256) for _ in range(2 + rng.randint(0, args.size))) for _ in range(args.count)]
+
+    res = {}
+    beg = time.perf_counter()
+    wire = [hex_encode(b"SEND", p) for p in payloads]
+    for line in wire:
+        hex_decode(line)
+    res["hex"] = (sum(len(w) for w in wire), time.perf_counter() - beg)
+
+    beg = time.perf_counter()
+    wire = [encode(b"\x01" + p) for p in payloads]
+    decoder = FrameDecoder()
+    num = len(decoder.feed(b"".join(wire)))
+    res["frame"] = (sum(len(w) for w in wire), time.perf_counter() - beg)
+    assert num == args.count
+
+    payload_bytes = sum(len(p) for p in payloads)
+    print("payload bytes: %d" % payload_bytes)
+    for name, (wire_bytes, elapsed) in res.items():
+        print("%-6s wire bytes: %8d (%.2fx)  host codec: %9.0f frame/s" % (
+            name, wire_bytes, wire_bytes / payload_bytes, args.count / elapsed))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="二进制数据帧与十六进制文本指令的比较")
+    parser.add_argument("--count", type=int, default=10000, help="指令数量")
+    parser.add_argument("--size", type=int, default=16, help="指令数据的最大长度")
+    parser.add_argument("--seed", type=int, default=0, help="随机种子")
+    bench(parser.parse_args())
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,183 @@
+"""
+UART / USB VPC 回显项目 (uart_io, usb_vpc) 的吞吐量与延迟测试
+
+通过串口向单片机发送合成数据, 并根据回显 `[REC]...[REC]\r\n` 统计
+吞吐量, 延迟 (p50 / p99 / max), 丢失数量, 以及单片机的堆使用峰值 (需启用 USE_BENCH)
+
+依赖 pyserial: pip install pyserial
+
+示例:
+    python echo_bench.py COM3 --pattern fixed --size 32 --count 2000
+    python echo_bench.py /dev/ttyACM0 --pattern burst --burst 8 --format json --out res.json
+"""
+
+import argparse
+import csv
+import json
+import random
+import re
+import sys
+import threading
+import time
+
+import serial
+
+# 每条消息的格式为 <S序号:填充字符>, 序号用于匹配回显
+MSG_HEAD_LEN = len("<S00000000:>")
+MSG_PATTERN = re.compile(rb"<S(\d{8}):[a-z]*>")
+# 回显中由单片机添加的标记
+ECHO_MARK = re.compile(rb"\[REC\]|\r\n|\x00")
+BENCH_PATTERN = re.compile(rb"\[BENCH\]heap_free=(\d+),heap_min=(\d+)\[BENCH\]")
+
+
+def make_msg(seq, size):
+    filler = bytes(ord("a") + (seq + i) % 26 for i in range(max(size - MSG_HEAD_LEN, 0)))
+    return b"<S%08d:" % seq + filler + b">"
+
+
+class EchoReader(threading.Thread):
+    """后台读取回显, 并记录每条消息的到达时刻"""
+
+    def __init__(self, port):
+        super().__init__(daemon=True)
+        self.port = port
+        self.arrive = {}
+        self.raw = bytearray()
+        self.running = True
+
+    def run(self):
+        stream = bytearray()
+        while self.running:
+            data = self.port.read(4096)
+            if not data:
+                continue
+            now = time.perf_counter()
+            self.raw += data
+            # 去除回显标记后, 被分到多个数据块中的消息将重新拼接
+            stream += ECHO_MARK.sub(b"", data)
+            end = 0
+            for m in MSG_PATTERN.finditer(stream):
+                self.arrive.setdefault(int(m.group(1)), now)
+                end = m.end()
+            del stream[:end]
+
+
+def percentile(values, p):
+    if not values:
+        return 0.0
+    values = sorted(values)
+    idx = min(len(values) - 1, int(round(p / 100.0 * (len(values) - 1))))
+    return values[idx]
+
+
+def run(args):
+    port = serial.Serial(args.port, args.baud, timeout=0.01)
+    reader = EchoReader(port)
+    reader.start()
+
+    rng = random.Random(args.seed)
+    send_time = {}
+    sent_bytes = 0
+    beg = time.perf_counter()
+
+    seq = 0
+    while seq < args.count:
+        if args.pattern == "burst":
+            num = min(args.burst, args.count - seq)
+        else:
+            num = 1
+
+        for _ in range(num):
+            if args.pattern == "random":
+                size = rng.randint(MSG_HEAD_LEN, args.size)
+            else:
+                size = args.size
+            msg = make_msg(seq, size)
+            send_time[seq] = time.perf_counter()
+            port.write(msg)
+            sent_bytes += len(msg)
+            seq += 1
+
+        if args.interval > 0:
+            time.sleep(args.interval / 1000.0 * num)
+
+    # 等待剩余回显
+    deadline = time.perf_counter() + args.timeout
+    while len(reader.arrive) < args.count and time.perf_counter() < deadline:
+        time.sleep(0.01)
+    end = max(reader.arrive.values()) if reader.arrive else time.perf_counter()
+
+    # 查询单片机堆使用情况
+    heap_free = heap_min = None
+    if args.query_heap:
+        time.sleep(0.1)
+        port.write(b"#BENCH")
+        time.sleep(0.3)
+        m = BENCH_PATTERN.search(bytes(reader.raw))
+        if m:
+            heap_free, heap_min = int(m.group(1)), int(m.group(2))
+
+    reader.running = False
+    reader.join()
+    port.close()
+
+    latency = [(reader.arrive[s] - send_time[s]) * 1e6 for s in reader.arrive if s in send_time]
+    elapsed = max(end - beg, 1e-9)
+    return {
+        "pattern": args.pattern,
+        "size": args.size,
+        "sent": args.count,
+        "received": len(latency),
+        "dropped": args.count - len(latency),
+        "sent_bytes": sent_bytes,
+        "elapsed_s": round(elapsed, 6),
+        "msg_per_s": round(len(latency) / elapsed, 1),
+        "byte_per_s": round(sent_bytes * len(latency) / max(args.count, 1) / elapsed, 1),
+        "lat_p50_us": round(percentile(latency, 50), 1),
+        "lat_p99_us": round(percentile(latency, 99), 1),
+        "lat_max_us": round(max(latency), 1) if latency else 0.0,
+        "heap_free": heap_free,
+        "heap_min": heap_min,
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description="回显项目吞吐量与延迟测试")
+    parser.add_argument("port", help="串口名, 如 COM3 或 /dev/ttyACM0")
+    parser.add_argument("--baud", type=int, default=115200, help="波特率 (USB VPC 可任意)")
+    parser.add_argument("--pattern", choices=["fixed", "random", "burst"], default="fixed", help="流量模式")
+    parser.add_argument("--size", type=int, default=32, help="消息长度 (random 模式下为最大长度)")
+    parser.add_argument("--count", type=int, default=1000, help="消息总数")
+    parser.add_argument("--burst", type=int, default=8, help="burst 模式下每组连续发送的消息数")
+    parser.add_argument("--interval", type=float, default=2.0, help="每条消息的平均发送间隔 (ms), 0 表示尽快发送")
+    parser.add_argument("--timeout", type=float, default=2.0, help="发送结束后等待回显的时间 (s)")
+    parser.add_argument("--seed", type=int, default=0, help="random 模式的随机种子")
+    parser.add_argument("--no-heap", dest="query_heap", action="store_false", help="不查询单片机堆使用情况")
+    parser.add_argument("--format", choices=["csv", "json"], default="csv", help="输出格式")
+    parser.add_argument("--out", help="输出文件, 默认输出到标准输出; csv 格式将追加到已有文件")
+    args = parser.parse_args()
+
+    if args.size < MSG_HEAD_LEN:
+        parser.error("--size 不能小于 %d" % MSG_HEAD_LEN)
+
+    res = run(args)
+
+    if args.format == "json":
+        text = json.dumps(res, indent=2)
+        if args.out:
+            with open(args.out, "w") as f:
+                f.write(text + "\n")
+        else:
+            print(text)
+    else:
+        out = open(args.out, "a", newline="") if args.out else sys.stdout
+        writer = csv.DictWriter(out, fieldnames=list(res.keys()))
+        if not args.out or out.tell() == 0:
+            writer.writeheader()
+        writer.writerow(res)
+        if args.out:
+            out.close()
+
+
+if __name__ == "__main__":
+    main()
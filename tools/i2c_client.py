@@ -0,0 +1,142 @@
+"""
+I2C 主机控制台二进制协议 (需在 user_main.c 中启用 I2C_CMD_USE_BINARY) 的上位机客户端与吞吐量测试
+
+请求与回复均使用 bin_frame 数据帧, 通过编号匹配回复, 同一时间可有多个请求等待回复
+
+依赖 pyserial: pip install pyserial
+
+示例:
+    python i2c_client.py COM3 touch 0x78
+    python i2c_client.py COM3 rec 0xD0 0x75 1
+    python i2c_client.py COM3 send 0x78 0x00 8D14AFA5
+    python i2c_client.py COM3 bench --op ping --count 5000 --window 8
+"""
+
+import argparse
+import struct
+import sys
+import time
+
+import serial
+
+from bin_frame import encode, FrameDecoder
+
+OP_PING, OP_SEND, OP_REC, OP_TOUCH = 0, 1, 2, 3
+STATUS_TEXT = {0: "OK", 1: "FAIL", 2: "BAD_REQUEST"}
+
+
+class I2CClient:
+    def __init__(self, port, baud=115200):
+        self.port = serial.Serial(port, baud, timeout=0.01)
+        self.decoder = FrameDecoder()
+        self.next_id = 0
+        self.replies = {}
+
+    def close(self):
+        self.port.close()
+
+    def submit(self, op, daddr=0, raddr=0, args=b""):
+        """发送请求, 返回请求编号, 不等待回复"""
+        req_id = self.next_id
+        self.next_id = (self.next_id + 1) & 0xFFFF
+        self.port.write(encode(struct.pack("<HBBB", req_id, op, daddr, raddr) + args))
+        return req_id
+
+    def poll(self):
+        """读取已到达的回复, 保存到 replies (编号 -> (状态, 数据))"""
+        data = self.port.read(self.port.in_waiting or 1)
+        for frame in self.decoder.feed(data):
+            if len(frame) < 4:
+                continue
+            req_id, _op, status = struct.unpack("<HBB", frame[:4])
+            self.replies[req_id] = (status, frame[4:])
+
+    def wait(self, req_id, timeout=1.0):
+        deadline = time.perf_counter() + timeout
+        while req_id not in self.replies and time.perf_counter() < deadline:
+            self.poll()
+        return self.replies.pop(req_id, None)
+
+    def call(self, op, daddr=0, raddr=0, args=b"", timeout=1.0):
+        return self.wait(self.submit(op, daddr, raddr, args), timeout)
+
+
+def bench(client, args):
+    op = {"ping": OP_PING, "touch": OP_TOUCH, "rec": OP_REC}[args.op]
+    req_args = bytes([args.len]) if op == OP_REC else b""
+    raddr = args.raddr if op != OP_TOUCH else 1
+
+    pending = {}
+    latency = []
+    sent = 0
+    beg = time.perf_counter()
+    deadline = beg + args.timeout + args.count * 0.05
+    while (sent < args.count or pending) and time.perf_counter() < deadline:
+        # 保持最多 window 个请求等待回复
+        while sent < args.count and len(pending) < args.window:
+            pending[client.submit(op, args.daddr, raddr, req_args)] = time.perf_counter()
+            sent += 1
+        client.poll()
+        now = time.perf_counter()
+        for req_id in [i for i in pending if i in client.replies]:
+            latency.append(now - pending.pop(req_id))
+            client.replies.pop(req_id)
+    elapsed = time.perf_counter() - beg
+
+    latency.sort()
+    print("ops: %d/%d  elapsed: %.3f s  ops/s: %.1f  lat p50: %.2f ms  max: %.2f ms  crc error: %d" % (
+        len(latency), args.count, elapsed, len(latency) / elapsed,
+        latency[len(latency) // 2] * 1e3 if latency else 0, latency[-1] * 1e3 if latency else 0,
+        client.decoder.crc_error))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="I2C 主机控制台二进制协议客户端")
+    parser.add_argument("port", help="串口名, 如 COM3 或 /dev/ttyACM0")
+    parser.add_argument("--baud", type=int, default=115200)
+    sub = parser.add_subparsers(dest="cmd", required=True)
+
+    p = sub.add_parser("touch", help="测试设备")
+    p.add_argument("daddr", type=lambda x: int(x, 0))
+    p.add_argument("--trial", type=int, default=1)
+    p = sub.add_parser("rec", help="读取寄存器")
+    p.add_argument("daddr", type=lambda x: int(x, 0))
+    p.add_argument("raddr", type=lambda x: int(x, 0))
+    p.add_argument("len", type=int)
+    p = sub.add_parser("send", help="写入寄存器")
+    p.add_argument("daddr", type=lambda x: int(x, 0))
+    p.add_argument("raddr", type=lambda x: int(x, 0))
+    p.add_argument("data", help="十六进制数据")
+    p = sub.add_parser("bench", help="流水线吞吐量测试")
+    p.add_argument("--op", choices=["ping", "touch", "rec"], default="ping")
+    p.add_argument("--daddr", type=lambda x: int(x, 0), default=0xD0)
+    p.add_argument("--raddr", type=lambda x: int(x, 0), default=0x75)
+    p.add_argument("--len", type=int, default=1)
+    p.add_argument("--count", type=int, default=1000)
+    p.add_argument("--window", type=int, default=8, help="同时等待回复的最多请求数, 1 即逐条请求")
+    p.add_argument("--timeout", type=float, default=2.0)
+    args = parser.parse_args()
+
+    client = I2CClient(args.port, args.baud)
+    try:
+        if args.cmd == "bench":
+            bench(client, args)
+            return
+        if args.cmd == "touch":
+            res = client.call(OP_TOUCH, args.daddr, args.trial)
+        elif args.cmd == "rec":
+            res = client.call(OP_REC, args.daddr, args.raddr, bytes([args.len]))
+        else:
+            res = client.call(OP_SEND, args.daddr, args.raddr, bytes.fromhex(args.data))
+
+        if res is None:
+            print("timeout")
+            sys.exit(1)
+        status, data = res
+        print(STATUS_TEXT.get(status, status), data.hex().upper())
+    finally:
+        client.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,120 @@
+#include "buf_ring.h"
+#include "cmsis_os.h"
+
+void BufRing_Init(BufRing* obj, ConstBuf** item, uint32_t size)
+{
+    obj->_item = item;
+    obj->_size = size;
+    obj->_head = 0;
+    obj->_tail = 0;
+    obj->_dropNum = 0;
+    obj->_ready._task = NULL;
+}
+
+/**
+ * @brief 尝试将 _tail 从 tail 推进一位, 即占有序号为 tail 的数据块
+ * 
+ * @param obj 环形队列对象
+ * @param tail 读取到的 _tail
+ * @return uint8_t 成功时返回 1, 期间 _tail 已被另一方推进时返回 0
+ */
+static inline uint8_t BufRing_Advance(BufRing* obj, uint32_t tail)
+{
+    return __atomic_compare_exchange_n(&obj->_tail, &tail, tail + 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+}
+
+ConstBuf* BufRing_Push(BufRing* obj, ConstBuf* data)
+{
+    ConstBuf* drop = NULL;
+    uint32_t head = obj->_head;
+    uint32_t mask = obj->_size - 1;
+
+    // 队列满时丢弃最早的数据块, 与消费者竞争失败说明该数据块已被取出, 队列不再满
+    uint32_t tail = __atomic_load_n(&obj->_tail, __ATOMIC_ACQUIRE);
+    while(head - tail == obj->_size)
+    {
+        ConstBuf* oldest = obj->_item[tail & mask];
+        if(BufRing_Advance(obj, tail))
+        {
+            drop = oldest;
+            obj->_dropNum++;
+            break;
+        }
+        tail = __atomic_load_n(&obj->_tail, __ATOMIC_ACQUIRE);
+    }
+
+    // 写入数据块后再发布 _head, 消费者看到新的 _head 时数据块已写入
+    obj->_item[head & mask] = data;
+    __atomic_store_n(&obj->_head, head + 1, __ATOMIC_RELEASE);
+
+    TaskSignal_Give(&obj->_ready, 0);
+    return drop;
+}
+
+/**
+ * @brief 不等待地取出最早插入的数据块
+ * 
+ * @param obj 环形队列对象
+ * @return ConstBuf* 取出的数据块, 队列为空时返回 NULL
+ */
+static ConstBuf* BufRing_TryPop(BufRing* obj)
+{
+    uint32_t mask = obj->_size - 1;
+
+    while(1)
+    {
+        uint32_t tail = __atomic_load_n(&obj->_tail, __ATOMIC_ACQUIRE);
+        if(__atomic_load_n(&obj->_head, __ATOMIC_ACQUIRE) == tail)
+        {
+            return NULL;
+        }
+
+        // 先读出数据块再占有, 占有失败说明该数据块已被生产者丢弃
+        ConstBuf* res = obj->_item[tail & mask];
+        if(BufRing_Advance(obj, tail))
+        {
+            return res;
+        }
+    }
+}
+
+ConstBuf* BufRing_Pop(BufRing* obj, uint32_t timeout)
+{
+    ConstBuf* res = BufRing_TryPop(obj);
+    if(res != NULL || timeout == 0)
+    {
+        return res;
+    }
+
+    // 先绑定再检查队列, 绑定之后插入的数据块一定会发出信号, 因此不会错过唤醒
+    if(obj->_ready._task != xTaskGetCurrentTaskHandle())
+    {
+        TaskSignal_Bind(&obj->_ready);
+    }
+
+    uint32_t beg = osKernelGetTickCount();
+    while((res = BufRing_TryPop(obj)) == NULL)
+    {
+        uint32_t wait = osWaitForever;
+        if(timeout != osWaitForever)
+        {
+            uint32_t passed = osKernelGetTickCount() - beg;
+            if(passed >= timeout)
+            {
+                break;
+            }
+            wait = timeout - passed;
+        }
+
+        // 信号可能来自已被取出的数据块, 唤醒后需重新检查
+        TaskSignal_Wait(&obj->_ready, wait, NULL);
+    }
+    return res;
+}
+
+uint32_t BufRing_GetCount(const BufRing* obj)
+{
+    // 先读取 _tail, 保证结果不会因期间插入数据块而下溢
+    uint32_t tail = obj->_tail;
+    return obj->_head - tail;
+}
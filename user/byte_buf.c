@@ -1,26 +1,409 @@
 #include "byte_buf.h"
 #include "cmsis_os.h"
+#include "hex_codec.h"
 
 #include "string.h"
-#include "stdio.h"
 #include "stdarg.h"
 
+#if (BYTE_BUF_USE_STAT == 1)
+#include "stm32f1xx_hal.h"
+#endif
+
 const size_t constBufSign = 0xFFFFFFFF;
 
-ByteBuf* ByteBuf_Create(size_t size)
+//********** 缓冲区内存管理 **********//
+
+// 是否使用固定块内存池分配缓冲区对象, 为 0 时直接使用 FreeRTOS 堆
+#define BYTE_BUF_USE_POOL 1
+
+// 对象头大小, 对象头与数据区位于同一内存块中, 数据区紧跟对象头 (按 8 字节对齐)
+#define BUF_HEAD_SIZE (((sizeof(ConstBuf) > sizeof(ByteBuf) ? sizeof(ConstBuf) : sizeof(ByteBuf)) + 7u) & ~7u)
+
+#if (BYTE_BUF_USE_POOL == 1)
+
+// 各级内存池的数据区容量 (字节) 与块数量, 需按容量从小到大排列
+#define BUF_POOL_SMALL_SIZE 16u
+#define BUF_POOL_SMALL_NUM 16u
+#define BUF_POOL_MEDIUM_SIZE 64u
+#define BUF_POOL_MEDIUM_NUM 8u
+#define BUF_POOL_LARGE_SIZE 256u
+#define BUF_POOL_LARGE_NUM 4u
+
+#define BUF_POOL_CLASS_NUM 3u
+
+/**
+ * @brief 固定块内存池
+ * @note 空闲块通过块首部的指针组成单链表, 从未分配过的块通过 _bumpNum 按顺序取出, 因此无需初始化
+ */
+typedef struct BUFPOOLCLASS
+{
+    // 内存区域首地址
+    uint8_t* _mem;
+    // 单个块的大小 (包含对象头)
+    size_t _blockSize;
+    // 块总数
+    size_t _blockNum;
+    // 已从内存区域中顺序取出的块数
+    size_t _bumpNum;
+    // 空闲块链表
+    void* _freeList;
+} BufPoolClass;
+
+static uint64_t bufPoolSmallMem[(BUF_HEAD_SIZE + BUF_POOL_SMALL_SIZE) * BUF_POOL_SMALL_NUM / sizeof(uint64_t)];
+static uint64_t bufPoolMediumMem[(BUF_HEAD_SIZE + BUF_POOL_MEDIUM_SIZE) * BUF_POOL_MEDIUM_NUM / sizeof(uint64_t)];
+static uint64_t bufPoolLargeMem[(BUF_HEAD_SIZE + BUF_POOL_LARGE_SIZE) * BUF_POOL_LARGE_NUM / sizeof(uint64_t)];
+
+static BufPoolClass bufPool[BUF_POOL_CLASS_NUM] = {
+    {(uint8_t*)bufPoolSmallMem, BUF_HEAD_SIZE + BUF_POOL_SMALL_SIZE, BUF_POOL_SMALL_NUM, 0, NULL},
+    {(uint8_t*)bufPoolMediumMem, BUF_HEAD_SIZE + BUF_POOL_MEDIUM_SIZE, BUF_POOL_MEDIUM_NUM, 0, NULL},
+    {(uint8_t*)bufPoolLargeMem, BUF_HEAD_SIZE + BUF_POOL_LARGE_SIZE, BUF_POOL_LARGE_NUM, 0, NULL},
+};
+
+#endif
+
+//********** 缓冲区统计 **********//
+
+#if (BYTE_BUF_USE_STAT == 1)
+
+BufStat bufStat;
+BufStatSite bufStatSite[BUF_STAT_SITE_NUM];
+
+/**
+ * @brief 记录一次分配的耗时与结果
+ * 
+ * @param cycle 分配耗时 (周期数)
+ * @param is_success 是否分配成功
+ */
+static void BufStat_Alloc(uint32_t cycle, uint8_t is_success)
+{
+    uint32_t idx = 0;
+    while(idx < BUF_STAT_HIST_NUM - 1 && cycle >= (32u << idx))
+    {
+        idx++;
+    }
+
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    bufStat._allocHist[idx]++;
+    if(!is_success)
+    {
+        bufStat._allocFail++;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+}
+
+/**
+ * @brief 查找创建位置对应的统计项, 没有记录时新建, 已满时返回最后一项
+ * 
+ * @param file 创建位置所在的源文件
+ * @param line 创建位置所在的行号
+ * @return BufStatSite* 统计项
+ * @note 需在临界区内调用, 同一源文件的 __FILE__ 通常为同一字符串常量, 先比较指针
+ */
+static BufStatSite* BufStat_FindSite(const char* file, uint32_t line)
+{
+    for(uint32_t i = 0; i < BUF_STAT_SITE_NUM - 1; i++)
+    {
+        BufStatSite* site = &bufStatSite[i];
+        if(site->_file == NULL)
+        {
+            site->_file = file;
+            site->_line = line;
+            return site;
+        }
+        if(site->_line == line && (site->_file == file || strcmp(site->_file, file) == 0))
+        {
+            return site;
+        }
+    }
+    return &bufStatSite[BUF_STAT_SITE_NUM - 1];
+}
+
+/**
+ * @brief 记录一个对象的创建
+ * 
+ * @param obj 新创建的对象, 为 NULL 时不记录
+ * @param tag 对象的统计标签, 其中 _size 已由分配函数设置
+ * @param is_const 是否为常量数据块
+ * @param file 创建位置所在的源文件
+ * @param line 创建位置所在的行号
+ * @return void* 即 obj
+ */
+static void* BufStat_Create(void* obj, BufStatTag* tag, uint8_t is_const, const char* file, uint32_t line)
+{
+    if(obj == NULL)
+    {
+        return NULL;
+    }
+
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    BufStatSite* siteStat = BufStat_FindSite(file, line);
+    tag->_site = siteStat;
+    siteStat->_liveNum++;
+    siteStat->_liveBytes += tag->_size;
+    if(siteStat->_liveBytes > siteStat->_peakBytes)
+    {
+        siteStat->_peakBytes = siteStat->_liveBytes;
+    }
+
+    if(is_const)
+    {
+        bufStat._liveConstBuf++;
+    }
+    else
+    {
+        bufStat._liveByteBuf++;
+    }
+    if(bufStat._liveConstBuf + bufStat._liveByteBuf > bufStat._peakNum)
+    {
+        bufStat._peakNum = bufStat._liveConstBuf + bufStat._liveByteBuf;
+    }
+    bufStat._liveBytes += tag->_size;
+    if(bufStat._liveBytes > bufStat._peakBytes)
+    {
+        bufStat._peakBytes = bufStat._liveBytes;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+
+    return obj;
+}
+
+/**
+ * @brief 记录一个对象的销毁
+ * 
+ * @param tag 对象的统计标签
+ * @param is_const 是否为常量数据块
+ */
+static void BufStat_Delete(const BufStatTag* tag, uint8_t is_const)
+{
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    BufStatSite* siteStat = tag->_site;
+    siteStat->_liveNum--;
+    siteStat->_liveBytes -= tag->_size;
+
+    if(is_const)
+    {
+        bufStat._liveConstBuf--;
+    }
+    else
+    {
+        bufStat._liveByteBuf--;
+    }
+    bufStat._liveBytes -= tag->_size;
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+}
+
+void BufStat_Get(BufStat* stat)
+{
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    *stat = bufStat;
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+}
+
+uint8_t BufStat_GetSite(uint32_t idx, BufStatSite* site)
+{
+    if(idx >= BUF_STAT_SITE_NUM)
+    {
+        return 0;
+    }
+
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    *site = bufStatSite[idx];
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+
+    return site->_file != NULL || site->_liveNum > 0 || site->_peakBytes > 0;
+}
+
+// 在公开的创建函数返回时记录对象的创建, 创建位置为调用处通过 BUF_SITE_PARAM 传入的源文件与行号
+#define BUF_STAT_BYTE(obj) ((ByteBuf*)BufStat_Create((obj), &(obj)->_stat, 0, site_file, site_line))
+#define BUF_STAT_CONST(obj) ((ConstBuf*)BufStat_Create((obj), &(obj)->_stat, 1, site_file, site_line))
+
+#else
+
+#define BUF_STAT_BYTE(obj) (obj)
+#define BUF_STAT_CONST(obj) (obj)
+
+#endif
+
+/**
+ * @brief 分配一个内存块
+ * 
+ * @param size 内存块大小 (包含对象头)
+ * @return void* 内存块首地址, 分配失败时返回 NULL
+ * @note 优先从能容纳该大小的最小一级内存池中分配, 内存池耗尽时回退到 FreeRTOS 堆
+ * @note 可在中断中调用, 但中断中不会回退到堆, 内存池耗尽时将返回 NULL
+ */
+static void* BufMem_AllocBlock(size_t size)
 {
-    ByteBuf* res = pvPortMalloc(sizeof(ByteBuf));
-    res->_buf = pvPortMalloc(size);
+#if (BYTE_BUF_USE_POOL == 1)
+    for(size_t i = 0; i < BUF_POOL_CLASS_NUM; i++)
+    {
+        BufPoolClass* pool = &bufPool[i];
+        if(pool->_blockSize < size)
+        {
+            continue;
+        }
+
+        void* res = NULL;
+        UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+        if(pool->_freeList != NULL)
+        {
+            res = pool->_freeList;
+            pool->_freeList = *(void**)res;
+        }
+        else if(pool->_bumpNum < pool->_blockNum)
+        {
+            res = pool->_mem + pool->_bumpNum * pool->_blockSize;
+            pool->_bumpNum++;
+        }
+        taskEXIT_CRITICAL_FROM_ISR(mask);
+
+        if(res != NULL)
+        {
+            return res;
+        }
+    }
+
+    if(xPortIsInsideInterrupt())
+    {
+        return NULL;
+    }
+#endif
+
+    return pvPortMalloc(size);
+}
+
+/**
+ * @brief 分配一个内存块, 启用统计时记录分配耗时
+ * 
+ * @param size 内存块大小 (包含对象头)
+ * @return void* 内存块首地址, 分配失败时返回 NULL
+ */
+static void* BufMem_Alloc(size_t size)
+{
+#if (BYTE_BUF_USE_STAT == 1)
+    // 启用 DWT 周期计数器
+    if(!(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk))
+    {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+
+    uint32_t beg = DWT->CYCCNT;
+    void* res = BufMem_AllocBlock(size);
+    BufStat_Alloc(DWT->CYCCNT - beg, res != NULL);
+
+    return res;
+#else
+    return BufMem_AllocBlock(size);
+#endif
+}
+
+/**
+ * @brief 释放由 BufMem_Alloc 分配的内存块
+ * 
+ * @param mem 内存块首地址
+ * @note 根据地址范围判断内存块所属的内存池, 不属于任何内存池时交还 FreeRTOS 堆
+ */
+static void BufMem_Free(void* mem)
+{
+#if (BYTE_BUF_USE_POOL == 1)
+    for(size_t i = 0; i < BUF_POOL_CLASS_NUM; i++)
+    {
+        BufPoolClass* pool = &bufPool[i];
+        if((uint8_t*)mem >= pool->_mem && (uint8_t*)mem < pool->_mem + pool->_blockSize * pool->_blockNum)
+        {
+            UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+            *(void**)mem = pool->_freeList;
+            pool->_freeList = mem;
+            taskEXIT_CRITICAL_FROM_ISR(mask);
+            return;
+        }
+    }
+#endif
+
+    vPortFree(mem);
+}
+
+/**
+ * @brief 创建一个数据区与对象头位于同一内存块中的只读数据对象
+ * 
+ * @param len 数据区长度
+ * @return ConstBuf* 只读数据对象句柄, 数据区内容未初始化, 分配失败时返回 NULL
+ */
+static ConstBuf* ConstBuf_Alloc(size_t len)
+{
+    ConstBuf* res = BufMem_Alloc(BUF_HEAD_SIZE + len);
+    if(res == NULL)
+    {
+        return NULL;
+    }
+
+    res->_buf = (uint8_t*)res + BUF_HEAD_SIZE;
+    res->_len = len;
+    res->_sid = NULL;
+    res->_release = NULL;
+    res->_ref = 1;
+    res->_parent = NULL;
+#if (BYTE_BUF_USE_STAT == 1)
+    res->_stat._size = BUF_HEAD_SIZE + len;
+#endif
+
+    return res;
+}
+
+/**
+ * @brief 创建一个不持有数据区的只读数据对象
+ * 
+ * @param buf 常量数据指针
+ * @param len 常量数据长度
+ * @return ConstBuf* 只读数据对象句柄, 分配失败时返回 NULL
+ */
+static ConstBuf* ConstBuf_AllocConst(const uint8_t* buf, size_t len)
+{
+    ConstBuf* res = BufMem_Alloc(sizeof(ConstBuf));
+    if(res == NULL)
+    {
+        return NULL;
+    }
+
+    res->_buf = (uint8_t*)buf;
+    res->_len = len;
+    res->_sid = NULL;
+    res->_release = NULL;
+    res->_ref = 1;
+    res->_parent = NULL;
+#if (BYTE_BUF_USE_STAT == 1)
+    res->_stat._size = sizeof(ConstBuf);
+#endif
+
+    return res;
+}
+
+//////////////////
+
+ByteBuf* (ByteBuf_Create)(size_t size BUF_SITE_PARAM)
+{
+    ByteBuf* res = BufMem_Alloc(BUF_HEAD_SIZE + size);
+    if(res == NULL)
+    {
+        return NULL;
+    }
+    res->_buf = (uint8_t*)res + BUF_HEAD_SIZE;
     res->_len = 0;
     res->_size = size;
+#if (BYTE_BUF_USE_STAT == 1)
+    res->_stat._size = BUF_HEAD_SIZE + size;
+#endif
 
-    return res;
+    return BUF_STAT_BYTE(res);
 }
 
 void ByteBuf_Delete(ByteBuf* obj)
 {
-    vPortFree(obj->_buf);
-    vPortFree(obj);
+#if (BYTE_BUF_USE_STAT == 1)
+    BufStat_Delete(&obj->_stat, 0);
+#endif
+    BufMem_Free(obj);
 }
 
 uint8_t ByteBuf_Push(ByteBuf* obj, uint8_t byte)
@@ -42,58 +425,331 @@ void ByteBuf_Flush(ByteBuf* obj)
     obj->_len = 0;
 }
 
+/**
+ * @brief 向缓冲区末尾写入一个整数
+ * 
+ * @param value 整数的绝对值
+ * @param is_neg 是否添加负号
+ * @param base 进制, 10 或 16
+ * @param upper 16 进制时是否使用大写字母
+ * @param width 最小宽度, 不足时在左侧填充
+ * @param pad 填充字符, '0' 或 ' '
+ * @return uint8_t 空间不足时返回 0
+ */
+static uint8_t ByteBuf_FormatInt(ByteBuf* obj, uint32_t value, uint8_t is_neg, uint32_t base, uint8_t upper, uint32_t width, uint8_t pad)
+{
+    // 32 位整数最多 10 位数字
+    uint8_t digit[10];
+    uint32_t num = 0;
+    const char* table = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+
+    do
+    {
+        digit[num++] = table[value % base];
+        value /= base;
+    } while(value != 0);
+
+    uint32_t total = num + (is_neg ? 1 : 0);
+    if(is_neg && pad == '0' && !ByteBuf_Push(obj, '-'))
+    {
+        return 0;
+    }
+    for(; total < width; total++)
+    {
+        if(!ByteBuf_Push(obj, pad))
+        {
+            return 0;
+        }
+    }
+    if(is_neg && pad != '0' && !ByteBuf_Push(obj, '-'))
+    {
+        return 0;
+    }
+    while(num > 0)
+    {
+        if(!ByteBuf_Push(obj, digit[--num]))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief 向缓冲区末尾复制字符串, 直到 \0 或指定的结束字符 (不复制)
+ * 
+ * @return const char* 停止处的字符指针, 空间不足时返回 NULL
+ */
+static const char* ByteBuf_FormatStr(ByteBuf* obj, const char* str, char stop)
+{
+    uint8_t* dst = obj->_buf + obj->_len;
+    uint8_t* end = obj->_buf + obj->_size;
+    while(*str != '\0' && *str != stop)
+    {
+        if(dst >= end)
+        {
+            obj->_len = obj->_size;
+            return NULL;
+        }
+        *dst++ = *str++;
+    }
+    obj->_len = dst - obj->_buf;
+    return str;
+}
+
+/**
+ * @brief 格式化输出至缓冲区末尾 (从 _len 开始写入)
+ * @note 支持 %s %c %u %d %x %X %% 与 ConstBuf 的 16 进制输出 %H, 可带 0 填充标志与宽度 (如 %02X)
+ * @note 整数可带长度修饰符 l (long) 或 z (size_t), 按修饰符读取参数, 值超出 32 位时视为格式不支持; 不支持 ll 等其他修饰符
+ * @note %s 的参数为 NULL 时输出 (null)
+ * @note 不递归, 不分配内存, 栈上仅有固定大小的局部变量 (数字缓冲 10 字节)
+ * @return uint8_t 写入完整时返回 1; 空间不足时返回 0, 此时 _len 为实际写入的截断长度
+ */
+static uint8_t ByteBuf_Format(ByteBuf* obj, const char* format, va_list args)
+{
+    for(const char* p = format; *p != '\0'; p++)
+    {
+        if(*p != '%')
+        {
+            // 连续复制普通字符直到下一个格式说明
+            p = ByteBuf_FormatStr(obj, p, '%');
+            if(p == NULL)
+            {
+                return 0;
+            }
+            if(*p == '\0')
+            {
+                break;
+            }
+        }
+
+        p++;
+        uint8_t pad = ' ';
+        uint32_t width = 0;
+        if(*p == '0')
+        {
+            pad = '0';
+            p++;
+        }
+        while(*p >= '0' && *p <= '9')
+        {
+            width = width * 10 + (*p - '0');
+            p++;
+        }
+        // 长度修饰符, 决定整数参数的读取类型 (目标上 long 与 size_t 均为 32 位, 主机上可能为 64 位)
+        char length = 0;
+        if(*p == 'l' || *p == 'z')
+        {
+            length = *p++;
+        }
+
+        // 按长度修饰符读取整数参数, 有符号数以 64 位保存
+        uint64_t uvalue = 0;
+        int64_t svalue = 0;
+        if(*p == 'u' || *p == 'x' || *p == 'X')
+        {
+            if(length == 'l')
+            {
+                uvalue = va_arg(args, unsigned long);
+            }
+            else if(length == 'z')
+            {
+                uvalue = va_arg(args, size_t);
+            }
+            else
+            {
+                uvalue = va_arg(args, unsigned int);
+            }
+            if(uvalue > UINT32_MAX)
+            {
+                return 0;
+            }
+        }
+        else if(*p == 'd')
+        {
+            if(length == 'l')
+            {
+                svalue = va_arg(args, long);
+            }
+            else if(length == 'z')
+            {
+                // 与 printf 相同, %zd 读取与 size_t 同宽的有符号数
+                svalue = (int64_t)(intptr_t)va_arg(args, size_t);
+            }
+            else
+            {
+                svalue = va_arg(args, int);
+            }
+            if(svalue > INT32_MAX || svalue < INT32_MIN)
+            {
+                return 0;
+            }
+        }
+        else if(length != 0)
+        {
+            // 长度修饰符只能用于整数
+            return 0;
+        }
+
+        uint8_t res = 1;
+        switch(*p)
+        {
+        case 's':
+        {
+            const char* str = va_arg(args, const char*);
+            res = (ByteBuf_FormatStr(obj, (str != NULL) ? str : "(null)", '\0') != NULL);
+            break;
+        }
+        case 'c':
+            res = ByteBuf_Push(obj, (uint8_t)va_arg(args, int));
+            break;
+        case 'u':
+            res = ByteBuf_FormatInt(obj, (uint32_t)uvalue, 0, 10, 0, width, pad);
+            break;
+        case 'd':
+            res = ByteBuf_FormatInt(obj, (svalue < 0) ? (uint32_t)(-svalue) : (uint32_t)svalue, svalue < 0, 10, 0, width, pad);
+            break;
+        case 'x':
+        case 'X':
+            res = ByteBuf_FormatInt(obj, (uint32_t)uvalue, 0, 16, *p == 'X', width, pad);
+            break;
+        case 'H':
+        {
+            // 只写入能完整容纳的字节
+            const ConstBuf* data = va_arg(args, const ConstBuf*);
+            size_t num = (obj->_size - obj->_len) / 2;
+            if(num > data->_len)
+            {
+                num = data->_len;
+            }
+            obj->_len += HexCodec_Encode(obj->_buf + obj->_len, data->_buf, num);
+            res = (num == data->_len);
+            break;
+        }
+        case '%':
+            res = ByteBuf_Push(obj, '%');
+            break;
+        default:
+            // 不支持的格式或格式字符串提前结束
+            return 0;
+        }
+
+        if(!res)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
 uint8_t ByteBuf_Printf(ByteBuf* obj, uint8_t is_str, const char* format, ...)
 {
     va_list args;
     va_start(args, format);
 
-    int res = vsniprintf((char*)obj->_buf, obj->_size, format, args);
+    obj->_len = 0;
+    uint8_t res = ByteBuf_Format(obj, format, args);
     va_end(args);
 
-    if(res >= 0)
+    if(is_str)
     {
-        if(is_str)
+        // 截断时也保证以 \0 结尾
+        if(obj->_len >= obj->_size)
         {
-            obj->_len = res + 1;
-        }
-        else
-        {
-            obj->_len = res;
+            if(obj->_size == 0)
+            {
+                return 0;
+            }
+            obj->_len = obj->_size - 1;
+            res = 0;
         }
+        obj->_buf[obj->_len++] = '\0';
+    }
+    else if(obj->_len < obj->_size)
+    {
+        // 不计入长度的 \0, 便于将内容作为字符串使用
+        obj->_buf[obj->_len] = '\0';
+    }
 
-        return 1;
+    return res;
+}
+
+uint8_t ByteBuf_Append(ByteBuf* obj, const uint8_t* data, size_t len)
+{
+    uint8_t* dst = ByteBuf_Reserve(obj, len);
+    if(dst == NULL)
+    {
+        return 0;
     }
-    else
+
+    memcpy(dst, data, len);
+    obj->_len += len;
+    return 1;
+}
+
+uint8_t ByteBuf_AppendStr(ByteBuf* obj, const char* str)
+{
+    return ByteBuf_Append(obj, (const uint8_t*)str, strlen(str));
+}
+
+uint8_t ByteBuf_AppendPrintf(ByteBuf* obj, const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+
+    size_t len = obj->_len;
+    uint8_t res = ByteBuf_Format(obj, format, args);
+    va_end(args);
+
+    if(!res)
+    {
+        obj->_len = len;
+    }
+    return res;
+}
+
+uint8_t ByteBuf_AppendHex(ByteBuf* obj, const uint8_t* data, size_t len)
+{
+    uint8_t* dst = ByteBuf_Reserve(obj, len * 2);
+    if(dst == NULL)
     {
         return 0;
     }
+
+    obj->_len += HexCodec_Encode(dst, data, len);
+    return 1;
+}
+
+uint8_t* ByteBuf_Reserve(ByteBuf* obj, size_t len)
+{
+    if(len > obj->_size - obj->_len)
+    {
+        return NULL;
+    }
+    return obj->_buf + obj->_len;
+}
+
+void ByteBuf_Commit(ByteBuf* obj, size_t len)
+{
+    obj->_len += len;
 }
 
 //////////////////
 
-ConstBuf* ConstBuf_CreateByBuf(const ByteBuf* obj, uint8_t is_str)
+ConstBuf* (ConstBuf_CreateByBuf)(const ByteBuf* obj, uint8_t is_str BUF_SITE_PARAM)
 {
-    ConstBuf* res = pvPortMalloc(sizeof(ConstBuf));
-
     // 当缓冲区已经满足字符串要求时, 不再修改
     if(is_str && (obj->_buf[obj->_len - 1] == 0))
     {
         is_str = 0;
     }
 
-    if(is_str)
-    {
-        res->_len = obj->_len + 1;
-    }
-    else
+    ConstBuf* res = ConstBuf_Alloc(is_str ? obj->_len + 1 : obj->_len);
+    if(res == NULL)
     {
-        res->_len = obj->_len;
+        return NULL;
     }
 
-    res->_buf = pvPortMalloc(res->_len);
-    res->_is_real_const = 0;
-    res->_sid = NULL;
-
     for(size_t i = 0; i < obj->_len; i++)
     {
         res->_buf[i] = obj->_buf[i];
@@ -104,18 +760,16 @@ ConstBuf* ConstBuf_CreateByBuf(const ByteBuf* obj, uint8_t is_str)
         res->_buf[res->_len - 1] = 0;
     }
 
-    return res;
+    return BUF_STAT_CONST(res);
 }
 
-ConstBuf* ConstBuf_CreateExtBuf(const uint8_t* buf, size_t buf_len, size_t beg, size_t end, uint8_t is_str)
+ConstBuf* (ConstBuf_CreateExtBuf)(const uint8_t* buf, size_t buf_len, size_t beg, size_t end, uint8_t is_str BUF_SITE_PARAM)
 {
     if(beg >= buf_len)
     {
         return NULL;
     }
 
-    ConstBuf* res = pvPortMalloc(sizeof(ConstBuf));
-
     if(end <= beg || end > buf_len)
     {
         end = buf_len;
@@ -128,19 +782,12 @@ ConstBuf* ConstBuf_CreateExtBuf(const uint8_t* buf, size_t buf_len, size_t beg,
         is_str = 0;
     }
 
-    if(is_str)
+    ConstBuf* res = ConstBuf_Alloc(is_str ? len + 1 : len);
+    if(res == NULL)
     {
-        res->_len = len + 1;
-    }
-    else
-    {
-        res->_len = len;
+        return NULL;
     }
 
-    res->_buf = pvPortMalloc(len);
-    res->_is_real_const = 0;
-    res->_sid = NULL;
-
     for(size_t i = beg; i < end; i++)
     {
         res->_buf[i - beg] = buf[i];
@@ -151,56 +798,101 @@ ConstBuf* ConstBuf_CreateExtBuf(const uint8_t* buf, size_t buf_len, size_t beg,
         res->_buf[res->_len - 1] = 0;
     }
 
-    return res;
+    return BUF_STAT_CONST(res);
 }
 
-ConstBuf* ConstBuf_CreateByByte(uint8_t byte)
+ConstBuf* (ConstBuf_CreateByByte)(uint8_t byte BUF_SITE_PARAM)
 {
-    ConstBuf* res = pvPortMalloc(sizeof(ConstBuf));
-    res->_buf = pvPortMalloc(1);
-    res->_is_real_const = 0;
-    res->_len = 1;
-    res->_sid = NULL;
-
+    ConstBuf* res = ConstBuf_Alloc(1);
+    if(res == NULL)
+    {
+        return NULL;
+    }
     res->_buf[0] = byte;
 
-    return res;
+    return BUF_STAT_CONST(res);
 }
 
-ConstBuf* ConstBuf_CreateByConst(const uint8_t* buf, size_t len)
+ConstBuf* (ConstBuf_CreateByConst)(const uint8_t* buf, size_t len BUF_SITE_PARAM)
 {
-    ConstBuf* res = pvPortMalloc(sizeof(ConstBuf));
+    ConstBuf* res = ConstBuf_AllocConst(buf, len);
+    return BUF_STAT_CONST(res);
+}
 
-    res->_buf = (uint8_t*)buf;
-    res->_len = len;
-    res->_is_real_const = 1;
-    res->_sid = NULL;
+ConstBuf* (ConstBuf_CreateByStr)(const char* obj BUF_SITE_PARAM)
+{
+    ConstBuf* res = ConstBuf_AllocConst((const uint8_t*)obj, strlen(obj) + 1);
+    return BUF_STAT_CONST(res);
+}
 
-    return res;
+ConstBuf* (ConstBuf_CreateByBorrow)(uint8_t* buf, size_t len, ConstBufReleaseCallbackTypeDef release BUF_SITE_PARAM)
+{
+    ConstBuf* res = ConstBuf_AllocConst(buf, len);
+    if(res == NULL)
+    {
+        return NULL;
+    }
+    res->_release = release;
+
+    return BUF_STAT_CONST(res);
 }
 
-ConstBuf* ConstBuf_CreateByStr(const char* obj)
+ConstBuf* (ConstBuf_CreateEmpty)(size_t len BUF_SITE_PARAM)
 {
-    return ConstBuf_CreateByConst((const uint8_t*)obj, strlen(obj) + 1);
+    ConstBuf* res = ConstBuf_Alloc(len);
+    return BUF_STAT_CONST(res);
 }
 
-ConstBuf* ConstBuf_CreateEmpty(size_t len)
+ConstBuf* (ConstBuf_Slice)(ConstBuf* parent, size_t beg, size_t end BUF_SITE_PARAM)
 {
-    ConstBuf* res = pvPortMalloc(sizeof(ConstBuf));
+    if(beg >= parent->_len)
+    {
+        return NULL;
+    }
 
-    res->_buf = pvPortMalloc(len);
-    res->_len = len;
-    res->_is_real_const = 0;
-    res->_sid = NULL;
+    if(end <= beg || end > parent->_len)
+    {
+        end = parent->_len;
+    }
 
-    return res;
+    ConstBuf* res = ConstBuf_AllocConst(parent->_buf + beg, end - beg);
+    if(res == NULL)
+    {
+        return NULL;
+    }
+    res->_parent = ConstBuf_Ref(parent);
+
+    return BUF_STAT_CONST(res);
+}
+
+ConstBuf* ConstBuf_Ref(ConstBuf* obj)
+{
+    __atomic_add_fetch(&obj->_ref, 1, __ATOMIC_RELAXED);
+    return obj;
 }
 
 void ConstBuf_Delete(ConstBuf* obj)
 {
-    if(!obj->_is_real_const)
+    // 与 free 一致, 允许传入创建失败得到的 NULL
+    if(obj == NULL)
     {
-        vPortFree(obj->_buf);
+        return;
+    }
+
+    // 仍有其他引用时仅减少引用计数
+    if(__atomic_sub_fetch(&obj->_ref, 1, __ATOMIC_ACQ_REL) != 0)
+    {
+        return;
+    }
+
+    if(obj->_parent != NULL)
+    {
+        ConstBuf_Delete(obj->_parent);
+    }
+
+    if(obj->_release != NULL)
+    {
+        obj->_release(obj->_buf);
     }
 
     if(obj->_sid != NULL)
@@ -208,7 +900,12 @@ void ConstBuf_Delete(ConstBuf* obj)
         osSemaphoreRelease(obj->_sid);
     }
 
-    vPortFree(obj);
+#if (BYTE_BUF_USE_STAT == 1)
+    BufStat_Delete(&obj->_stat, 1);
+#endif
+
+    // 持有的数据区与对象头位于同一内存块中, 一同释放; 常量, 借用与切片对象只释放对象头
+    BufMem_Free(obj);
 }
 
 void ConstBuf_BindSemaphore(ConstBuf* obj, osSemaphoreId_t sid)
@@ -216,6 +913,17 @@ void ConstBuf_BindSemaphore(ConstBuf* obj, osSemaphoreId_t sid)
     obj->_sid = sid;
 }
 
+uint8_t ConstBuf_EqualStr(const ConstBuf* obj, const char* str)
+{
+    size_t len = obj->_len;
+    if(len > 0 && obj->_buf[len - 1] == 0)
+    {
+        len--;
+    }
+
+    return (strlen(str) == len) && (memcmp(obj->_buf, str, len) == 0);
+}
+
 ///////////////////////////
 
 uint8_t CommandResolveText(const ConstBuf* str, ConstBuf** body, ConstBuf** args)
@@ -229,84 +937,48 @@ uint8_t CommandResolveText(const ConstBuf* str, ConstBuf** body, ConstBuf** args
             return 0;
         }
     }
-    *body = ConstBuf_CreateExtBuf(str->_buf, str->_len, 0, r, 1);
+    uint32_t bodyEnd = r;
 
     while(str->_buf[r] == ' ')
     {
         r++;
         if(r >= str->_len)
         {
-            ConstBuf_Delete(*body);
             return 0;
         }
     }
 
-    ByteBuf* tmpBuf = ByteBuf_Create((str->_len - r) / 2);
-
-    uint32_t l = r;
-    uint8_t left_part = 0;
-    uint8_t right_part = 0;
-    while((str->_buf[r] >= 'A' && str->_buf[r] <= 'F') || (str->_buf[r] >= '0' && str->_buf[r] <= '9'))
+    // 确定 16 进制字符串的长度, 直接解码到参数数据块中
+    size_t hexLen = HexCodec_Span(str->_buf + r, str->_len - r);
+    *args = ConstBuf_CreateEmpty(hexLen / 2);
+    if(*args == NULL)
     {
-        if(str->_buf[r] >= 'A' && str->_buf[r] <= 'F')
-        {
-            right_part = str->_buf[r] - 'A' + 10;
-        }
-        else
-        {
-            right_part = str->_buf[r] - '0';
-        }
-
-        if((r - l) % 2 == 1)
-        {
-            ByteBuf_Push(tmpBuf, left_part + right_part);
-        }
-        else
-        {
-            left_part = right_part << 4;
-        }
-
-        r++;
-        if(r >= str->_len)
-        {
-            break;
-        }
+        return 0;
     }
+    HexCodec_Decode((*args)->_buf, str->_buf + r, (*args)->_len * 2, NULL);
 
-    *args = ConstBuf_CreateByBuf(tmpBuf, 0);
-    ByteBuf_Delete(tmpBuf);
+    // 命令体复制为字符串 (可以为空), 与 str 的生命周期无关
+    *body = ConstBuf_CreateEmpty(bodyEnd + 1);
+    if(*body == NULL)
+    {
+        ConstBuf_Delete(*args);
+        return 0;
+    }
+    memcpy((*body)->_buf, str->_buf, bodyEnd);
+    (*body)->_buf[bodyEnd] = 0;
 
     return 1;
 }
 
-ConstBuf* ConstBuf_BufToHex(const uint8_t* buf, size_t len)
+ConstBuf* (ConstBuf_BufToHex)(const uint8_t* buf, size_t len BUF_SITE_PARAM)
 {
-    ConstBuf* res = pvPortMalloc(sizeof(ConstBuf));
-
-    res->_buf = pvPortMalloc(len * 2 + 1);
-    res->_len = len * 2 + 1;
-    res->_is_real_const = 0;
-    res->_sid = NULL;
-
-    for(size_t i = 0; i < len * 2; i++)
+    ConstBuf* res = ConstBuf_Alloc(len * 2 + 1);
+    if(res == NULL)
     {
-        uint8_t tmp = buf[i / 2];
-        if(i % 2 == 0)
-        {
-            tmp = tmp >> 4; 
-        }
-        tmp = tmp & 0b00001111;
-
-        if(tmp >= 0xAu)
-        {
-            res->_buf[i] = tmp + 'A' - 0xAu;
-        }
-        else
-        {
-            res->_buf[i] = tmp + '0';
-        }
+        return NULL;
     }
 
+    HexCodec_Encode(res->_buf, buf, len);
     res->_buf[len * 2] = '\0';
-    return res;
+    return BUF_STAT_CONST(res);
 }
@@ -0,0 +1,125 @@
+#include "command.h"
+#include "hex_codec.h"
+
+#include "string.h"
+
+/**
+ * @brief 比较指令名与指令表项, 顺序与 strcmp 一致
+ * 
+ * @return int 指令名在表项之前时小于 0, 相同时为 0, 之后时大于 0
+ */
+static int Command_Compare(const uint8_t* name, size_t len, const char* entry)
+{
+    size_t i = 0;
+    for(; i < len && entry[i] != 0; i++)
+    {
+        if(name[i] != (uint8_t)entry[i])
+        {
+            return (int)name[i] - (uint8_t)entry[i];
+        }
+    }
+
+    if(i < len)
+    {
+        return 1;
+    }
+    return (entry[i] == 0) ? 0 : -1;
+}
+
+const CommandEntry* Command_Find(const CommandEntry* table, size_t num, const uint8_t* name, size_t len)
+{
+    size_t l = 0;
+    size_t r = num;
+    while(l < r)
+    {
+        size_t m = (l + r) / 2;
+        int res = Command_Compare(name, len, table[m]._name);
+        if(res == 0)
+        {
+            return &table[m];
+        }
+        else if(res < 0)
+        {
+            r = m;
+        }
+        else
+        {
+            l = m + 1;
+        }
+    }
+    return NULL;
+}
+
+CommandResult Command_Dispatch(const CommandEntry* table, size_t num, const ConstBuf* cmd, ByteBuf* printBuf, size_t* argLen, size_t* errPos)
+{
+    const uint8_t* buf = cmd->_buf;
+    size_t len = cmd->_len;
+    // 忽略末尾的 \0 与行尾 (\r\n 或 \n), 使其不被当作参数字符
+    while(len > 0 && (buf[len - 1] == 0 || buf[len - 1] == '\r' || buf[len - 1] == '\n'))
+    {
+        len--;
+    }
+
+    // 指令名直到第一个空格
+    const uint8_t* space = memchr(buf, ' ', len);
+    size_t nameLen = (space == NULL) ? len : (size_t)(space - buf);
+    if(nameLen == 0)
+    {
+        if(errPos != NULL)
+        {
+            *errPos = 0;
+        }
+        return COMMAND_BAD_FORMAT;
+    }
+
+    // 跳过空格后的部分均为参数
+    size_t l = nameLen;
+    while(l < len && buf[l] == ' ')
+    {
+        l++;
+    }
+    size_t hexLen = len - l;
+    if(argLen != NULL)
+    {
+        *argLen = hexLen / 2;
+    }
+
+    const CommandEntry* entry = Command_Find(table, num, buf, nameLen);
+    if(entry == NULL)
+    {
+        return COMMAND_UNKNOWN;
+    }
+    // 参数字符数为奇数时, 错误位置为第一个非 16 进制字符或缺少的最后一个字符
+    if(hexLen % 2 != 0)
+    {
+        if(errPos != NULL)
+        {
+            *errPos = l + HexCodec_Span(buf + l, hexLen);
+        }
+        return COMMAND_BAD_FORMAT;
+    }
+    if(hexLen / 2 < entry->_minArgs || hexLen / 2 > entry->_maxArgs)
+    {
+        return COMMAND_BAD_ARGS;
+    }
+
+    // 将参数直接解码到参数数据块中
+    ConstBuf* args = ConstBuf_CreateEmpty(hexLen / 2);
+    if(args == NULL)
+    {
+        return COMMAND_NO_MEMORY;
+    }
+    if(!HexCodec_Decode(args->_buf, buf + l, hexLen, errPos))
+    {
+        if(errPos != NULL)
+        {
+            *errPos += l;
+        }
+        ConstBuf_Delete(args);
+        return COMMAND_BAD_FORMAT;
+    }
+
+    entry->_handler(args, printBuf);
+    ConstBuf_Delete(args);
+    return COMMAND_OK;
+}
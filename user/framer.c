@@ -0,0 +1,232 @@
+#include "framer.h"
+
+#include "string.h"
+
+uint8_t Framer_Init(Framer* obj, FramerMode mode, size_t max_len)
+{
+    obj->_mode = mode;
+    obj->_buf = ByteBuf_Create(max_len);
+    obj->_dropNum = 0;
+    if(obj->_buf == NULL)
+    {
+        return 0;
+    }
+    Framer_Reset(obj);
+    return 1;
+}
+
+void Framer_Reset(Framer* obj)
+{
+    obj->_buf->_len = 0;
+    obj->_discard = 0;
+    obj->_headNum = 0;
+    obj->_need = 0;
+    obj->_left = 0;
+    obj->_zero = 0;
+}
+
+/**
+ * @brief 将数据追加到当前数据帧, 超过最大长度时转为丢弃当前数据帧
+ * 
+ * @param obj 分帧器对象
+ * @param data 追加的数据
+ * @param len 追加的数据长度
+ */
+static void Framer_Append(Framer* obj, const uint8_t* data, size_t len)
+{
+    if(obj->_discard)
+    {
+        return;
+    }
+    if(obj->_buf->_len + len > obj->_buf->_size)
+    {
+        obj->_discard = 1;
+        return;
+    }
+    memcpy(obj->_buf->_buf + obj->_buf->_len, data, len);
+    obj->_buf->_len += len;
+}
+
+/**
+ * @brief 结束当前数据帧
+ * 
+ * @param obj 分帧器对象
+ * @param is_str 是否在数据帧末尾添加 \0
+ * @return ConstBuf* 完整的数据帧, 当前数据帧被丢弃时返回 NULL
+ */
+static ConstBuf* Framer_End(Framer* obj, uint8_t is_str)
+{
+    ConstBuf* res = NULL;
+    if(obj->_discard)
+    {
+        obj->_dropNum++;
+    }
+    else
+    {
+        res = ConstBuf_CreateByBuf(obj->_buf, is_str);
+        // 内存不足时同样丢弃当前数据帧
+        if(res == NULL)
+        {
+            obj->_dropNum++;
+        }
+    }
+    obj->_buf->_len = 0;
+    obj->_discard = 0;
+    return res;
+}
+
+/**
+ * @brief FRAMER_LINE 下的分帧, 使用 memchr 查找行尾, 并整段复制
+ */
+static ConstBuf* Framer_PushLine(Framer* obj, const uint8_t** data, size_t* len)
+{
+    while(*len > 0)
+    {
+        const uint8_t* end = memchr(*data, '\n', *len);
+        size_t num = (end == NULL) ? *len : (size_t)(end - *data);
+
+        Framer_Append(obj, *data, num);
+        if(end == NULL)
+        {
+            *data += num;
+            *len = 0;
+            return NULL;
+        }
+        *data += num + 1;
+        *len -= num + 1;
+
+        // 去除行尾的 \r, 并忽略空行
+        ByteBuf* buf = obj->_buf;
+        if(!obj->_discard && buf->_len > 0 && buf->_buf[buf->_len - 1] == '\r')
+        {
+            buf->_len--;
+        }
+        if(!obj->_discard && buf->_len == 0)
+        {
+            continue;
+        }
+
+        ConstBuf* res = Framer_End(obj, 1);
+        if(res != NULL)
+        {
+            return res;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief FRAMER_LENGTH 下的分帧, 数据部分整段复制
+ */
+static ConstBuf* Framer_PushLength(Framer* obj, const uint8_t** data, size_t* len)
+{
+    while(*len > 0)
+    {
+        // 接收长度
+        if(obj->_headNum < 2)
+        {
+            obj->_need = (obj->_need << 8) | **data;
+            (*data)++;
+            (*len)--;
+            obj->_headNum++;
+
+            if(obj->_headNum < 2)
+            {
+                continue;
+            }
+            if(obj->_need > obj->_buf->_size)
+            {
+                obj->_discard = 1;
+            }
+        }
+        else
+        {
+            // 接收数据
+            size_t num = (*len < obj->_need) ? *len : obj->_need;
+            Framer_Append(obj, *data, num);
+            *data += num;
+            *len -= num;
+            obj->_need -= num;
+        }
+
+        if(obj->_need == 0)
+        {
+            obj->_headNum = 0;
+            ConstBuf* res = Framer_End(obj, 0);
+            if(res != NULL)
+            {
+                return res;
+            }
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief FRAMER_COBS 下的分帧, 同时进行 COBS 解码
+ */
+static ConstBuf* Framer_PushCobs(Framer* obj, const uint8_t** data, size_t* len)
+{
+    static const uint8_t zero = 0;
+
+    while(*len > 0)
+    {
+        uint8_t byte = **data;
+        (*data)++;
+        (*len)--;
+
+        if(byte == 0)
+        {
+            // 编码块未结束时遇到帧结尾, 说明数据帧不完整
+            if(obj->_left > 0)
+            {
+                obj->_discard = 1;
+            }
+            uint8_t isEmpty = (obj->_buf->_len == 0 && !obj->_zero && !obj->_discard);
+            obj->_left = 0;
+            obj->_zero = 0;
+
+            // 忽略连续的帧结尾
+            if(isEmpty)
+            {
+                continue;
+            }
+            ConstBuf* res = Framer_End(obj, 0);
+            if(res != NULL)
+            {
+                return res;
+            }
+        }
+        else if(obj->_left == 0)
+        {
+            // 新编码块开始, 上一个编码块不足 254 字节时, 其后为被编码的 0x00
+            if(obj->_zero)
+            {
+                Framer_Append(obj, &zero, 1);
+            }
+            obj->_left = byte - 1;
+            obj->_zero = (byte != 0xFF);
+        }
+        else
+        {
+            Framer_Append(obj, &byte, 1);
+            obj->_left--;
+        }
+    }
+    return NULL;
+}
+
+ConstBuf* Framer_Push(Framer* obj, const uint8_t** data, size_t* len)
+{
+    switch(obj->_mode)
+    {
+    case FRAMER_LINE:
+        return Framer_PushLine(obj, data, len);
+    case FRAMER_LENGTH:
+        return Framer_PushLength(obj, data, len);
+    case FRAMER_COBS:
+        return Framer_PushCobs(obj, data, len);
+    default:
+        return NULL;
+    }
+}
@@ -0,0 +1,123 @@
+#include "hex_codec.h"
+
+// 大写 16 进制字符表
+static const char hexCodecDigit[] = "0123456789ABCDEF";
+
+// 字符到数值的查找表, 不是 16 进制字符时为 0xFF
+static const uint8_t hexCodecValue[256] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+
+// 每个字节均为 x 的 32 位字
+#define HEX_SWAR_BYTES(x) (0x01010101u * (uint32_t)(x))
+
+/**
+ * @brief 将 2 字节数据转为 4 个字符, 字符在字中按地址从低到高的字节排列
+ */
+static inline uint32_t HexCodec_EncodeWord(uint8_t b0, uint8_t b1)
+{
+    uint32_t n = (uint32_t)(b0 >> 4) | ((uint32_t)(b0 & 0x0F) << 8) | ((uint32_t)(b1 >> 4) << 16) | ((uint32_t)(b1 & 0x0F) << 24);
+    // 大于 9 的半字节加 6 后将进位到第 4 位, 对应字符需要额外加 'A' - '9' - 1
+    uint32_t alpha = ((n + HEX_SWAR_BYTES(0x06)) >> 4) & HEX_SWAR_BYTES(0x01);
+    return n + HEX_SWAR_BYTES('0') + alpha * ('A' - '9' - 1);
+}
+
+size_t HexCodec_Encode(uint8_t* dst, const uint8_t* src, size_t len)
+{
+    size_t i = 0;
+    for(; i + 2 <= len; i += 2)
+    {
+        uint32_t w = HexCodec_EncodeWord(src[i], src[i + 1]);
+        dst[i * 2] = (uint8_t)w;
+        dst[i * 2 + 1] = (uint8_t)(w >> 8);
+        dst[i * 2 + 2] = (uint8_t)(w >> 16);
+        dst[i * 2 + 3] = (uint8_t)(w >> 24);
+    }
+
+    if(i < len)
+    {
+        dst[i * 2] = hexCodecDigit[src[i] >> 4];
+        dst[i * 2 + 1] = hexCodecDigit[src[i] & 0x0F];
+    }
+    return len * 2;
+}
+
+size_t HexCodec_Span(const uint8_t* src, size_t len)
+{
+    size_t i = 0;
+    while(i < len && hexCodecValue[src[i]] != 0xFF)
+    {
+        i++;
+    }
+    return i;
+}
+
+uint8_t HexCodec_Decode(uint8_t* dst, const uint8_t* src, size_t len, size_t* err_pos)
+{
+    // 字符数为奇数时不写入输出缓冲区 (最后一个字节将越界), 错误位置为第一个非 16 进制字符或缺少的最后一个字符
+    if(len % 2 != 0)
+    {
+        if(err_pos != NULL)
+        {
+            *err_pos = HexCodec_Span(src, len);
+        }
+        return 0;
+    }
+
+    size_t i = 0;
+
+    // 每次查表转换 4 个字符, 合并检查是否存在非 16 进制字符 (查表结果高 4 位不为 0)
+    for(; i + 4 <= len; i += 4)
+    {
+        uint8_t v0 = hexCodecValue[src[i]];
+        uint8_t v1 = hexCodecValue[src[i + 1]];
+        uint8_t v2 = hexCodecValue[src[i + 2]];
+        uint8_t v3 = hexCodecValue[src[i + 3]];
+        if(((v0 | v1 | v2 | v3) & 0xF0) != 0)
+        {
+            break;
+        }
+
+        dst[i / 2] = (v0 << 4) | v1;
+        dst[i / 2 + 1] = (v2 << 4) | v3;
+    }
+
+    // 剩余字符或存在错误的 4 个字符逐个转换, 以确定错误位置
+    for(; i < len; i++)
+    {
+        uint8_t v = hexCodecValue[src[i]];
+        if(v == 0xFF)
+        {
+            if(err_pos != NULL)
+            {
+                *err_pos = i;
+            }
+            return 0;
+        }
+
+        if(i % 2 == 0)
+        {
+            dst[i / 2] = v << 4;
+        }
+        else
+        {
+            dst[i / 2] |= v;
+        }
+    }
+    return 1;
+}
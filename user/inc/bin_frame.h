@@ -0,0 +1,89 @@
+/**
+ * @file bin_frame.h
+ * @author tonyddg (tonyddg@outlook.com)
+ * @brief 定义基于 COBS 编码与 CRC-16 校验的二进制数据帧
+ * @version 0.1
+ * @date 2024-02-04
+ * 
+ * @copyright Copyright (c) 2024
+ * 
+ */
+
+#ifndef BIN_FRAME_DEF
+#define BIN_FRAME_DEF
+
+#include <stdint.h>
+#include "byte_buf.h"
+#include "framer.h"
+
+// 数据帧中 CRC 校验值的长度
+#define BIN_FRAME_CRC_SIZE 2
+// 长度为 len 的数据编码后的最大长度 (COBS 每 254 字节增加 1 字节开销, 另有 CRC 与帧结尾)
+#define BIN_FRAME_ENCODE_SIZE(len) ((len) + BIN_FRAME_CRC_SIZE + ((len) + BIN_FRAME_CRC_SIZE) / 254 + 2)
+
+/**
+ * @brief 计算 CRC-16/CCITT-FALSE 校验值 (多项式 0x1021, 初值 0xFFFF)
+ * 
+ * @param crc 上一段数据的校验值, 首段数据使用 0xFFFF
+ * @param data 数据
+ * @param len 数据长度
+ * @return uint16_t 校验值
+ */
+uint16_t BinFrame_Crc16(uint16_t crc, const uint8_t* data, size_t len);
+
+/**
+ * @brief 将数据编码为数据帧, 即 COBS(数据 + 大端 CRC-16) + 0x00
+ * 
+ * @param data 数据
+ * @param len 数据长度
+ * @return ConstBuf* 编码后的数据帧, 可直接发送, 分配失败时返回 NULL
+ */
+ConstBuf* BinFrame_Encode(const uint8_t* data, size_t len);
+
+/**
+ * @brief 分段接收数据块的函数, 如 UART1ReceiveData
+ */
+typedef ConstBuf* (*BinFrameReceiveTypeDef)(uint32_t timeout);
+
+/**
+ * @brief 数据帧接收器, 从分段接收的数据块中取出并校验数据帧
+ */
+typedef struct BINFRAMEREADER
+{
+    // COBS 分帧器
+    Framer _framer;
+    // 正在处理的数据块
+    ConstBuf* _chunk;
+    // 数据块中未处理的数据
+    const uint8_t* _data;
+    // 数据块中未处理的数据长度
+    size_t _len;
+    // 数据块末尾是否有作为字符串接收时补充的 \0
+    uint8_t _is_str;
+
+    // 校验失败的数据帧数
+    uint32_t _crcErrorNum;
+} BinFrameReader;
+
+/**
+ * @brief 初始化数据帧接收器
+ * 
+ * @param obj 数据帧接收器对象
+ * @param max_len 最大数据长度 (不含 CRC)
+ * @param is_str 接收到的数据块末尾是否总是补充有 \0
+ * @return uint8_t 成功返回 1, 无法分配帧缓冲区时返回 0, 此时接收器不可使用
+ */
+uint8_t BinFrameReader_Init(BinFrameReader* obj, size_t max_len, uint8_t is_str);
+
+/**
+ * @brief 接收一个校验通过的数据帧
+ * 
+ * @param obj 数据帧接收器对象
+ * @param receive 分段接收数据块的函数
+ * @param timeout 等待时间
+ * @return ConstBuf* 数据帧中的数据 (已去除 CRC), 由调用者负责销毁, 超时返回 NULL
+ * @note 校验失败与格式错误的数据帧将被丢弃
+ */
+ConstBuf* BinFrameReader_Read(BinFrameReader* obj, BinFrameReceiveTypeDef receive, uint32_t timeout);
+
+#endif
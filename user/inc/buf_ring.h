@@ -0,0 +1,78 @@
+/**
+ * @file buf_ring.h
+ * @author tonyddg (tonyddg@outlook.com)
+ * @brief 定义常量数据块的无锁环形队列
+ * @version 0.1
+ * @date 2024-02-04
+ * 
+ * @copyright Copyright (c) 2024
+ * 
+ */
+
+#ifndef BUF_RING_DEF
+#define BUF_RING_DEF
+
+#include <stdint.h>
+#include "byte_buf.h"
+#include "task_signal.h"
+
+/**
+ * @brief 常量数据块环形队列
+ * @brief 单生产者单消费者, 不使用锁, 可在中断中插入; 队列满时覆盖最早的数据块
+ * @attention 仅支持一个生产者与一个阻塞等待的消费者任务, 队列长度必须为 2 的幂
+ */
+typedef struct BUFRING
+{
+    // 数据块句柄数组
+    ConstBuf** _item;
+    // 队列长度
+    uint32_t _size;
+    // 已插入的数据块总数, 仅由生产者修改
+    volatile uint32_t _head;
+    // 已取出或丢弃的数据块总数, 由消费者与丢弃最早数据块的生产者通过原子比较交换修改
+    volatile uint32_t _tail;
+
+    // 因队列满而丢弃的数据块数
+    volatile uint32_t _dropNum;
+    // 有新数据块信号, 由等待的消费者绑定
+    TaskSignal _ready;
+} BufRing;
+
+/**
+ * @brief 初始化环形队列
+ * 
+ * @param obj 环形队列对象
+ * @param item 数据块句柄数组
+ * @param size 队列长度, 必须为 2 的幂
+ */
+void BufRing_Init(BufRing* obj, ConstBuf** item, uint32_t size);
+
+/**
+ * @brief 插入一个数据块, 队列满时丢弃最早的数据块
+ * 
+ * @param obj 环形队列对象
+ * @param data 插入的数据块
+ * @return ConstBuf* 被丢弃的数据块, 由调用者负责销毁, 没有丢弃时返回 NULL
+ * @note 可在中断中调用, 但在中断中销毁被丢弃的数据块时, 需确保其不会使用 FreeRTOS 堆
+ */
+ConstBuf* BufRing_Push(BufRing* obj, ConstBuf* data);
+
+/**
+ * @brief 取出最早插入的数据块
+ * 
+ * @param obj 环形队列对象
+ * @param timeout 队列为空时的等待时间, 为 0 时不等待
+ * @return ConstBuf* 取出的数据块, 由调用者负责销毁, 超时返回 NULL
+ * @note 等待时将当前任务绑定为消费者, 因此只能有一个任务等待
+ */
+ConstBuf* BufRing_Pop(BufRing* obj, uint32_t timeout);
+
+/**
+ * @brief 获取队列中的数据块数
+ * 
+ * @param obj 环形队列对象
+ * @return uint32_t 数据块数
+ */
+uint32_t BufRing_GetCount(const BufRing* obj);
+
+#endif
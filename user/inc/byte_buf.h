@@ -13,9 +13,32 @@
 #define BYTE_BUF_DEF
 
 #include <stdint.h>
+#include <stddef.h>
 #include "cmsis_os.h"
 
-typedef unsigned int size_t;
+// 是否统计缓冲区对象的生命周期与内存占用, 用于排查泄漏与峰值, 为 0 时不产生任何开销
+// 允许在编译选项中定义 (主机测试以此编译启用统计的版本)
+#ifndef BYTE_BUF_USE_STAT
+#define BYTE_BUF_USE_STAT 0
+#endif
+
+#if (BYTE_BUF_USE_STAT == 1)
+/**
+ * @brief 缓冲区对象统计标签, 记录对象的创建位置与占用的内存
+ */
+typedef struct BUFSTATTAG
+{
+    // 创建位置对应的统计项
+    struct BUFSTATSITE* _site;
+    // 占用的内存块大小
+    size_t _size;
+} BufStatTag;
+
+// 启用统计时, 创建函数末尾附加创建位置 (源文件与行号) 参数, 由同名宏在调用处传入
+#define BUF_SITE_PARAM , const char* site_file, uint32_t site_line
+#else
+#define BUF_SITE_PARAM
+#endif
 
 /**
  * @brief 数据缓冲区  
@@ -31,15 +54,20 @@ typedef struct BYTEBUF
     size_t _len;
     // 缓冲区长度
     size_t _size;
+
+#if (BYTE_BUF_USE_STAT == 1)
+    // 统计标签
+    BufStatTag _stat;
+#endif
 }ByteBuf;
 
 /**
  * @brief 创建数据缓冲区句柄
  * 
  * @param size 数据缓冲区的总大小
- * @return ByteBuf* 数据缓冲区对象句柄
+ * @return ByteBuf* 数据缓冲区对象句柄, 分配失败时返回 NULL
  */
-ByteBuf* ByteBuf_Create(size_t size);
+ByteBuf* ByteBuf_Create(size_t size BUF_SITE_PARAM);
 
 /**
  * @brief 删除数据缓冲区
@@ -69,15 +97,84 @@ void ByteBuf_Flush(ByteBuf* obj);
  * 
  * @param obj 数据缓冲区对象句柄
  * @param is_str 是否视为字符串, 若视为字符串, 则将在末尾添加 \0; 对于发送的数据可不视为字符串
- * @param format 格式化字符串, 同 printf
+ * @param format 格式化字符串, 支持 %s %c %u %d %x %X %%, 可带 0 填充标志与宽度 (如 %02X, %08X), 另有 %H 将 ConstBuf* 参数的数据以大写 16 进制输出
  * @param ... 格式化参数
- * @return uint8_t 当写入成功时返回 1, 否则空间不足时返回 0
+ * @return uint8_t 当写入成功时返回 1, 否则空间不足 (_len 为截断后的实际长度) 或格式不支持时返回 0
+ * @note 不使用 vsniprintf, 不分配内存且栈占用固定; 不视为字符串时, 若有空间仍在末尾写入不计入长度的 \0
+ * @note 整数可带长度修饰符 l 或 z (如 %lu, %zu), 值超出 32 位或使用其他修饰符 (如 %llu) 时视为格式不支持; %s 的参数为 NULL 时输出 (null)
  * @example ByteBuf_Printf(printBuf, 0, "[REC]%s[REC]\r\n", resBuf->_buf);
  */
 uint8_t ByteBuf_Printf(ByteBuf* obj, uint8_t is_str, const char* format, ...);
 
+// 以下追加函数均从 _len 处写入, 不会在末尾添加 \0; 空间不足时返回 0 且不修改缓冲区的有效内容
+// 用于逐段构建回复, 取代 ByteBuf_Printf(obj, 0, "%s...", obj->_buf) 这种将缓冲区格式化到自身的写法
+
+/**
+ * @brief 向数据缓冲区末尾追加数据
+ * 
+ * @param obj 数据缓冲区对象句柄
+ * @param data 数据
+ * @param len 数据长度
+ * @return uint8_t 空间不足时返回 0, 否则返回 1
+ */
+uint8_t ByteBuf_Append(ByteBuf* obj, const uint8_t* data, size_t len);
+
+/**
+ * @brief 向数据缓冲区末尾追加字符串 (不包括 \0)
+ * 
+ * @param obj 数据缓冲区对象句柄
+ * @param str 字符串
+ * @return uint8_t 空间不足时返回 0, 否则返回 1
+ */
+uint8_t ByteBuf_AppendStr(ByteBuf* obj, const char* str);
+
+/**
+ * @brief 向数据缓冲区末尾追加格式化输出
+ * 
+ * @param obj 数据缓冲区对象句柄
+ * @param format 格式化字符串, 同 ByteBuf_Printf
+ * @param ... 格式化参数
+ * @return uint8_t 空间不足或格式不支持时返回 0 (_len 恢复为追加前的长度), 否则返回 1
+ * @example ByteBuf_AppendPrintf(printBuf, "Incorrect Args: %u\r\n", len);
+ */
+uint8_t ByteBuf_AppendPrintf(ByteBuf* obj, const char* format, ...);
+
+/**
+ * @brief 向数据缓冲区末尾追加数据的大写 16 进制字符串
+ * 
+ * @param obj 数据缓冲区对象句柄
+ * @param data 数据
+ * @param len 数据长度 (将追加 len * 2 个字符)
+ * @return uint8_t 空间不足时返回 0, 否则返回 1
+ */
+uint8_t ByteBuf_AppendHex(ByteBuf* obj, const uint8_t* data, size_t len);
+
+/**
+ * @brief 预留数据缓冲区末尾的空间, 用于直接写入 (如 DMA 或编码函数)
+ * 
+ * @param obj 数据缓冲区对象句柄
+ * @param len 预留长度
+ * @return uint8_t* 预留空间的首地址 (即 _buf + _len), 空间不足时返回 NULL
+ * @note 写入后通过 ByteBuf_Commit 提交实际写入的长度, 未提交时有效内容不变
+ */
+uint8_t* ByteBuf_Reserve(ByteBuf* obj, size_t len);
+
+/**
+ * @brief 提交通过 ByteBuf_Reserve 直接写入的数据
+ * 
+ * @param obj 数据缓冲区对象句柄
+ * @param len 实际写入的长度, 不能超过预留长度
+ */
+void ByteBuf_Commit(ByteBuf* obj, size_t len);
+
 ///////////////////
 
+/**
+ * @brief 借用数据区归还回调
+ * @note `buf` 为被借用的数据区首地址
+ */
+typedef void (*ConstBufReleaseCallbackTypeDef)(uint8_t* buf);
+
 /**
  * @brief 常量数据块对象
  */
@@ -88,11 +185,21 @@ typedef struct CONSTBUF
     // 内容长度 (对于字符串, 将包含末尾的 \0)
     size_t _len;
 
-    // 是否是真常量
-    uint8_t _is_real_const;
-
     // 绑定信号量, 将在数据块销毁时释放, 不会自动创建
     osSemaphoreId_t _sid;
+
+    // 借用数据区的归还回调, 将在数据块销毁时调用, 为 NULL 时不调用
+    ConstBufReleaseCallbackTypeDef _release;
+
+    // 引用计数, 创建时为 1, 归零时销毁
+    volatile uint32_t _ref;
+    // 切片所引用的父数据块, 为 NULL 时表示不是切片
+    struct CONSTBUF* _parent;
+
+#if (BYTE_BUF_USE_STAT == 1)
+    // 统计标签
+    BufStatTag _stat;
+#endif
 }ConstBuf;
 
 /**
@@ -100,10 +207,10 @@ typedef struct CONSTBUF
  * 
  * @param obj 数据缓冲区对象句柄
  * @param is_str 是否扩展为字符串 (若末尾没有 \0, 则在末尾补充 \0)
- * @return ConstBuf* 只读数据对象句柄
+ * @return ConstBuf* 只读数据对象句柄, 分配失败时返回 NULL
  * @note 深构造, 将复制数据缓冲区的有效内容, 并在句柄销毁时一同被销毁
  */
-ConstBuf* ConstBuf_CreateByBuf(const ByteBuf* obj, uint8_t is_str);
+ConstBuf* ConstBuf_CreateByBuf(const ByteBuf* obj, uint8_t is_str BUF_SITE_PARAM);
 
 /**
  * @brief 截取已有的数据缓冲区创建只读数据
@@ -112,56 +219,100 @@ ConstBuf* ConstBuf_CreateByBuf(const ByteBuf* obj, uint8_t is_str);
  * @param beg 开始截取位置, 包括该位置, 当大于有效位置时, 返回 NULL
  * @param end 停止截取位置, 不包括该位置, 当小于等于 beg 或超过有效长度时则截取到有效末尾
  * @param is_str 是否扩展为字符串 (若末尾没有 \0, 则在末尾补充 \0)
- * @return ConstBuf* 只读数据对象句柄
+ * @return ConstBuf* 只读数据对象句柄, 分配失败时返回 NULL
  * @note 深构造, 将复制数据缓冲区的有效内容, 并在句柄销毁时一同被销毁
  */
-ConstBuf* ConstBuf_CreateExtBuf(const uint8_t* buf, size_t buf_len, size_t beg, size_t end, uint8_t is_str);
+ConstBuf* ConstBuf_CreateExtBuf(const uint8_t* buf, size_t buf_len, size_t beg, size_t end, uint8_t is_str BUF_SITE_PARAM);
 
 /**
  * @brief 创建单字节的只读数据
  * 
  * @param byte 只读数据中的字节
- * @return ConstBuf* 只读数据对象句柄
+ * @return ConstBuf* 只读数据对象句柄, 分配失败时返回 NULL
  * @note 不建议使用, 效率较低
  */
-ConstBuf* ConstBuf_CreateByByte(uint8_t byte);
+ConstBuf* ConstBuf_CreateByByte(uint8_t byte BUF_SITE_PARAM);
 
 /**
  * @brief 通过已有的常量数据创建只读数据
  * 
  * @param buf 常量数据指针
  * @param len 常量数据长度
- * @return ConstBuf* 只读数据对象句柄
+ * @return ConstBuf* 只读数据对象句柄, 分配失败时返回 NULL
  * @note 浅构造, 不会销毁常量数据
  */
-ConstBuf* ConstBuf_CreateByConst(const uint8_t* buf, size_t len);
+ConstBuf* ConstBuf_CreateByConst(const uint8_t* buf, size_t len BUF_SITE_PARAM);
 
 /**
  * @brief 通过已有的常量字符串创建只读数据
  * 
  * @param obj 常量字符串指针
- * @return ConstBuf* 只读数据对象句柄
+ * @return ConstBuf* 只读数据对象句柄, 分配失败时返回 NULL
  * @note 浅构造, 不会销毁常量数据
  */
-ConstBuf* ConstBuf_CreateByStr(const char* obj);
+ConstBuf* ConstBuf_CreateByStr(const char* obj BUF_SITE_PARAM);
+
+/**
+ * @brief 借用已有的数据区创建只读数据
+ * 
+ * @param buf 被借用的数据区指针
+ * @param len 数据区有效长度
+ * @param release 数据区归还回调, 在句柄销毁时以 buf 为参数调用
+ * @return ConstBuf* 只读数据对象句柄, 分配失败时返回 NULL
+ * @note 浅构造, 不会复制与销毁数据区, 在句柄销毁前数据区的所有者不得修改其内容
+ * @note 用于零复制地交出驱动层的接收缓冲区, 由 release 将缓冲区交还驱动层
+ */
+ConstBuf* ConstBuf_CreateByBorrow(uint8_t* buf, size_t len, ConstBufReleaseCallbackTypeDef release BUF_SITE_PARAM);
 
 /**
  * @brief 创建一个指定长度的空常量缓冲区
  * 
  * @param len 缓冲区长度
- * @return ConstBuf* 只读数据对象句柄
+ * @return ConstBuf* 只读数据对象句柄, 分配失败时返回 NULL
  * @note 用于接收定长数据, 不建议单独使用
  */
-ConstBuf* ConstBuf_CreateEmpty(size_t len);
+ConstBuf* ConstBuf_CreateEmpty(size_t len BUF_SITE_PARAM);
+
+/**
+ * @brief 截取已有的只读数据创建切片, 切片与原数据共享数据区
+ * 
+ * @param parent 被截取的只读数据对象句柄
+ * @param beg 开始截取位置, 包括该位置, 当大于等于有效长度时, 返回 NULL
+ * @param end 停止截取位置, 不包括该位置, 当小于等于 beg 或超过有效长度时则截取到有效末尾
+ * @return ConstBuf* 切片对象句柄, 分配失败时返回 NULL
+ * @note 浅构造, 切片持有原数据的一个引用, 原数据将在所有切片销毁后才被销毁
+ */
+ConstBuf* ConstBuf_Slice(ConstBuf* parent, size_t beg, size_t end BUF_SITE_PARAM);
 
 /**
- * @brief 销毁只读数据对象
+ * @brief 增加只读数据对象的引用
  * 
  * @param obj 只读数据对象句柄
- * @note 实际根据标识 _is_real_const 决定是否销毁数据指针的内容
+ * @return ConstBuf* 即 obj, 每次引用都需要对应一次 ConstBuf_Delete
+ * @note 线程安全, 可用于在多个接收者之间共享同一数据块
+ */
+ConstBuf* ConstBuf_Ref(ConstBuf* obj);
+
+/**
+ * @brief 释放只读数据对象的一个引用, 引用归零时销毁对象
+ * 
+ * @param obj 只读数据对象句柄
+ * @note 持有的数据区与对象位于同一内存块中, 随对象一同释放; 常量数据区不释放, 借用的数据区通过 _release 归还
+ * @note 销毁切片时, 将释放其对原数据的引用
+ * @note obj 为 NULL 时不执行任何操作
  */
 void ConstBuf_Delete(ConstBuf* obj);
 
+/**
+ * @brief 判断只读数据的内容是否与字符串相同
+ * 
+ * @param obj 只读数据对象句柄
+ * @param str 比较的字符串
+ * @return uint8_t 相同时返回 1, 否则返回 0
+ * @note 只读数据末尾的 \0 不参与比较
+ */
+uint8_t ConstBuf_EqualStr(const ConstBuf* obj, const char* str);
+
 /**
  * @brief 将常量数据块与信号量绑定, 在数据对象被销毁时释放信号量
  * 
@@ -173,12 +324,12 @@ void ConstBuf_BindSemaphore(ConstBuf* obj, osSemaphoreId_t sid);
 //////////////////////
 
 /**
- * @brief 解析调试字符串 (命令体 + 空格 + 大写 16 进制字符串)
+ * @brief 解析调试字符串 (命令体 + 空格 + 16 进制字符串, 不区分大小写)
  * 
  * @param str 被解析的常量缓冲区 (末尾不要求有 '\0')
- * @param body 命令体 (字符串, 末尾有 '\0')
+ * @param body 命令体 (字符串, 末尾有 '\0', 可以为空)
  * @param args 命令参数 (一般常量缓冲区, 末尾无 '\0')
- * @return uint8_t 当调试字符串提前结束时返回 0, 成功解析时返回 1
+ * @return uint8_t 当调试字符串提前结束或分配失败时返回 0, 成功解析时返回 1
  */
 uint8_t CommandResolveText(const ConstBuf* str, ConstBuf** body, ConstBuf** args);
 
@@ -187,8 +338,86 @@ uint8_t CommandResolveText(const ConstBuf* str, ConstBuf** body, ConstBuf** args
  * 
  * @param buf 被转换的缓冲区指针
  * @param len 缓冲区长度
- * @return ConstBuf* 转换为字符串的只读数据对象
+ * @return ConstBuf* 转换为字符串的只读数据对象, 分配失败时返回 NULL
  */
-ConstBuf* ConstBuf_BufToHex(const uint8_t* buf, size_t len);
+ConstBuf* ConstBuf_BufToHex(const uint8_t* buf, size_t len BUF_SITE_PARAM);
+
+//////////////////////
+
+#if (BYTE_BUF_USE_STAT == 1)
+
+// 分别统计的创建位置数量, 超出的创建位置合并到最后一项统计
+#define BUF_STAT_SITE_NUM 16
+// 分配耗时直方图的桶数, 第 i 个桶统计耗时小于 2^(i + 5) 个周期的分配, 最后一个桶统计其余分配
+#define BUF_STAT_HIST_NUM 8
+
+/**
+ * @brief 单个创建位置的统计
+ */
+typedef struct BUFSTATSITE
+{
+    // 创建位置所在的源文件 (__FILE__), 为 NULL 时表示合并统计的其他位置
+    const char* _file;
+    // 创建位置所在的行号
+    uint32_t _line;
+    // 存活对象数
+    uint32_t _liveNum;
+    // 存活对象占用的字节数
+    uint32_t _liveBytes;
+    // 占用字节数的历史最大值
+    uint32_t _peakBytes;
+} BufStatSite;
+
+/**
+ * @brief 缓冲区对象总体统计
+ */
+typedef struct BUFSTAT
+{
+    // 存活的数据缓冲区数
+    uint32_t _liveByteBuf;
+    // 存活的常量数据块数
+    uint32_t _liveConstBuf;
+    // 存活对象的数量历史最大值
+    uint32_t _peakNum;
+    // 存活对象占用的字节数
+    uint32_t _liveBytes;
+    // 占用字节数的历史最大值
+    uint32_t _peakBytes;
+    // 分配失败次数
+    uint32_t _allocFail;
+    // 分配耗时直方图
+    uint32_t _allocHist[BUF_STAT_HIST_NUM];
+} BufStat;
+
+/**
+ * @brief 获取缓冲区对象总体统计
+ * 
+ * @param stat 统计结果
+ */
+void BufStat_Get(BufStat* stat);
+
+/**
+ * @brief 获取单个创建位置的统计
+ * 
+ * @param idx 创建位置序号, 范围为 0 ~ BUF_STAT_SITE_NUM - 1
+ * @param site 统计结果
+ * @return uint8_t 该序号有记录时返回 1, 否则返回 0
+ */
+uint8_t BufStat_GetSite(uint32_t idx, BufStatSite* site);
+
+// 在调用处传入创建位置, 宏与函数同名, 函数定义处以 (函数名) 的形式避免展开
+// 创建位置在编译时确定, 不受内联与链接时优化影响
+#define ByteBuf_Create(size) ByteBuf_Create((size), __FILE__, __LINE__)
+#define ConstBuf_CreateByBuf(obj, is_str) ConstBuf_CreateByBuf((obj), (is_str), __FILE__, __LINE__)
+#define ConstBuf_CreateExtBuf(buf, buf_len, beg, end, is_str) ConstBuf_CreateExtBuf((buf), (buf_len), (beg), (end), (is_str), __FILE__, __LINE__)
+#define ConstBuf_CreateByByte(byte) ConstBuf_CreateByByte((byte), __FILE__, __LINE__)
+#define ConstBuf_CreateByConst(buf, len) ConstBuf_CreateByConst((buf), (len), __FILE__, __LINE__)
+#define ConstBuf_CreateByStr(obj) ConstBuf_CreateByStr((obj), __FILE__, __LINE__)
+#define ConstBuf_CreateByBorrow(buf, len, release) ConstBuf_CreateByBorrow((buf), (len), (release), __FILE__, __LINE__)
+#define ConstBuf_CreateEmpty(len) ConstBuf_CreateEmpty((len), __FILE__, __LINE__)
+#define ConstBuf_Slice(parent, beg, end) ConstBuf_Slice((parent), (beg), (end), __FILE__, __LINE__)
+#define ConstBuf_BufToHex(buf, len) ConstBuf_BufToHex((buf), (len), __FILE__, __LINE__)
+
+#endif
 
 #endif
\ No newline at end of file
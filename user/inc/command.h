@@ -0,0 +1,80 @@
+/**
+ * @file command.h
+ * @author tonyddg (tonyddg@outlook.com)
+ * @brief 定义基于指令表的文本指令分发
+ * @version 0.1
+ * @date 2024-02-04
+ * 
+ * @copyright Copyright (c) 2024
+ * 
+ */
+
+#ifndef COMMAND_DEF
+#define COMMAND_DEF
+
+#include <stdint.h>
+#include "byte_buf.h"
+
+/**
+ * @brief 指令处理函数
+ * @note `args` 解码后的指令参数, 由分发函数负责销毁, 处理函数需要保留时应通过 ConstBuf_Ref 或 ConstBuf_Slice 引用
+ * @note `printBuf` 输出缓冲区, 处理函数可将回复追加到其中
+ */
+typedef void (*CommandHandlerTypeDef)(ConstBuf* args, ByteBuf* printBuf);
+
+/**
+ * @brief 指令表项
+ */
+typedef struct COMMANDENTRY
+{
+    // 指令名
+    const char* _name;
+    // 指令参数的最少字节数
+    uint8_t _minArgs;
+    // 指令参数的最多字节数
+    uint8_t _maxArgs;
+    // 处理函数
+    CommandHandlerTypeDef _handler;
+} CommandEntry;
+
+/// @brief 指令分发结果
+typedef enum COMMANDRESULT
+{
+    // 已执行处理函数
+    COMMAND_OK,
+    // 指令格式错误 (指令名为空或参数不是 16 进制字符串)
+    COMMAND_BAD_FORMAT,
+    // 指令表中没有该指令
+    COMMAND_UNKNOWN,
+    // 参数字节数超出范围
+    COMMAND_BAD_ARGS,
+    // 无法分配参数数据块
+    COMMAND_NO_MEMORY
+} CommandResult;
+
+/**
+ * @brief 在指令表中查找指令
+ * 
+ * @param table 指令表, 必须按指令名的字节序 (即 strcmp 的顺序) 排列
+ * @param num 指令表项数
+ * @param name 指令名 (末尾不要求有 '\0')
+ * @param len 指令名长度
+ * @return const CommandEntry* 指令表项, 没有该指令时返回 NULL
+ * @note 二分查找, 直接比较原始字节, 不分配内存
+ */
+const CommandEntry* Command_Find(const CommandEntry* table, size_t num, const uint8_t* name, size_t len);
+
+/**
+ * @brief 解析文本指令 (指令名 [+ 空格 + 16 进制字符串, 不区分大小写]) 并执行对应的处理函数
+ * 
+ * @param table 指令表, 必须按指令名的字节序排列
+ * @param num 指令表项数
+ * @param cmd 文本指令 (末尾的 '\0', '\r' 与 '\n' 将被忽略)
+ * @param printBuf 传给处理函数的输出缓冲区
+ * @param argLen 解析得到的参数字节数, 可为 NULL
+ * @param errPos 参数格式错误时为错误字符在指令中的位置, 可为 NULL
+ * @return CommandResult 分发结果
+ */
+CommandResult Command_Dispatch(const CommandEntry* table, size_t num, const ConstBuf* cmd, ByteBuf* printBuf, size_t* argLen, size_t* errPos);
+
+#endif
@@ -0,0 +1,88 @@
+/**
+ * @file framer.h
+ * @author tonyddg (tonyddg@outlook.com)
+ * @brief 定义将分段接收的数据流重组为完整数据帧的分帧器
+ * @version 0.1
+ * @date 2024-02-04
+ * 
+ * @copyright Copyright (c) 2024
+ * 
+ */
+
+#ifndef FRAMER_DEF
+#define FRAMER_DEF
+
+#include <stdint.h>
+#include "byte_buf.h"
+
+/**
+ * @brief 分帧方式
+ */
+typedef enum FRAMERMODE
+{
+    // 以 \n 结尾的文本行, 数据帧不含行尾的 \r\n, 并以 \0 结尾, 忽略空行
+    FRAMER_LINE,
+    // 以 2 字节大端长度开头的数据帧, 数据帧不含长度
+    FRAMER_LENGTH,
+    // 以 0x00 结尾的 COBS 编码数据帧, 数据帧为解码后的数据
+    FRAMER_COBS
+} FramerMode;
+
+/**
+ * @brief 分帧器
+ * @brief 逐段输入任意切分的数据流, 每个字节只处理一次, 输出完整的数据帧
+ * @brief 超过最大长度的数据帧将被丢弃, 内存占用不超过最大长度
+ */
+typedef struct FRAMER
+{
+    // 分帧方式
+    FramerMode _mode;
+    // 当前数据帧暂存缓冲区, 长度即最大帧长度
+    ByteBuf* _buf;
+    // 当前数据帧超过最大长度或格式错误, 丢弃直到帧结束
+    uint8_t _discard;
+
+    // FRAMER_LENGTH 下已接收的长度字节数
+    uint8_t _headNum;
+    // FRAMER_LENGTH 下当前数据帧的剩余字节数 (接收长度时用于累积长度)
+    size_t _need;
+
+    // FRAMER_COBS 下当前编码块的剩余字节数
+    uint8_t _left;
+    // FRAMER_COBS 下下一个编码块开始前是否需要补充 0x00
+    uint8_t _zero;
+
+    // 超过最大长度, 格式错误或分配失败而丢弃的数据帧数
+    uint32_t _dropNum;
+} Framer;
+
+/**
+ * @brief 初始化分帧器
+ * 
+ * @param obj 分帧器对象
+ * @param mode 分帧方式
+ * @param max_len 最大帧长度 (解码后, 不含帧头与结尾, FRAMER_LINE 下包含行尾的 \r)
+ * @return uint8_t 成功返回 1, 无法分配帧缓冲区时返回 0, 此时分帧器不可使用
+ */
+uint8_t Framer_Init(Framer* obj, FramerMode mode, size_t max_len);
+
+/**
+ * @brief 丢弃当前未完成的数据帧
+ * 
+ * @param obj 分帧器对象
+ */
+void Framer_Reset(Framer* obj);
+
+/**
+ * @brief 输入数据直到得到一个完整的数据帧
+ * 
+ * @param obj 分帧器对象
+ * @param data 输入数据指针, 返回时指向第一个未处理的字节
+ * @param len 输入数据长度, 返回时为剩余未处理的字节数
+ * @return ConstBuf* 完整的数据帧, 由调用者负责销毁; 输入数据处理完仍没有完整数据帧时返回 NULL
+ * @note 应反复调用直到返回 NULL, 以取出一段输入数据中的所有数据帧
+ * @example while((frame = Framer_Push(&framer, &data, &len)) != NULL) {...}
+ */
+ConstBuf* Framer_Push(Framer* obj, const uint8_t** data, size_t* len);
+
+#endif
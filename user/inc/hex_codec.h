@@ -0,0 +1,51 @@
+/**
+ * @file hex_codec.h
+ * @author tonyddg (tonyddg@outlook.com)
+ * @brief 定义 16 进制字符串的编码与解码
+ * @version 0.1
+ * @date 2024-02-04
+ * 
+ * @copyright Copyright (c) 2024
+ * 
+ */
+
+#ifndef HEX_CODEC_DEF
+#define HEX_CODEC_DEF
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief 将数据转为大写 16 进制字符串
+ * 
+ * @param dst 输出缓冲区, 长度至少为 len * 2, 不会在末尾添加 '\0'
+ * @param src 被转换的数据
+ * @param len 数据长度
+ * @return size_t 写入的字符数, 即 len * 2
+ * @note 每次以 32 位字同时转换 2 字节数据, 没有除法与分支
+ */
+size_t HexCodec_Encode(uint8_t* dst, const uint8_t* src, size_t len);
+
+/**
+ * @brief 将 16 进制字符串 (不区分大小写) 转为数据
+ * 
+ * @param dst 输出缓冲区, 长度至少为 len / 2
+ * @param src 16 进制字符串 (末尾不要求有 '\0')
+ * @param len 字符数
+ * @param err_pos 转换失败时为第一个非 16 进制字符的位置, 字符数为奇数时为 len, 可为 NULL
+ * @return uint8_t 成功转换时返回 1, 否则返回 0 (输出缓冲区的内容不确定)
+ * @note 字符数为奇数时不写入输出缓冲区
+ * @note 每次查表转换 4 个字符, 并合并检查是否存在非 16 进制字符
+ */
+uint8_t HexCodec_Decode(uint8_t* dst, const uint8_t* src, size_t len, size_t* err_pos);
+
+/**
+ * @brief 确定字符串开头连续的 16 进制字符 (不区分大小写) 数
+ * 
+ * @param src 字符串 (末尾不要求有 '\0')
+ * @param len 字符串长度
+ * @return size_t 开头连续的 16 进制字符数
+ */
+size_t HexCodec_Span(const uint8_t* src, size_t len);
+
+#endif
@@ -0,0 +1,112 @@
+/**
+ * @file rx_ring.h
+ * @author tonyddg (tonyddg@outlook.com)
+ * @brief 定义环形 DMA 接收缓冲区
+ * @version 0.1
+ * @date 2024-02-04
+ * 
+ * @copyright Copyright (c) 2024
+ * 
+ */
+
+#ifndef RX_RING_DEF
+#define RX_RING_DEF
+
+#include <stdint.h>
+#include "byte_buf.h"
+
+/**
+ * @brief 环形接收缓冲区
+ * @brief 由循环模式的 DMA 持续写入, 中断中通过 RxRing_Produce 更新写位置, 接收者通过 RxRing_Read 读取
+ * @attention 仅支持一个接收者
+ */
+typedef struct RXRING
+{
+    // 环形缓冲区指针 (DMA 写入区域)
+    uint8_t* _buf;
+    // 环形缓冲区长度
+    size_t _size;
+    // 写位置, 即 DMA 下一个写入的位置
+    volatile size_t _wpos;
+    // 读位置, 即下一个未读字节的位置
+    volatile size_t _rpos;
+    // 未读字节数
+    volatile size_t _count;
+
+    // 接收者读取过慢导致未读数据被覆盖的次数
+    volatile uint32_t _overrunNum;
+    // 被覆盖而丢失的字节数
+    volatile uint32_t _overrunBytes;
+    // DMA 重新启动次数, 重新启动时未读数据将被移动
+    volatile uint32_t _restartNum;
+} RxRing;
+
+/**
+ * @brief 初始化环形接收缓冲区
+ * 
+ * @param obj 环形接收缓冲区对象
+ * @param buf 环形缓冲区指针, 应与 DMA 接收区域一致
+ * @param size 环形缓冲区长度
+ */
+void RxRing_Init(RxRing* obj, uint8_t* buf, size_t size);
+
+/**
+ * @brief 清空环形接收缓冲区, 未读数据计为溢出
+ * 
+ * @param obj 环形接收缓冲区对象
+ * @note 用于 DMA 重新从缓冲区起点开始接收之前
+ */
+void RxRing_Reset(RxRing* obj);
+
+/**
+ * @brief 在 DMA 停止后 (如接收错误) 准备从缓冲区起点重新开始接收, 保留全部未读数据
+ * 
+ * @param obj 环形接收缓冲区对象
+ * @param pos DMA 停止时的写入位置 (已写入的字节数, 范围为 0 ~ _size), 之前未通过事件更新的数据也将保留
+ * @return size_t 新写入的字节数, 同 RxRing_Produce
+ * @note 旋转缓冲区使未读数据按顺序位于缓冲区末尾, 写位置回到起点, 之后再重新启动 DMA
+ * @note 旋转期间屏蔽中断, 耗时与缓冲区长度成正比, 仅用于错误恢复
+ */
+size_t RxRing_Restart(RxRing* obj, size_t pos);
+
+/**
+ * @brief 更新 DMA 写位置
+ * 
+ * @param obj 环形接收缓冲区对象
+ * @param pos DMA 当前写入位置 (已写入的字节数, 范围为 0 ~ _size)
+ * @return size_t 新写入的字节数
+ * @note 用于半满, 全满与空闲中断, 两次调用之间 DMA 写入的数据量不应超过缓冲区长度
+ */
+size_t RxRing_Produce(RxRing* obj, size_t pos);
+
+/**
+ * @brief 获取未读字节数
+ * 
+ * @param obj 环形接收缓冲区对象
+ * @return size_t 未读字节数
+ */
+size_t RxRing_GetCount(const RxRing* obj);
+
+/**
+ * @brief 读取并移除未读数据
+ * 
+ * @param obj 环形接收缓冲区对象
+ * @param dst 读取目标缓冲区
+ * @param len 最多读取的字节数
+ * @return size_t 实际读取的字节数
+ * @note 若复制期间发生溢出或 DMA 重新启动, 将丢弃本次复制的数据并重新读取
+ * @attention 溢出仅能以半满, 全满与空闲事件为粒度检测: 复制期间被 DMA 覆盖, 但下一次事件尚未到达的数据不会被发现
+ */
+size_t RxRing_Read(RxRing* obj, uint8_t* dst, size_t len);
+
+/**
+ * @brief 不经复制直接丢弃未读数据
+ * 
+ * @param obj 环形接收缓冲区对象
+ * @param len 最多丢弃的字节数
+ * @return size_t 实际丢弃的字节数
+ * @note 用于无法分配结果数据块时跳过数据
+ */
+size_t RxRing_Skip(RxRing* obj, size_t len);
+
+#endif
@@ -0,0 +1,108 @@
+/**
+ * @file task_signal.h
+ * @author tonyddg (tonyddg@outlook.com)
+ * @brief 基于 FreeRTOS 任务通知的完成信号
+ * @version 0.1
+ * @date 2024-02-04
+ * 
+ * @copyright Copyright (c) 2024
+ * 
+ */
+
+#ifndef TASK_SIGNAL_DEF
+#define TASK_SIGNAL_DEF
+
+#include <stdint.h>
+#include "cmsis_os.h"
+
+// 是否统计从发出信号到等待任务被唤醒的延迟 (使用 DWT 周期计数器)
+#define TASK_SIGNAL_USE_STAT 0
+
+// 信号值中的错误标志, 其余位为传输长度或错误码
+#define TASK_SIGNAL_ERROR 0x80000000u
+
+/**
+ * @brief 完成信号
+ * @brief 用于中断回调唤醒一个确定的任务, 并通过信号值传递传输长度或错误码, 取代二值信号量
+ * @attention 使用任务通知实现, 每个任务只有一个通知 (FreeRTOS 10.3 没有带索引的任务通知), 因此一个任务只能绑定一个信号
+ * @attention 绑定信号的任务不能再使用 osThreadFlags (CMSIS RTOS2 同样以任务通知实现) 或其他任务通知, 否则将互相错误唤醒
+ */
+typedef struct TASKSIGNAL
+{
+    // 等待信号的任务
+    TaskHandle_t volatile _task;
+    // 已绑定过的信号链表, 用于检查同一任务是否绑定了多个信号
+    struct TASKSIGNAL* _next;
+
+#if (TASK_SIGNAL_USE_STAT == 1)
+    // 最近一次发出信号时的周期计数
+    volatile uint32_t _giveCycle;
+    // 唤醒延迟统计 (周期数)
+    uint32_t _latMin;
+    uint32_t _latMax;
+    uint32_t _latSum;
+    uint32_t _latNum;
+#endif
+} TaskSignal;
+
+/**
+ * @brief 将当前任务绑定为信号的等待者
+ * 
+ * @param obj 完成信号对象
+ * @note 必须在可能发出信号之前调用, 之后发出的信号才会被当前任务接收
+ * @note 信号可以改为绑定到另一个任务; 当前任务已绑定其他信号时进入 Error_Handler
+ * @attention 绑定过的信号对象将被记录, 此后必须一直有效 (静态分配)
+ */
+void TaskSignal_Bind(TaskSignal* obj);
+
+/**
+ * @brief 发出带值的信号, 未被接收的上一个信号值将被覆盖
+ * 
+ * @param obj 完成信号对象
+ * @param value 信号值, 如传输长度, 或 TASK_SIGNAL_ERROR | 错误码
+ * @note 可在中断与任务中调用, 未绑定等待者时忽略
+ */
+void TaskSignal_Give(TaskSignal* obj, uint32_t value);
+
+/**
+ * @brief 等待带值的信号
+ * 
+ * @param obj 完成信号对象
+ * @param timeout 等待时间
+ * @param value 接收到的信号值, 可为 NULL
+ * @return uint8_t 接收到信号时返回 1, 超时返回 0
+ * @note 只能由绑定的任务调用
+ */
+uint8_t TaskSignal_Wait(TaskSignal* obj, uint32_t timeout, uint32_t* value);
+
+/**
+ * @brief 发出计数信号, 每次发出将使计数加一
+ * 
+ * @param obj 完成信号对象
+ * @note 可在中断与任务中调用, 未绑定等待者时忽略, 不能与 TaskSignal_Give 混用
+ */
+void TaskSignal_Post(TaskSignal* obj);
+
+/**
+ * @brief 等待计数信号, 并使计数减一
+ * 
+ * @param obj 完成信号对象
+ * @param timeout 等待时间
+ * @return uint8_t 计数大于 0 时返回 1, 超时返回 0
+ * @note 只能由绑定的任务调用
+ */
+uint8_t TaskSignal_Pend(TaskSignal* obj, uint32_t timeout);
+
+#if (TASK_SIGNAL_USE_STAT == 1)
+/**
+ * @brief 获取唤醒延迟统计
+ * 
+ * @param obj 完成信号对象
+ * @param min 最小延迟 (us)
+ * @param max 最大延迟 (us)
+ * @param avg 平均延迟 (us)
+ */
+void TaskSignal_GetStat(const TaskSignal* obj, uint32_t* min, uint32_t* max, uint32_t* avg);
+#endif
+
+#endif
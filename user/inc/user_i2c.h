@@ -4,6 +4,20 @@
 #include "stdint.h"
 #include "byte_buf.h"
 
+// 以下开关允许在编译选项中定义 (主机测试以此编译启用统计的版本)
+// 是否统计任务帧之间的总线空闲时间 (使用 DWT 周期计数器)
+#ifndef I2C_USE_STAT
+#define I2C_USE_STAT 0
+#endif
+// 是否启用周期采样调度器
+#ifndef I2C_USE_SAMPLE
+#define I2C_USE_SAMPLE 1
+#endif
+// 是否启用寄存器缓存 (默认关闭, 读写均访问总线)
+#ifndef I2C_USE_CACHE
+#define I2C_USE_CACHE 0
+#endif
+
 /**
  * @brief I2C 发送 / 设备测试完成回调
  * @note `is_success` 为 1 表明操作成功, 为 0 表明操作失败  
@@ -17,6 +31,149 @@ typedef  void (*I2CNormalCallbackTypeDef)(uint8_t is_success);
  */
 typedef  void (*I2CRecCallbackTypeDef)(uint8_t is_success, ConstBuf* data); 
 
+/// @brief I2C 行动类型
+typedef enum I2CACTTYPE
+{
+    /// @brief 接收数据
+    I2C_ACT_REC,
+    /// @brief 发送数据
+    I2C_ACT_SEND,
+    /// @brief 测试设备
+    I2C_ACT_TOUCH,
+    /// @brief 组合事务 (仅由 I2CSubmitTransaction 提交)
+    I2C_ACT_TRANSACTION,
+    /// @brief 周期采样 (仅供采样调度器内部使用)
+    I2C_ACT_SAMPLE
+} I2CActType;
+
+/**
+ * @brief I2C 请求完成回调
+ * @note `is_success` 为 1 表明操作成功, 为 0 表明操作失败  
+ * @note `data` 接收成功时为接收到的数据, 由回调函数负责销毁, 其余情况为 NULL
+ * @note `ctx` 提交请求时传入的上下文, 如请求编号
+ */
+typedef void (*I2CResultCallbackTypeDef)(uint8_t is_success, ConstBuf* data, void* ctx);
+
+/// @brief I2C 请求优先级, 每个优先级有独立的任务队列, 总是先执行高优先级的请求
+typedef enum I2CPRIORITY
+{
+    /// @brief 低优先级
+    I2C_PRIO_LOW = -1,
+    /// @brief 默认优先级, 原有的提交函数均使用此优先级
+    I2C_PRIO_NORMAL = 0,
+    /// @brief 高优先级 (采样调度器使用此优先级)
+    I2C_PRIO_HIGH = 1
+} I2CPriority;
+
+// 优先级数
+#define I2C_PRIO_NUM 3
+
+/**
+ * @brief 单个优先级的统计
+ * @note 延迟为从提交到执行完成的时间 (ms)
+ */
+typedef struct I2CCLASSSTAT
+{
+    // 执行完成的请求数
+    uint32_t _doneNum;
+    // 超过截止时刻被取消的请求数
+    uint32_t _timeoutNum;
+    // 最大延迟
+    uint32_t _latMax;
+    // 延迟总和
+    uint32_t _latSum;
+} I2CClassStat;
+
+/**
+ * @brief I2C 请求
+ */
+typedef struct I2CREQUEST
+{
+    // 行动类型
+    I2CActType _actType;
+    // I2C 设备地址
+    uint8_t _daddr;
+    // I2C 设备寄存器地址, 当测试设备时为测试次数
+    uint8_t _raddr;
+    // 发送数据时为待发送的数据, 由 I2C 管理任务负责销毁
+    ConstBuf* _data;
+    // 接收数据时为读取数据长度
+    size_t _len;
+    // 完成回调, 若为 NULL 则不进行回调
+    I2CResultCallbackTypeDef _callBack;
+    // 传给完成回调的上下文
+    void* _ctx;
+    // 优先级, 未设置时为 I2C_PRIO_NORMAL
+    I2CPriority _priority;
+    // 截止时间 (提交后的 ms 数), 此时仍未开始执行则取消, 为 0 时没有截止时间
+    uint32_t _deadline;
+    // 超时回调, 取消时调用 (结果为失败), 为 NULL 时以失败调用完成回调
+    I2CResultCallbackTypeDef _timeoutCallBack;
+} I2CRequest;
+
+/**
+ * @brief 提交一个 I2C 请求
+ * 
+ * @param req 请求, 函数返回后即可释放
+ * @param timeout 等待插入任务队列的时间
+ * @return osStatus_t 插入任务队列状态, 插入失败或无法分配任务帧 / 数据块 (osErrorNoMemory) 时将以失败调用完成回调
+ * @note 多个请求可同时位于任务队列中, 通过上下文区分各请求的结果
+ * @note 按优先级执行, 同一优先级中有截止时间的请求按截止时刻先后执行, 其余按提交顺序执行
+ * @note 启用寄存器缓存时, 不需要访问总线的发送 / 接收仍按顺序经过任务队列, 由管理任务以成功回调
+ */
+osStatus_t I2CSubmit(const I2CRequest* req, uint32_t timeout);
+
+/// @brief 组合事务的步骤类型
+typedef enum I2CSTEPTYPE
+{
+    /// @brief 向寄存器写入 _data 中的 _len 字节
+    I2C_STEP_WRITE,
+    /// @brief 从寄存器读取 _len 字节, 依次追加到事务结果中
+    I2C_STEP_READ,
+    /// @brief 延时 _len 毫秒, 期间总线仍被占用
+    I2C_STEP_DELAY,
+    /// @brief 每隔 1 毫秒读取 1 字节寄存器, 直到 (值 & _mask) == _value, 最多读取 _len 次
+    I2C_STEP_POLL
+} I2CStepType;
+
+/**
+ * @brief 组合事务的步骤
+ */
+typedef struct I2CSTEP
+{
+    // 步骤类型
+    I2CStepType _type;
+    // I2C 设备地址
+    uint8_t _daddr;
+    // I2C 设备寄存器地址
+    uint8_t _raddr;
+    // 轮询时的掩码
+    uint8_t _mask;
+    // 轮询时的期望值
+    uint8_t _value;
+    // 写入 / 读取的字节数, 延时的毫秒数或轮询的最多次数
+    uint16_t _len;
+    // 写入的数据, 提交时复制
+    const uint8_t* _data;
+} I2CStep;
+
+/**
+ * @brief 提交一个组合事务, 在 I2C 管理任务中按顺序执行全部步骤
+ * 
+ * @param steps 步骤列表, 提交时连同写入的数据一起复制, 函数返回后即可释放
+ * @param num 步骤数
+ * @param callBack 完成回调, 成功时数据为所有读取步骤的结果按顺序拼接成的一个常量数据块, 任一步骤失败则以失败回调
+ * @param ctx 传给完成回调的上下文
+ * @param timeout 等待插入任务队列的时间
+ * @return osStatus_t 插入任务队列状态, 参数错误时返回 osErrorParameter (不回调), 插入失败或无法分配 (osErrorNoMemory) 时以失败回调
+ * @note 整个事务只占用一个任务队列元素, 一次分配与一次回调, 执行期间其他请求不会插入到步骤之间
+ * @note 步骤使用阻塞的 HAL 函数执行, 每个步骤的超时为 I2C_WAIT_TIMEOUT
+ * @example 复位 MPU6050 后读取加速度
+ * @example I2CStep steps[] = {{I2C_STEP_WRITE, 0xD0, 0x6B, 0, 0, 1, (const uint8_t*)"\x00"}, {I2C_STEP_READ, 0xD0, 0x3B, 0, 0, 6, NULL}};
+ * @example I2CSubmitTransaction(steps, 2, callBack, NULL, osWaitForever);
+ */
+osStatus_t I2CSubmitTransaction(const I2CStep* steps, uint16_t num, I2CResultCallbackTypeDef callBack, void* ctx, uint32_t timeout);
+
 /**
  * @brief 从 I2C 总线上发送数据
  * 
@@ -25,7 +182,8 @@ typedef  void (*I2CRecCallbackTypeDef)(uint8_t is_success, ConstBuf* data);
  * @param data 待发送的数据
  * @param callBack 发送成功 / 失败回调, 若传入 NULL 则不进行回调
  * @param timeout 等待插入任务队列的时间
- * @return osStatus_t 插入任务队列状态
+ * @return osStatus_t 插入任务队列状态, 插入失败或无法分配 (osErrorNoMemory) 时以失败回调
+ * @note 启用寄存器缓存时, 省略或只写入缓存的写入不访问总线, 由管理任务以成功回调
  */
 osStatus_t I2CSendData(uint8_t daddr, uint8_t raddr, ConstBuf* data, I2CNormalCallbackTypeDef callBack, uint32_t timeout);
 
@@ -37,7 +195,8 @@ osStatus_t I2CSendData(uint8_t daddr, uint8_t raddr, ConstBuf* data, I2CNormalCa
  * @param len 读取数据长度 (字节数)
  * @param callBack 发送成功 / 失败回调, 若传入 NULL 则不进行回调
  * @param timeout 等待插入任务队列的时间
- * @return osStatus_t 插入任务队列状态
+ * @return osStatus_t 插入任务队列状态, 插入失败或无法分配 (osErrorNoMemory) 时以失败回调
+ * @note 启用寄存器缓存时, 缓存命中的读取不访问总线, 由管理任务以成功回调
  */
 osStatus_t I2CRecData(uint8_t daddr, uint8_t raddr, size_t len, I2CRecCallbackTypeDef callBack, uint32_t timeout);
 
@@ -48,7 +207,7 @@ osStatus_t I2CRecData(uint8_t daddr, uint8_t raddr, size_t len, I2CRecCallbackTy
  * @param trail 测试次数
  * @param callBack 测试成功 / 失败回调, 若传入 NULL 则不进行回调
  * @param timeout 等待插入任务队列的时间
- * @return osStatus_t 插入任务队列状态
+ * @return osStatus_t 插入任务队列状态, 插入失败或无法分配 (osErrorNoMemory) 时以失败回调
  */
 osStatus_t I2CTouch(uint8_t daddr, uint8_t trail, I2CNormalCallbackTypeDef callBack, uint32_t timeout);
 
@@ -67,6 +226,15 @@ typedef enum I2CTASKSTATE
     I2C_TASK_RESET
 } I2CTaskState;
 
+/**
+ * @brief 获取单个优先级的统计
+ * 
+ * @param prio 优先级
+ * @param stat 统计结果
+ * @return uint8_t 优先级无效时返回 0
+ */
+uint8_t I2CGetClassStat(I2CPriority prio, I2CClassStat* stat);
+
 /**
  * @brief 获取当前 I2C 管理任务状态
  * 
@@ -74,4 +242,209 @@ typedef enum I2CTASKSTATE
  */
 I2CTaskState I2CGetTaskState();
 
+#if (I2C_USE_SAMPLE == 1)
+
+// 最多的采样任务数
+#define I2C_SAMPLE_JOB_NUM 8
+// 单次采样的最大字节数 (如 MPU6050 的加速度, 温度与角速度共 14 字节)
+#define I2C_SAMPLE_DATA_SIZE 14
+// 采样结果环形缓冲区的容量 (采样条数)
+#define I2C_SAMPLE_RING_SIZE 16
+
+/**
+ * @brief 一次采样的结果
+ */
+typedef struct I2CSAMPLE
+{
+    // 开始读取时的系统时刻 (ms)
+    uint32_t _tick;
+    // 采样任务编号
+    uint8_t _job;
+    // 数据长度
+    uint8_t _len;
+    // 采样数据
+    uint8_t _data[I2C_SAMPLE_DATA_SIZE];
+} I2CSample;
+
+/**
+ * @brief 采样任务统计
+ * @note 延迟为开始读取时刻与计划时刻之差 (ms), 超过一个周期时视为错过, 跳过错过的计划时刻
+ */
+typedef struct I2CSAMPLESTAT
+{
+    // 成功的采样次数
+    uint32_t _sampleNum;
+    // 读取失败的次数
+    uint32_t _failNum;
+    // 错过的计划时刻数
+    uint32_t _missNum;
+    // 最大延迟
+    uint32_t _lateMax;
+    // 延迟总和, 除以采样次数与失败次数之和即为平均延迟
+    uint32_t _lateSum;
+} I2CSampleStat;
+
+/**
+ * @brief 注册一个周期采样任务: 每隔 period 毫秒从设备 daddr 的寄存器 raddr 读取 len 字节
+ * 
+ * @param daddr I2C 设备地址
+ * @param raddr I2C 设备寄存器地址
+ * @param len 读取长度, 不超过 I2C_SAMPLE_DATA_SIZE
+ * @param period 采样周期 (ms)
+ * @return int32_t 采样任务编号, 参数错误或任务已满时返回 -1
+ * @note 自动选择采样相位, 尽量使各采样任务的计划时刻不重合
+ * @note 到期的采样任务在 I2C 管理任务中成组执行, 不分配内存, 不回调, 结果写入采样环形缓冲区
+ * @note 需在 I2C 管理任务启动后调用, 且不能在多个任务中同时注册
+ */
+int32_t I2CSampleAdd(uint8_t daddr, uint8_t raddr, uint8_t len, uint32_t period);
+
+/**
+ * @brief 注销采样任务
+ * 
+ * @param job 采样任务编号
+ */
+void I2CSampleRemove(int32_t job);
+
+/**
+ * @brief 从采样环形缓冲区中批量取出采样结果
+ * 
+ * @param samples 输出数组
+ * @param num 最多取出的条数
+ * @return size_t 实际取出的条数, 按采样顺序排列
+ * @note 缓冲区已满时丢弃最旧的结果, 通过 I2CSampleGetDropNum 获取丢弃数
+ */
+size_t I2CSampleRead(I2CSample* samples, size_t num);
+
+/**
+ * @brief 获取采样环形缓冲区已满时丢弃的结果数
+ * 
+ * @return uint32_t 丢弃的结果数
+ */
+uint32_t I2CSampleGetDropNum();
+
+/**
+ * @brief 获取采样任务统计
+ * 
+ * @param job 采样任务编号
+ * @param stat 统计结果
+ * @return uint8_t 编号无效时返回 0
+ */
+uint8_t I2CSampleGetStat(int32_t job, I2CSampleStat* stat);
+
+#endif
+
+#if (I2C_USE_CACHE == 1)
+
+// 最多可缓存的设备数, 每个设备占用 512 字节
+#define I2C_CACHE_DEV_NUM 2
+// 一次回写的最多连续写入段数
+#define I2C_CACHE_FLUSH_STEP 8
+// 回写时可并入同一段连续写入的最多未修改寄存器数
+#define I2C_CACHE_FLUSH_GAP 2
+
+/// @brief 寄存器缓存策略
+typedef enum I2CCACHEPOLICY
+{
+    /// @brief 不缓存, 读写均直接访问总线 (默认)
+    I2C_CACHE_VOLATILE,
+    /// @brief 读取结果可缓存 (如 WHO_AM_I), 写入直接访问总线并使缓存失效 (适用于写入后读出值不同的寄存器, 如自动清零的复位位)
+    I2C_CACHE_CACHEABLE,
+    /// @brief 写直达, 写入同时更新缓存与总线, 读取使用缓存
+    I2C_CACHE_WRITE_THROUGH,
+    /// @brief 写回, 写入只更新缓存并标记为脏, 通过 I2CCacheFlush 成段写入总线, 读取使用缓存
+    I2C_CACHE_WRITE_BACK
+} I2CCachePolicy;
+
+/**
+ * @brief 单个设备的寄存器缓存统计
+ */
+typedef struct I2CCACHESTAT
+{
+    // 直接从缓存完成的读取次数
+    uint32_t _hitNum;
+    // 涉及缓存寄存器但需要访问总线的读取次数
+    uint32_t _missNum;
+    // 写入值与缓存相同而省略的写入次数
+    uint32_t _skipNum;
+    // 只写入缓存 (写回) 的写入次数
+    uint32_t _deferNum;
+    // 回写的连续写入段数
+    uint32_t _flushNum;
+} I2CCacheStat;
+
+/**
+ * @brief 设置设备寄存器的缓存策略
+ * 
+ * @param daddr I2C 设备地址
+ * @param raddr 起始寄存器地址
+ * @param num 寄存器数, raddr + num 不超过 256
+ * @param policy 缓存策略
+ * @return uint8_t 参数错误或缓存的设备已满时返回 0
+ * @note 设备第一次设置时占用一个缓存位置; 设置后这些寄存器的缓存均无效, 未回写的写入将丢弃
+ * @note 缓存作用于 I2CSendData, I2CRecData 与 I2CSubmit 的发送 / 接收, 组合事务与采样任务不经过缓存
+ * @note 读写范围内存在不缓存的寄存器时, 整个读写都将访问总线
+ */
+uint8_t I2CCacheSetPolicy(uint8_t daddr, uint8_t raddr, uint16_t num, I2CCachePolicy policy);
+
+/**
+ * @brief 使设备的全部寄存器缓存失效, 如设备复位后
+ * 
+ * @param daddr I2C 设备地址
+ * @note 未回写的写入将丢弃
+ */
+void I2CCacheInvalidate(uint8_t daddr);
+
+/**
+ * @brief 将设备中写回寄存器的脏数据写入总线
+ * 
+ * @param daddr I2C 设备地址
+ * @param callBack 写入成功 / 失败回调, 若传入 NULL 则不进行回调
+ * @param timeout 等待插入任务队列的时间
+ * @return osStatus_t 插入任务队列状态, 设备未设置缓存时返回 osErrorParameter, 上一次回写未完成时返回 osErrorResource (均不回调)
+ * @note 连续的脏寄存器 (可并入不超过 I2C_CACHE_FLUSH_GAP 个与设备一致的寄存器) 作为一段连续写入, 要求设备支持寄存器地址自增
+ * @note 所有段作为一个组合事务提交, 超过 I2C_CACHE_FLUSH_STEP 段时剩余的寄存器保持为脏, 需再次回写; 没有脏数据时立即成功回调
+ * @note 写入失败时寄存器重新标记为脏
+ */
+osStatus_t I2CCacheFlush(uint8_t daddr, I2CNormalCallbackTypeDef callBack, uint32_t timeout);
+
+/**
+ * @brief 获取设备的寄存器缓存统计
+ * 
+ * @param daddr I2C 设备地址
+ * @param stat 统计结果
+ * @return uint8_t 设备未设置缓存时返回 0
+ */
+uint8_t I2CCacheGetStat(uint8_t daddr, I2CCacheStat* stat);
+
+#endif
+
+#if (I2C_USE_STAT == 1)
+
+/**
+ * @brief I2C 总线统计
+ * @note 仅当上一任务帧完成时已有任务帧在队列中等待, 才统计两者之间的总线空闲时间
+ */
+typedef struct I2CSTAT
+{
+    // 开始执行的任务帧数
+    uint32_t _frameNum;
+    // 统计了空闲时间的任务帧数
+    uint32_t _idleNum;
+    // 最小空闲时间 (周期数)
+    uint32_t _idleMin;
+    // 最大空闲时间 (周期数)
+    uint32_t _idleMax;
+    // 空闲时间总和 (周期数)
+    uint32_t _idleSum;
+} I2CStat;
+
+/**
+ * @brief 获取 I2C 总线统计
+ * 
+ * @param stat 统计结果
+ */
+void I2CGetStat(I2CStat* stat);
+
+#endif
+
 #endif
\ No newline at end of file
@@ -24,13 +24,23 @@ typedef enum UARTSENDSTATE
  * 
  * @param data 常量数据对象句柄, 通过 ConstBuf_CreateBy... 创建, 且由发送任务负责销毁  
  * @param timeout 插入队列等待时间, 即 osMessageQueuePut 的 timeout 参数
- * @return osStatus_t 插入队列执行结果, 当队列未正确初始化时, 将返回 osError
+ * @return osStatus_t 插入队列执行结果, 当队列未正确初始化时, 将返回 osError, data 为 NULL (创建失败) 时返回 osErrorNoMemory
  * @note 使用该函数前, 任务 `UART1SendTask` 必须运行中  
  * @note 该函数为线程安全的, 建议使用此函数发送数据, 而非 HAL_UART_Transmit 
  * @example UART1SendData(ConstBuf_CreateByStr("Hello World\r\n", 0), osWaitForever);
  */
 osStatus_t UART1SendData(ConstBuf* data, uint32_t timeout);
 
+/**
+ * @brief 通过 UART1 异步发送二进制数据帧 (COBS 编码, CRC-16 校验, 以 0x00 结尾)
+ * 
+ * @param data 数据帧中的数据, 编码后由该函数负责销毁
+ * @param timeout 插入队列等待时间, 即 osMessageQueuePut 的 timeout 参数
+ * @return osStatus_t 插入队列执行结果
+ * @note 使用该函数前, 任务 `UART1SendTask` 必须运行中  
+ */
+osStatus_t UART1SendFrame(ConstBuf* data, uint32_t timeout);
+
 /**
  * @brief 获取当前 UART 发送任务状态
  * 
@@ -55,14 +65,56 @@ typedef enum UARTRECSTATE
 /**
  * @brief 通过 UART1 等待接收数据
  * 
- * @param timeout 接收队列等待时间, 即 osMessageQueuePut 的 timeout 参数
+ * @param timeout 接收队列为空时的等待时间, 为 0 时不等待
  * @return ConstBuf* 接收到的常量数据块, 由接收者负责销毁
  * @note 使用该函数前, 任务 `UART1ReceiveTask` 必须运行中  
- * @note 该函数为线程安全的, 建议使用此函数接收数据, 而非 HAL_UART_Receive 
+ * @note 建议使用此函数接收数据, 而非 HAL_UART_Receive, 同一时间只能有一个任务等待接收 
  * @example resBuf = UART1ReceiveData(osWaitForever);
  */
 ConstBuf* UART1ReceiveData(uint32_t timeout);
 
+/**
+ * @brief 通过 UART1 以数据流的方式接收数据
+ * 
+ * @param buf 接收目标缓冲区
+ * @param len 最多接收的字节数
+ * @param timeout 等待新数据到达的时间
+ * @return size_t 实际接收的字节数, 超时返回 0
+ * @note 仅在环形接收模式 (UART1_REC_USE_RING) 下可用, 与 UART1ReceiveData 共享同一接收缓冲区, 不建议混用
+ * @example len = UART1ReceiveStream(buf, sizeof(buf), osWaitForever);
+ */
+size_t UART1ReceiveStream(uint8_t* buf, size_t len, uint32_t timeout);
+
+/**
+ * @brief 通过 UART1 接收一个校验通过的二进制数据帧
+ * 
+ * @param timeout 等待时间
+ * @return ConstBuf* 数据帧中的数据 (不含 CRC), 由接收者负责销毁, 超时或无法分配帧缓冲区时返回 NULL
+ * @note 通过 UART1ReceiveData 分段接收, 因此不能与其混用; 校验失败与超过 256 字节的数据帧将被丢弃
+ */
+ConstBuf* UART1ReceiveFrame(uint32_t timeout);
+
+/// @brief UART 接收统计
+typedef struct UARTRECSTAT
+{
+    // 接收者读取过慢导致数据被覆盖的次数
+    uint32_t _overrunNum;
+    // 被覆盖而丢失的字节数
+    uint32_t _overrunBytes;
+    // 外设接收错误 (溢出, 噪声, 帧错误等) 次数
+    uint32_t _errorNum;
+    // 无法分配结果数据块而丢弃的数据块数
+    uint32_t _allocFailNum;
+} UARTRecStat;
+
+/**
+ * @brief 获取 UART1 接收统计
+ * 
+ * @param stat 统计结果
+ * @note 非环形接收模式下仅统计接收队列满而丢弃的数据块数与分配失败次数
+ */
+void UART1ReceiveGetStat(UARTRecStat* stat);
+
 /**
  * @brief 获取当前 UART 接收任务状态
  * 
@@ -5,12 +5,13 @@
 #include "byte_buf.h"
 
 /**
- * @brief USB 数据接收完成回调函数
+ * @brief USB 数据接收完成回调函数, 将数据包交给接收任务, 并在有空闲缓冲区时重新开始接收
  * 
+ * @param buf 数据包所在的缓冲区
  * @param len 接收到的有效字符
- * @attention 该函数仅用于 CDC_Receive_FS 中作为回调
+ * @attention 该函数仅用于 CDC_Receive_FS 中作为回调, 并取代其中的 USBD_CDC_SetRxBuffer 与 USBD_CDC_ReceivePacket
  */
-void USB_VPC_ReceiveCmpltCallBack(uint32_t len);
+void USB_VPC_ReceiveCmpltCallBack(uint8_t* buf, uint32_t len);
 
 typedef enum USB_VPC_RECSTATE
 {
@@ -36,13 +37,36 @@ USB_VPC_RecState USB_VPC_ReceiveGetState();
 /**
  * @brief 通过 USB VPC 等待接收数据
  * 
- * @param timeout 接收队列等待时间, 即 osMessageQueuePut 的 timeout 参数
+ * @param timeout 接收队列为空时的等待时间, 为 0 时不等待
  * @return ConstBuf* 接收到的常量数据块, 由接收者负责销毁
  * @note 使用该函数前, 任务 `USB_VPC_ReceiveTask` 必须运行中  
- * @note 该函数为线程安全的, 建议使用此函数接收数据
+ * @note 建议使用此函数接收数据, 同一时间只能有一个任务等待接收
  */
 ConstBuf* USB_VPC_ReceiveData(uint32_t timeout);
 
+/**
+ * @brief 获取因无法分配结果数据块而丢弃的数据包数
+ * 
+ * @return uint32_t 丢弃的数据包数
+ */
+uint32_t USB_VPC_ReceiveGetAllocFailNum();
+
+/**
+ * @brief 通过 USB VPC 接收一个校验通过的二进制数据帧
+ * 
+ * @param timeout 等待时间
+ * @return ConstBuf* 数据帧中的数据 (不含 CRC), 由接收者负责销毁, 超时或无法分配帧缓冲区时返回 NULL
+ * @note 通过 USB_VPC_ReceiveData 分段接收, 因此不能与其混用; 校验失败与超过 256 字节的数据帧将被丢弃
+ */
+ConstBuf* USB_VPC_ReceiveFrame(uint32_t timeout);
+
+/**
+ * @brief USB 数据发送完成回调函数
+ * 
+ * @attention 该函数仅用于 CDC_TransmitCplt_FS 中作为回调
+ */
+void USB_VPC_TransmitCmpltCallBack(void);
+
 typedef enum USB_VPC_SENDSTATE
 {
     // 就绪
@@ -69,10 +93,20 @@ USB_VPC_SendState USB_VPC_SendGetState();
  * 
  * @param data 常量数据对象句柄, 通过 ConstBuf_CreateBy... 创建, 且由发送任务负责销毁  
  * @param timeout 插入队列等待时间, 即 osMessageQueuePut 的 timeout 参数
- * @return osStatus_t 插入队列执行结果, 当队列未正确初始化时, 将返回 osError
+ * @return osStatus_t 插入队列执行结果, 当队列未正确初始化时, 将返回 osError, data 为 NULL (创建失败) 时返回 osErrorNoMemory
  * @note 使用该函数前, 任务 `UART1SendTask` 必须运行中  
  * @note 该函数为线程安全的, 建议使用此函数发送数据
  */
 osStatus_t USB_VPC_SendData(ConstBuf* data, uint32_t timeout);
 
+/**
+ * @brief 通过 USB VPC 异步发送二进制数据帧 (COBS 编码, CRC-16 校验, 以 0x00 结尾)
+ * 
+ * @param data 数据帧中的数据, 编码后由该函数负责销毁
+ * @param timeout 插入队列等待时间, 即 osMessageQueuePut 的 timeout 参数
+ * @return osStatus_t 插入队列执行结果
+ * @note 使用该函数前, 任务 `USB_VPC_SendTask` 必须运行中  
+ */
+osStatus_t USB_VPC_SendFrame(ConstBuf* data, uint32_t timeout);
+
 #endif
@@ -0,0 +1,160 @@
+#include "rx_ring.h"
+#include "cmsis_os.h"
+
+#include "string.h"
+
+void RxRing_Init(RxRing* obj, uint8_t* buf, size_t size)
+{
+    obj->_buf = buf;
+    obj->_size = size;
+    obj->_wpos = 0;
+    obj->_rpos = 0;
+    obj->_count = 0;
+    obj->_overrunNum = 0;
+    obj->_overrunBytes = 0;
+    obj->_restartNum = 0;
+}
+
+void RxRing_Reset(RxRing* obj)
+{
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    if(obj->_count > 0)
+    {
+        obj->_overrunNum++;
+        obj->_overrunBytes += obj->_count;
+    }
+    obj->_wpos = 0;
+    obj->_rpos = 0;
+    obj->_count = 0;
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+}
+
+/**
+ * @brief 反转一段内存
+ * 
+ * @param beg 首字节
+ * @param end 末字节之后
+ */
+static void RxRing_Reverse(uint8_t* beg, uint8_t* end)
+{
+    while(end - beg > 1)
+    {
+        end--;
+        uint8_t tmp = *beg;
+        *beg = *end;
+        *end = tmp;
+        beg++;
+    }
+}
+
+size_t RxRing_Restart(RxRing* obj, size_t pos)
+{
+    size_t newNum = RxRing_Produce(obj, pos);
+
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+
+    // 将缓冲区循环左移 _wpos 字节, 原写位置之前的未读数据移动到缓冲区末尾
+    size_t wpos = obj->_wpos;
+    if(wpos != 0)
+    {
+        RxRing_Reverse(obj->_buf, obj->_buf + wpos);
+        RxRing_Reverse(obj->_buf + wpos, obj->_buf + obj->_size);
+        RxRing_Reverse(obj->_buf, obj->_buf + obj->_size);
+    }
+    obj->_wpos = 0;
+    obj->_rpos = (obj->_size - obj->_count) % obj->_size;
+    obj->_restartNum++;
+
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+    return newNum;
+}
+
+size_t RxRing_Produce(RxRing* obj, size_t pos)
+{
+    if(pos >= obj->_size)
+    {
+        pos = 0;
+    }
+
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+
+    size_t newNum = (pos + obj->_size - obj->_wpos) % obj->_size;
+    obj->_wpos = pos;
+    obj->_count += newNum;
+
+    // 未读数据已被 DMA 覆盖, 仅保留最新的一整圈数据
+    if(obj->_count > obj->_size)
+    {
+        obj->_overrunNum++;
+        obj->_overrunBytes += obj->_count - obj->_size;
+        obj->_count = obj->_size;
+        obj->_rpos = pos;
+    }
+
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+    return newNum;
+}
+
+size_t RxRing_GetCount(const RxRing* obj)
+{
+    return obj->_count;
+}
+
+size_t RxRing_Read(RxRing* obj, uint8_t* dst, size_t len)
+{
+    while(1)
+    {
+        UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+        size_t rpos = obj->_rpos;
+        size_t count = obj->_count;
+        uint32_t overrunNum = obj->_overrunNum;
+        uint32_t restartNum = obj->_restartNum;
+        taskEXIT_CRITICAL_FROM_ISR(mask);
+
+        if(len > count)
+        {
+            len = count;
+        }
+        if(len == 0)
+        {
+            return 0;
+        }
+
+        // 复制时不屏蔽中断, 最多分为两段
+        size_t firstLen = obj->_size - rpos;
+        if(firstLen > len)
+        {
+            firstLen = len;
+        }
+        memcpy(dst, obj->_buf + rpos, firstLen);
+        memcpy(dst + firstLen, obj->_buf, len - firstLen);
+
+        // 复制期间未发生溢出与重新启动时提交读取结果
+        mask = taskENTER_CRITICAL_FROM_ISR();
+        uint8_t isValid = (overrunNum == obj->_overrunNum && restartNum == obj->_restartNum);
+        if(isValid)
+        {
+            obj->_rpos = (rpos + len) % obj->_size;
+            obj->_count -= len;
+        }
+        taskEXIT_CRITICAL_FROM_ISR(mask);
+
+        if(isValid)
+        {
+            return len;
+        }
+    }
+}
+
+size_t RxRing_Skip(RxRing* obj, size_t len)
+{
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    if(len > obj->_count)
+    {
+        len = obj->_count;
+    }
+    obj->_rpos = (obj->_rpos + len) % obj->_size;
+    obj->_count -= len;
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+    return len;
+}
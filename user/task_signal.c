@@ -0,0 +1,146 @@
+#include "task_signal.h"
+#include "stm32f1xx_hal.h"
+#include "cmsis_os.h"
+#include "main.h"
+
+#if (TASK_SIGNAL_USE_STAT == 1)
+// 在发出信号时记录周期计数
+#define TASK_SIGNAL_STAMP(obj) ((obj)->_giveCycle = DWT->CYCCNT)
+
+// 在任务被唤醒时统计延迟
+void TaskSignal_Record(TaskSignal* obj)
+{
+    uint32_t lat = DWT->CYCCNT - obj->_giveCycle;
+    if(obj->_latNum == 0 || lat < obj->_latMin)
+    {
+        obj->_latMin = lat;
+    }
+    if(lat > obj->_latMax)
+    {
+        obj->_latMax = lat;
+    }
+    obj->_latSum += lat;
+    obj->_latNum++;
+}
+#else
+#define TASK_SIGNAL_STAMP(obj)
+#define TaskSignal_Record(obj) ((void)(obj))
+#endif
+
+// 已绑定过的信号
+static TaskSignal* taskSignalList = NULL;
+
+void TaskSignal_Bind(TaskSignal* obj)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    uint8_t isListed = 0;
+
+#if (TASK_SIGNAL_USE_STAT == 1)
+    // 启用 DWT 周期计数器
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    obj->_latMin = 0;
+    obj->_latMax = 0;
+    obj->_latSum = 0;
+    obj->_latNum = 0;
+#endif
+
+    // 每个任务只有一个任务通知, 同一任务绑定多个信号时将互相错误唤醒
+    taskENTER_CRITICAL();
+    for(TaskSignal* it = taskSignalList; it != NULL; it = it->_next)
+    {
+        if(it == obj)
+        {
+            isListed = 1;
+        }
+        else if(it->_task == self)
+        {
+            taskEXIT_CRITICAL();
+            Error_Handler();
+            return;
+        }
+    }
+    if(!isListed)
+    {
+        obj->_next = taskSignalList;
+        taskSignalList = obj;
+    }
+    // 通知方不进入临界区读取 _task, 以原子操作写入
+    __atomic_store_n(&obj->_task, self, __ATOMIC_RELEASE);
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief 以指定方式向绑定的任务发送通知
+ * 
+ * @param obj 完成信号对象
+ * @param value 通知值
+ * @param action 通知方式
+ */
+void TaskSignal_Notify(TaskSignal* obj, uint32_t value, eNotifyAction action)
+{
+    TaskHandle_t task = __atomic_load_n(&obj->_task, __ATOMIC_ACQUIRE);
+    if(task == NULL)
+    {
+        return;
+    }
+
+    TASK_SIGNAL_STAMP(obj);
+    if(xPortIsInsideInterrupt())
+    {
+        BaseType_t woken = pdFALSE;
+        xTaskNotifyFromISR(task, value, action, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+    else
+    {
+        xTaskNotify(task, value, action);
+    }
+}
+
+void TaskSignal_Give(TaskSignal* obj, uint32_t value)
+{
+    TaskSignal_Notify(obj, value, eSetValueWithOverwrite);
+}
+
+uint8_t TaskSignal_Wait(TaskSignal* obj, uint32_t timeout, uint32_t* value)
+{
+    uint32_t tmpValue = 0;
+    if(xTaskNotifyWait(0, 0xFFFFFFFFu, &tmpValue, timeout) != pdTRUE)
+    {
+        return 0;
+    }
+    TaskSignal_Record(obj);
+
+    if(value != NULL)
+    {
+        *value = tmpValue;
+    }
+    return 1;
+}
+
+void TaskSignal_Post(TaskSignal* obj)
+{
+    TaskSignal_Notify(obj, 0, eIncrement);
+}
+
+uint8_t TaskSignal_Pend(TaskSignal* obj, uint32_t timeout)
+{
+    if(ulTaskNotifyTake(pdFALSE, timeout) == 0)
+    {
+        return 0;
+    }
+    TaskSignal_Record(obj);
+    return 1;
+}
+
+#if (TASK_SIGNAL_USE_STAT == 1)
+void TaskSignal_GetStat(const TaskSignal* obj, uint32_t* min, uint32_t* max, uint32_t* avg)
+{
+    uint32_t cyclePerUs = SystemCoreClock / 1000000u;
+
+    *min = obj->_latMin / cyclePerUs;
+    *max = obj->_latMax / cyclePerUs;
+    *avg = (obj->_latNum == 0) ? 0 : obj->_latSum / obj->_latNum / cyclePerUs;
+}
+#endif
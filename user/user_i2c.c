@@ -8,17 +8,7 @@
 
 #include "user_i2c.h"
 #include "byte_buf.h"
-
-/// @brief I2C 行动类型
-typedef enum I2CACTTYPE
-{
-    /// @brief 接收数据
-    I2C_ACT_REC,
-    /// @brief 发送数据
-    I2C_ACT_SEND,
-    /// @brief 测试设备
-    I2C_ACT_TOUCH
-} I2CActType;
+#include "task_signal.h"
 
 typedef struct I2CDATAFRAME
 {
@@ -30,147 +20,1925 @@ typedef struct I2CDATAFRAME
     uint8_t _raddr;
     // I2C 接收 / 发送数据
     ConstBuf* _data;
-    // 动作执行完成时释放的信号量
+    // 动作执行完成时的回调函数
     void* _callBack;
+    // 回调函数是否为带上下文的 I2CResultCallbackTypeDef
+    uint8_t _is_result;
+    // 传给回调函数的上下文
+    void* _ctx;
+    // 执行结果, 由完成任务据此调用回调函数
+    uint8_t _result;
+    // 开始执行的时刻, 用于判断传输超时
+    uint32_t _startTick;
+    // 组合事务的步骤列表, 与任务帧分配在同一内存块中
+    I2CStep* _steps;
+    // 组合事务的步骤数
+    uint16_t _stepNum;
+    // 优先级对应的任务队列编号, 0 为最高优先级
+    uint8_t _class;
+    // 是否有截止时刻
+    uint8_t _has_deadline;
+    // 截止时刻, 此时仍未开始执行则取消
+    uint32_t _deadline;
+    // 提交的时刻, 用于统计延迟
+    uint32_t _submitTick;
+    // 超时回调, 为 NULL 时以失败调用完成回调
+    I2CResultCallbackTypeDef _timeoutCallBack;
+    // 任务队列中的下一个任务帧
+    struct I2CDATAFRAME* _next;
+    // 完成时是否需要更新寄存器缓存
+    uint8_t _cache;
 } I2CDataFrame;
 
-I2CDataFrame* I2CDataFrame_Create(uint8_t daddr, uint8_t raddr, ConstBuf* data, I2CActType type, void* callBack)
+/**
+ * @brief 创建任务帧
+ * 
+ * @param extra 在任务帧之后额外分配的字节数 (用于组合事务的步骤列表)
+ * @return I2CDataFrame* 分配失败时返回 NULL, 此时 data 仍由调用者释放
+ */
+I2CDataFrame* I2CDataFrame_CreateEx(uint8_t daddr, uint8_t raddr, ConstBuf* data, I2CActType type, void* callBack, size_t extra)
+{
+    I2CDataFrame* res = pvPortMalloc(sizeof(I2CDataFrame) + extra);
+    if(res == NULL)
+    {
+        return NULL;
+    }
+    res->_daddr = daddr;
+    res->_raddr = raddr;
+    res->_data = data;
+    res->_actType = type;
+    res->_callBack = callBack;
+    res->_is_result = 0;
+    res->_ctx = NULL;
+    res->_result = 0;
+    res->_startTick = 0;
+    res->_steps = NULL;
+    res->_stepNum = 0;
+    res->_class = I2C_PRIO_HIGH - I2C_PRIO_NORMAL;
+    res->_has_deadline = 0;
+    res->_deadline = 0;
+    res->_submitTick = 0;
+    res->_timeoutCallBack = NULL;
+    res->_next = NULL;
+    res->_cache = 0;
+    return res;
+}
+
+I2CDataFrame* I2CDataFrame_Create(uint8_t daddr, uint8_t raddr, ConstBuf* data, I2CActType type, void* callBack)
+{
+    return I2CDataFrame_CreateEx(daddr, raddr, data, type, callBack, 0);
+}
+
+/**
+ * @brief 按执行结果调用任务帧的回调, 并释放不传给回调的数据块, 不释放任务帧本身
+ */
+void I2CDataFrame_Release(I2CDataFrame* obj, uint8_t is_success)
+{
+    // 带上下文的回调, 仅接收成功时传出数据
+    if(obj->_is_result)
+    {
+        ConstBuf* data = NULL;
+        if(obj->_data != NULL)
+        {
+            if((obj->_actType == I2C_ACT_REC || obj->_actType == I2C_ACT_TRANSACTION) && is_success && obj->_callBack != NULL)
+            {
+                data = obj->_data;
+            }
+            else
+            {
+                ConstBuf_Delete(obj->_data);
+            }
+        }
+
+        if(obj->_callBack != NULL)
+        {
+            I2CResultCallbackTypeDef callBack = obj->_callBack;
+            callBack(is_success, data, obj->_ctx);
+        }
+        return;
+    }
+
+    switch (obj->_actType)
+    {
+    case I2C_ACT_REC:
+    {
+        if(is_success)
+        {
+            if(obj->_callBack != NULL)
+            {
+                I2CRecCallbackTypeDef callBack = obj->_callBack;
+                callBack(1, obj->_data);
+            }
+            else
+            {
+                ConstBuf_Delete(obj->_data);
+            }
+        }
+        else
+        {
+            ConstBuf_Delete(obj->_data);
+            if(obj->_callBack != NULL)
+            {
+                I2CRecCallbackTypeDef callBack = obj->_callBack;
+                callBack(0, NULL);
+            }
+        }
+        break;
+    }
+    case I2C_ACT_SEND:
+    {
+        if(obj->_callBack != NULL)
+        {
+            I2CNormalCallbackTypeDef callBack = obj->_callBack;
+            callBack(is_success);
+        }
+        ConstBuf_Delete(obj->_data);
+        break;
+    }
+    case I2C_ACT_TOUCH:
+    {
+        if(obj->_callBack != NULL)
+        {
+            I2CNormalCallbackTypeDef callBack = obj->_callBack;
+            callBack(is_success);
+        }
+        break;
+    }
+    case I2C_ACT_TRANSACTION:
+    {
+        // 组合事务总是使用带上下文的回调
+        ConstBuf_Delete(obj->_data);
+        break;
+    }
+    case I2C_ACT_SAMPLE:
+        break;
+    }
+}
+
+void I2CDataFrame_Delete(I2CDataFrame* obj, uint8_t is_success)
+{
+    // 采样任务帧为静态分配, 不回调也不销毁
+    if(obj->_actType == I2C_ACT_SAMPLE)
+    {
+        return;
+    }
+    I2CDataFrame_Release(obj, is_success);
+    vPortFree(obj);
+}
+
+/**
+ * @brief 任务帧分配失败时, 与插入失败相同, 释放数据块并以失败回调
+ * 
+ * @return osStatus_t 总是返回 osErrorNoMemory
+ */
+osStatus_t I2CDataFrame_NoMemory(I2CActType type, ConstBuf* data, void* callBack, uint8_t is_result, void* ctx)
+{
+    I2CDataFrame frame = {
+        ._actType = type,
+        ._data = data,
+        ._callBack = callBack,
+        ._is_result = is_result,
+        ._ctx = ctx
+    };
+    I2CDataFrame_Release(&frame, 0);
+    return osErrorNoMemory;
+}
+
+/////////////////////////////
+
+// I2C 发送队列长度
+const uint32_t I2C_DATA_QUEUE_SIZE = 12;
+// I2C 平均每次测试时长
+const uint32_t I2C_WAIT_TIMEOUT = 100;
+// I2C 是否启用 DMA 传输
+#define I2C_USE_DMA 1
+// 是否在传输完成中断中直接启动下一个任务帧 (需要启用 DMA), 回调与销毁由完成任务执行
+#define I2C_USE_CHAIN 1
+
+// 任务帧执行结果
+#define I2C_FRAME_FAIL 0
+#define I2C_FRAME_SUCCESS 1
+// 需要由完成任务执行 (测试设备需要轮询, 不能在中断中执行)
+#define I2C_FRAME_RUN 2
+// 开始执行前已超过截止时刻
+#define I2C_FRAME_TIMEOUT 3
+// 已由寄存器缓存完成, 不需要访问总线, 仅由管理任务回调
+#define I2C_FRAME_CACHED 4
+// 传输超时, 正在等待终止完成回调, 期间仍占用总线
+#define I2C_FRAME_ABORT 5
+// 启动时 HAL 忙, 仍占用总线, 由完成任务重新启动
+#define I2C_FRAME_RETRY 6
+
+/**
+ * @brief 一个优先级的任务队列
+ * @note 以任务帧的 _next 串成单链表, 有截止时刻的任务帧按截止时刻排在前面, 其余按提交顺序排在最后
+ */
+typedef struct I2CFRAMEQUEUE
+{
+    // 队首任务帧
+    I2CDataFrame* _head;
+    // 任务帧数
+    volatile uint32_t _count;
+    // 剩余空间, 提交时等待
+    osSemaphoreId_t _space;
+    // 统计
+    I2CClassStat _stat;
+} I2CFrameQueue;
+
+// 各优先级的任务队列, 按优先级从高到低排列
+I2CFrameQueue i2cFrameQueue[I2C_PRIO_NUM];
+// 任务队列是否已创建
+volatile uint8_t i2cQueueReady = 0;
+
+#if !(I2C_USE_DMA == 1 && I2C_USE_CHAIN == 1)
+// 各任务队列中任务帧的总数, 用于唤醒管理任务
+osSemaphoreId_t i2cFramePending = NULL;
+#endif
+
+void I2CQueueInit()
+{
+    for(uint32_t i = 0; i < I2C_PRIO_NUM; i++)
+    {
+        i2cFrameQueue[i]._head = NULL;
+        i2cFrameQueue[i]._count = 0;
+        i2cFrameQueue[i]._space = osSemaphoreNew(I2C_DATA_QUEUE_SIZE, I2C_DATA_QUEUE_SIZE, NULL);
+        memset(&i2cFrameQueue[i]._stat, 0, sizeof(I2CClassStat));
+    }
+#if !(I2C_USE_DMA == 1 && I2C_USE_CHAIN == 1)
+    i2cFramePending = osSemaphoreNew(I2C_PRIO_NUM * I2C_DATA_QUEUE_SIZE, 0, NULL);
+#endif
+    i2cQueueReady = 1;
+}
+
+/**
+ * @brief 获取各任务队列中任务帧的总数
+ */
+uint32_t I2CQueueCount()
+{
+    uint32_t num = 0;
+    for(uint32_t i = 0; i < I2C_PRIO_NUM; i++)
+    {
+        num += i2cFrameQueue[i]._count;
+    }
+    return num;
+}
+
+/**
+ * @brief 按截止时刻将任务帧插入对应的任务队列
+ * @note 在临界区中调用, 调用前需已取得队列空间
+ */
+void I2CQueueInsert(I2CDataFrame* frame)
+{
+    I2CDataFrame** pos = &i2cFrameQueue[frame->_class]._head;
+    while(*pos != NULL)
+    {
+        // 有截止时刻的任务帧插在第一个截止时刻更晚或没有截止时刻的任务帧之前
+        if(frame->_has_deadline && (!(*pos)->_has_deadline || (int32_t)((*pos)->_deadline - frame->_deadline) > 0))
+        {
+            break;
+        }
+        pos = &(*pos)->_next;
+    }
+    frame->_next = *pos;
+    *pos = frame;
+    i2cFrameQueue[frame->_class]._count++;
+}
+
+/**
+ * @brief 从编号为 idx 的任务队列中取出队首任务帧, 并归还队列空间
+ * @note 在中断或临界区中调用
+ */
+I2CDataFrame* I2CQueuePop(uint32_t idx)
+{
+    I2CDataFrame* frame = i2cFrameQueue[idx]._head;
+    if(frame != NULL)
+    {
+        i2cFrameQueue[idx]._head = frame->_next;
+        i2cFrameQueue[idx]._count--;
+        frame->_next = NULL;
+        osSemaphoreRelease(i2cFrameQueue[idx]._space);
+    }
+    return frame;
+}
+
+/**
+ * @brief 按优先级取出下一个任务帧
+ * 
+ * @return uint8_t 所有任务队列均为空时返回 0
+ * @note 在中断或临界区中调用
+ */
+uint8_t I2CQueueGet(I2CDataFrame** frame)
+{
+    for(uint32_t i = 0; i < I2C_PRIO_NUM; i++)
+    {
+        *frame = I2CQueuePop(i);
+        if(*frame != NULL)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief 判断任务帧是否已超过截止时刻
+ */
+uint8_t I2CFrameExpired(const I2CDataFrame* frame, uint32_t now)
+{
+    return frame->_has_deadline && (int32_t)(now - frame->_deadline) >= 0;
+}
+
+#if (I2C_USE_STAT == 1)
+
+I2CStat i2cStat;
+// 上一任务帧完成时的周期计数
+uint32_t i2cStatDoneCycle = 0;
+// 上一任务帧完成时队列中是否已有等待的任务帧
+uint8_t i2cStatBacklog = 0;
+
+// 任务帧完成时, 若已有等待的任务帧, 则记录完成时刻
+#define I2C_STAT_DONE() I2CStatDone()
+// 任务帧开始占用总线时, 统计与上一任务帧完成之间的总线空闲时间
+#define I2C_STAT_START() I2CStatStart()
+
+void I2CStatDone()
+{
+    if(I2CQueueCount() > 0)
+    {
+        i2cStatDoneCycle = DWT->CYCCNT;
+        i2cStatBacklog = 1;
+    }
+}
+
+void I2CStatStart()
+{
+    i2cStat._frameNum++;
+    if(!i2cStatBacklog)
+    {
+        return;
+    }
+    i2cStatBacklog = 0;
+
+    uint32_t idle = DWT->CYCCNT - i2cStatDoneCycle;
+    if(i2cStat._idleNum == 0 || idle < i2cStat._idleMin)
+    {
+        i2cStat._idleMin = idle;
+    }
+    if(idle > i2cStat._idleMax)
+    {
+        i2cStat._idleMax = idle;
+    }
+    i2cStat._idleSum += idle;
+    i2cStat._idleNum++;
+}
+
+void I2CGetStat(I2CStat* stat)
+{
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    *stat = i2cStat;
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+}
+
+#else
+
+#define I2C_STAT_DONE()
+#define I2C_STAT_START()
+
+#endif
+
+#if (I2C_USE_DMA == 1 && I2C_USE_CHAIN == 1)
+
+// 完成队列, 以执行完成 (或需要由完成任务执行) 的任务帧为元素
+osMessageQueueId_t i2c1DoneQueue = NULL;
+// 正在占用总线的任务帧, 为 NULL 时总线空闲
+I2CDataFrame* volatile i2cActiveFrame = NULL;
+
+/**
+ * @brief 启动任务帧的 DMA 传输
+ * 
+ * @return HAL_StatusTypeDef 启动结果, HAL 仍在终止上一传输等情况下返回 HAL_BUSY
+ */
+HAL_StatusTypeDef I2CFrameStart(I2CDataFrame* frame)
+{
+    if(frame->_actType == I2C_ACT_REC)
+    {
+        return HAL_I2C_Mem_Read_DMA(
+            &hi2c1,
+            frame->_daddr,
+            frame->_raddr,
+            I2C_MEMADD_SIZE_8BIT,
+            frame->_data->_buf,
+            frame->_data->_len
+        );
+    }
+    return HAL_I2C_Mem_Write_DMA(
+        &hi2c1,
+        frame->_daddr,
+        frame->_raddr,
+        I2C_MEMADD_SIZE_8BIT,
+        frame->_data->_buf,
+        frame->_data->_len
+    );
+}
+
+/**
+ * @brief 从任务队列取出并启动下一个任务帧, 启动出错的任务帧以失败移入完成队列
+ * 
+ * @note 在中断或临界区中调用, 调用时总线必须空闲
+ * @note 完成队列已满时暂停, 由完成任务处理完成队列后重新启动
+ * @note HAL 忙时任务帧保持占用总线, 交由完成任务稍后重新启动, 其余任务帧留在任务队列中
+ */
+void I2CStartNext()
+{
+    I2CDataFrame* frame = NULL;
+    while(osMessageQueueGetSpace(i2c1DoneQueue) > 0 && I2CQueueGet(&frame))
+    {
+        // 已超过截止时刻的任务帧不再执行, 由完成任务调用超时回调
+        if(I2CFrameExpired(frame, osKernelGetTickCount()))
+        {
+            frame->_result = I2C_FRAME_TIMEOUT;
+            osMessageQueuePut(i2c1DoneQueue, &frame, 0, 0);
+            continue;
+        }
+
+        // 已由缓存完成的任务帧不占用总线, 直接交由完成任务回调
+        if(frame->_result == I2C_FRAME_CACHED)
+        {
+            frame->_result = I2C_FRAME_SUCCESS;
+            osMessageQueuePut(i2c1DoneQueue, &frame, 0, 0);
+            continue;
+        }
+
+        i2cActiveFrame = frame;
+        frame->_startTick = osKernelGetTickCount();
+
+        if(frame->_actType == I2C_ACT_TOUCH || frame->_actType == I2C_ACT_TRANSACTION || frame->_actType == I2C_ACT_SAMPLE)
+        {
+            // 需要轮询或延时, 交由完成任务执行, 执行期间总线仍被占用
+            frame->_result = I2C_FRAME_RUN;
+            osMessageQueuePut(i2c1DoneQueue, &frame, 0, 0);
+            return;
+        }
+
+        HAL_StatusTypeDef res = I2CFrameStart(frame);
+        if(res == HAL_OK)
+        {
+            I2C_STAT_START();
+            return;
+        }
+        if(res == HAL_BUSY)
+        {
+            frame->_result = I2C_FRAME_RETRY;
+            osMessageQueuePut(i2c1DoneQueue, &frame, 0, 0);
+            return;
+        }
+
+        i2cActiveFrame = NULL;
+        frame->_result = I2C_FRAME_FAIL;
+        osMessageQueuePut(i2c1DoneQueue, &frame, 0, 0);
+    }
+}
+
+/**
+ * @brief 总线空闲时启动下一个任务帧
+ * 
+ * @note 可在任务与中断中调用
+ */
+void I2CKick()
+{
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    if(i2cActiveFrame == NULL)
+    {
+        I2CStartNext();
+    }
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+}
+
+/**
+ * @brief 以给定结果结束正在占用总线的任务帧, 并立即启动下一个任务帧
+ * 
+ * @param is_queue 是否将任务帧移入完成队列
+ * @note 在中断或临界区中调用
+ */
+void I2CFrameEnd(I2CDataFrame* frame, uint8_t result, uint8_t is_queue)
+{
+    I2C_STAT_DONE();
+    i2cActiveFrame = NULL;
+    frame->_result = result;
+    if(is_queue)
+    {
+        osMessageQueuePut(i2c1DoneQueue, &frame, 0, 0);
+    }
+    I2CStartNext();
+}
+
+/**
+ * @brief 结束正在占用总线的任务帧, 将其移入完成队列, 并立即启动下一个任务帧
+ * 
+ * @param result 执行结果
+ * @param is_task 是否为完成任务执行的任务帧 (测试设备)
+ * @note 在中断中调用时 is_task 为 0
+ */
+void I2CFrameFinish(uint8_t result, uint8_t is_task)
+{
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    I2CDataFrame* frame = i2cActiveFrame;
+
+    // 完成任务正在执行的测试, 或正在终止的传输 (由终止完成回调结束)
+    if(frame == NULL || (!is_task && (frame->_result == I2C_FRAME_RUN || frame->_result == I2C_FRAME_ABORT)))
+    {
+        taskEXIT_CRITICAL_FROM_ISR(mask);
+        return;
+    }
+
+    // 完成任务执行的任务帧由完成任务直接处理, 不再进入完成队列
+    I2CFrameEnd(frame, result, !is_task);
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+}
+
+void I2CFrameDoneCallBack(I2C_HandleTypeDef* hi2c)
+{
+    I2CFrameFinish(I2C_FRAME_SUCCESS, 0);
+}
+
+void I2CFrameErrorCallBack(I2C_HandleTypeDef* hi2c)
+{
+    I2CFrameFinish(I2C_FRAME_FAIL, 0);
+}
+
+/**
+ * @brief 终止完成回调, 此时 DMA 已停止, 超时的任务帧以失败结束
+ */
+void I2CFrameAbortCallBack(I2C_HandleTypeDef* hi2c)
+{
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    I2CDataFrame* frame = i2cActiveFrame;
+    if(frame != NULL && frame->_result == I2C_FRAME_ABORT)
+    {
+        I2CFrameEnd(frame, I2C_FRAME_FAIL, 1);
+    }
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+}
+
+/**
+ * @brief 注册传输完成, 出错与终止完成回调
+ */
+void I2CRegisterCallBack()
+{
+    HAL_I2C_RegisterCallback(&hi2c1, HAL_I2C_MEM_TX_COMPLETE_CB_ID, I2CFrameDoneCallBack);
+    HAL_I2C_RegisterCallback(&hi2c1, HAL_I2C_MEM_RX_COMPLETE_CB_ID, I2CFrameDoneCallBack);
+    HAL_I2C_RegisterCallback(&hi2c1, HAL_I2C_ERROR_CB_ID, I2CFrameErrorCallBack);
+    HAL_I2C_RegisterCallback(&hi2c1, HAL_I2C_ABORT_CB_ID, I2CFrameAbortCallBack);
+}
+
+#elif (I2C_USE_DMA == 1)
+// 任务帧完成信号, 出错时信号值为 TASK_SIGNAL_ERROR 与 HAL 错误码
+TaskSignal i2cFrameDone;
+
+void I2CFrameDoneCallBack(I2C_HandleTypeDef* hi2c)
+{
+    I2C_STAT_DONE();
+    TaskSignal_Give(&i2cFrameDone, 0);
+}
+
+// 传输出错时立即唤醒管理任务, 而不必等待超时
+void I2CFrameErrorCallBack(I2C_HandleTypeDef* hi2c)
+{
+    TaskSignal_Give(&i2cFrameDone, TASK_SIGNAL_ERROR | hi2c->ErrorCode);
+}
+
+/**
+ * @brief 注册传输完成与出错回调
+ */
+void I2CRegisterCallBack()
+{
+    HAL_I2C_RegisterCallback(&hi2c1, HAL_I2C_MEM_TX_COMPLETE_CB_ID, I2CFrameDoneCallBack);
+    HAL_I2C_RegisterCallback(&hi2c1, HAL_I2C_MEM_RX_COMPLETE_CB_ID, I2CFrameDoneCallBack);
+    HAL_I2C_RegisterCallback(&hi2c1, HAL_I2C_ERROR_CB_ID, I2CFrameErrorCallBack);
+}
+
+#endif
+
+#if (I2C_USE_DMA == 1)
+
+/**
+ * @brief 停止 DMA 并重新初始化 I2C, 用于无法通过 HAL_I2C_Master_Abort_IT 终止的传输
+ * @note F1 的 HAL 不能终止寄存器读写 (MEM 模式) 的传输; 重新初始化后 HAL 恢复默认回调, 需重新注册
+ * @note 在任务中调用, 返回后 DMA 不会再访问任务帧的数据块
+ */
+void I2CBusReset()
+{
+    HAL_DMA_Abort(hi2c1.hdmarx);
+    HAL_DMA_Abort(hi2c1.hdmatx);
+    HAL_I2C_DeInit(&hi2c1);
+    if(HAL_I2C_Init(&hi2c1) != HAL_OK)
+    {
+        Error_Handler();
+    }
+    I2CRegisterCallBack();
+}
+
+#endif
+
+#if (I2C_USE_DMA == 1 && I2C_USE_CHAIN == 1)
+
+/**
+ * @brief 在完成任务中重新启动因 HAL 忙而未能启动的任务帧
+ * @note 每毫秒重试一次, 超过 I2C_WAIT_TIMEOUT 仍未启动则以失败结束
+ */
+void I2CFrameRetry(I2CDataFrame* frame)
+{
+    while(1)
+    {
+        UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+        HAL_StatusTypeDef res = I2CFrameStart(frame);
+        if(res == HAL_OK)
+        {
+            // 传输中的任务帧由完成与出错回调设置结果, 传输超时从实际启动时开始计算
+            frame->_result = I2C_FRAME_FAIL;
+            frame->_startTick = osKernelGetTickCount();
+            I2C_STAT_START();
+            taskEXIT_CRITICAL_FROM_ISR(mask);
+            return;
+        }
+        if(res != HAL_BUSY || osKernelGetTickCount() - frame->_startTick >= I2C_WAIT_TIMEOUT)
+        {
+            I2CFrameEnd(frame, I2C_FRAME_FAIL, 1);
+            taskEXIT_CRITICAL_FROM_ISR(mask);
+            return;
+        }
+        taskEXIT_CRITICAL_FROM_ISR(mask);
+        osDelay(1);
+    }
+}
+
+/**
+ * @brief 终止超时的传输, 由终止完成回调以失败结束并启动下一个任务帧
+ * @note 在终止完成前任务帧保持占用总线, 其数据块不会被释放
+ * @note 无法终止或终止超时 (再经过 I2C_WAIT_TIMEOUT) 时停止 DMA 并重新初始化 I2C
+ */
+void I2CCheckTimeout()
+{
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    I2CDataFrame* frame = i2cActiveFrame;
+    uint32_t elapsed = (frame != NULL) ? osKernelGetTickCount() - frame->_startTick : 0;
+    uint8_t is_reset = 0;
+
+    if(frame != NULL && frame->_result == I2C_FRAME_ABORT)
+    {
+        is_reset = elapsed >= 2 * I2C_WAIT_TIMEOUT;
+    }
+    else if(frame != NULL && frame->_result != I2C_FRAME_RUN && frame->_result != I2C_FRAME_RETRY && elapsed >= I2C_WAIT_TIMEOUT)
+    {
+        frame->_result = I2C_FRAME_ABORT;
+        is_reset = HAL_I2C_Master_Abort_IT(&hi2c1, frame->_daddr) != HAL_OK;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+
+    if(!is_reset)
+    {
+        return;
+    }
+
+    I2CBusReset();
+    mask = taskENTER_CRITICAL_FROM_ISR();
+    if(i2cActiveFrame == frame)
+    {
+        I2CFrameEnd(frame, I2C_FRAME_FAIL, 1);
+    }
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+}
+
+#elif (I2C_USE_DMA == 1)
+
+/**
+ * @brief 等待 DMA 传输完成
+ * 
+ * @return uint8_t 传输成功时返回 1, 出错或超时返回 0
+ * @note 超时的传输在返回前被终止, 之后 DMA 不会再访问任务帧的数据块
+ */
+uint8_t I2CWaitFrameDone()
+{
+    uint32_t res = 0;
+    if(!TaskSignal_Wait(&i2cFrameDone, I2C_WAIT_TIMEOUT, &res))
+    {
+        I2CBusReset();
+        // 清除重新初始化前可能到达的完成信号
+        TaskSignal_Wait(&i2cFrameDone, 0, NULL);
+        return 0;
+    }
+    return (res & TASK_SIGNAL_ERROR) ? 0 : 1;
+}
+
+#endif
+
+#if (I2C_USE_CACHE == 1)
+
+// 缓存的寄存器地址范围
+#define I2C_CACHE_REG_NUM 256
+// 寄存器标志: 低 2 位为缓存策略
+#define I2C_CACHE_POLICY_MASK 0x03
+// 寄存器标志: 缓存值与设备一致 (或为待回写的值)
+#define I2C_CACHE_VALID 0x04
+// 寄存器标志: 缓存值尚未写入设备
+#define I2C_CACHE_DIRTY 0x08
+// 寄存器标志: 正在回写
+#define I2C_CACHE_FLUSHING 0x10
+
+/**
+ * @brief 单个设备的寄存器缓存
+ */
+typedef struct I2CCACHEDEV
+{
+    // 是否已使用
+    uint8_t _used;
+    // I2C 设备地址
+    uint8_t _daddr;
+    // 是否有回写正在执行
+    uint8_t _is_flushing;
+    // 已更新缓存但尚未完成的写入数, 此时读取结果不写入缓存, 避免覆盖更新的值
+    uint32_t _pendingNum;
+    // 回写完成回调
+    I2CNormalCallbackTypeDef _flushCallBack;
+    // 统计
+    I2CCacheStat _stat;
+    // 寄存器标志
+    uint8_t _flag[I2C_CACHE_REG_NUM];
+    // 寄存器缓存值
+    uint8_t _value[I2C_CACHE_REG_NUM];
+} I2CCacheDev;
+
+I2CCacheDev i2cCacheDev[I2C_CACHE_DEV_NUM];
+
+/**
+ * @brief 查找设备的寄存器缓存
+ * 
+ * @return I2CCacheDev* 设备未设置缓存时返回 NULL
+ */
+I2CCacheDev* I2CCacheFind(uint8_t daddr)
+{
+    for(uint32_t i = 0; i < I2C_CACHE_DEV_NUM; i++)
+    {
+        if(i2cCacheDev[i]._used && i2cCacheDev[i]._daddr == daddr)
+        {
+            return &i2cCacheDev[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 提交发送 / 接收任务帧时查询并更新寄存器缓存
+ * 
+ * @return uint8_t 不需要访问总线时返回 1, 此时接收的数据已从缓存复制
+ * @note 需要访问总线且涉及缓存的寄存器时, 标记任务帧在完成时调用 I2CCacheComplete
+ */
+uint8_t I2CCacheApply(I2CDataFrame* frame)
+{
+    I2CCacheDev* dev = I2CCacheFind(frame->_daddr);
+    if(dev == NULL || frame->_data == NULL)
+    {
+        return 0;
+    }
+
+    size_t len = frame->_data->_len;
+    if(len == 0 || frame->_raddr + len > I2C_CACHE_REG_NUM)
+    {
+        return 0;
+    }
+
+    uint8_t* flag = dev->_flag + frame->_raddr;
+    uint8_t* value = dev->_value + frame->_raddr;
+    uint8_t* buf = frame->_data->_buf;
+    uint8_t is_done = 0;
+
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+
+    // 范围内寄存器的策略统计
+    uint8_t is_cached = 0;
+    uint8_t is_all_cached = 1;
+    uint8_t is_all_valid = 1;
+    uint8_t is_all_back = 1;
+    for(size_t i = 0; i < len; i++)
+    {
+        uint8_t policy = flag[i] & I2C_CACHE_POLICY_MASK;
+        if(policy == I2C_CACHE_VOLATILE)
+        {
+            is_all_cached = 0;
+        }
+        else
+        {
+            is_cached = 1;
+        }
+        if(!(flag[i] & I2C_CACHE_VALID))
+        {
+            is_all_valid = 0;
+        }
+        if(policy != I2C_CACHE_WRITE_BACK)
+        {
+            is_all_back = 0;
+        }
+    }
+
+    if(!is_cached)
+    {
+        // 不涉及缓存的寄存器
+    }
+    else if(frame->_actType == I2C_ACT_REC)
+    {
+        if(is_all_cached && is_all_valid)
+        {
+            memcpy(buf, value, len);
+            dev->_stat._hitNum++;
+            is_done = 1;
+        }
+        else
+        {
+            dev->_stat._missNum++;
+            frame->_cache = 1;
+        }
+    }
+    else
+    {
+        // 可缓存寄存器的缓存值不一定是设备中的值, 因此只有写直达与写回寄存器可以省略写入
+        uint8_t is_same = is_all_valid && memcmp(value, buf, len) == 0;
+        for(size_t i = 0; i < len && is_same; i++)
+        {
+            uint8_t policy = flag[i] & I2C_CACHE_POLICY_MASK;
+            is_same = (policy == I2C_CACHE_WRITE_THROUGH || policy == I2C_CACHE_WRITE_BACK);
+        }
+
+        if(is_same)
+        {
+            dev->_stat._skipNum++;
+            is_done = 1;
+        }
+        else if(is_all_back)
+        {
+            for(size_t i = 0; i < len; i++)
+            {
+                if(!(flag[i] & I2C_CACHE_VALID) || value[i] != buf[i])
+                {
+                    value[i] = buf[i];
+                    flag[i] |= I2C_CACHE_VALID | I2C_CACHE_DIRTY;
+                }
+            }
+            dev->_stat._deferNum++;
+            is_done = 1;
+        }
+        else
+        {
+            // 写入总线, 写直达与写回寄存器同时更新缓存, 可缓存寄存器的缓存失效
+            for(size_t i = 0; i < len; i++)
+            {
+                uint8_t policy = flag[i] & I2C_CACHE_POLICY_MASK;
+                if(policy == I2C_CACHE_WRITE_THROUGH || policy == I2C_CACHE_WRITE_BACK)
+                {
+                    value[i] = buf[i];
+                    flag[i] = (flag[i] | I2C_CACHE_VALID) & ~I2C_CACHE_DIRTY;
+                }
+                else if(policy == I2C_CACHE_CACHEABLE)
+                {
+                    flag[i] &= ~I2C_CACHE_VALID;
+                }
+            }
+            dev->_pendingNum++;
+            frame->_cache = 1;
+        }
+    }
+
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+    return is_done;
+}
+
+/**
+ * @brief 访问总线的发送 / 接收任务帧完成时更新寄存器缓存
+ * @note 接收成功时将结果写入缓存, 待回写的寄存器则以缓存值替换结果; 发送失败时使缓存失效
+ */
+void I2CCacheComplete(I2CDataFrame* frame, uint8_t is_success)
+{
+    I2CCacheDev* dev = I2CCacheFind(frame->_daddr);
+    if(dev == NULL || !frame->_cache)
+    {
+        return;
+    }
+
+    size_t len = frame->_data->_len;
+    uint8_t* flag = dev->_flag + frame->_raddr;
+    uint8_t* value = dev->_value + frame->_raddr;
+    uint8_t* buf = frame->_data->_buf;
+
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    if(frame->_actType == I2C_ACT_REC)
+    {
+        for(size_t i = 0; i < len && is_success; i++)
+        {
+            if((flag[i] & I2C_CACHE_POLICY_MASK) == I2C_CACHE_VOLATILE)
+            {
+                continue;
+            }
+
+            if(flag[i] & I2C_CACHE_DIRTY)
+            {
+                buf[i] = value[i];
+            }
+            else if(dev->_pendingNum == 0)
+            {
+                value[i] = buf[i];
+                flag[i] |= I2C_CACHE_VALID;
+            }
+        }
+    }
+    else
+    {
+        if(!is_success)
+        {
+            for(size_t i = 0; i < len; i++)
+            {
+                if((flag[i] & I2C_CACHE_POLICY_MASK) != I2C_CACHE_VOLATILE)
+                {
+                    flag[i] &= ~(I2C_CACHE_VALID | I2C_CACHE_DIRTY);
+                }
+            }
+        }
+        dev->_pendingNum--;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+}
+
+#endif
+
+/**
+ * @brief 将任务帧插入其优先级的任务队列, 并启动或唤醒执行
+ * 
+ * @note 调用前必须已取得该优先级任务队列的空间
+ */
+void I2CQueueSubmit(I2CDataFrame* frame)
+{
+    frame->_submitTick = osKernelGetTickCount();
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    I2CQueueInsert(frame);
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+
+#if (I2C_USE_DMA == 1 && I2C_USE_CHAIN == 1)
+    I2CKick();
+#else
+    osSemaphoreRelease(i2cFramePending);
+#endif
+}
+
+/**
+ * @brief 等待任务队列空间, 将任务帧插入其优先级的任务队列, 并启动或唤醒执行
+ * 
+ * @param timeout 等待队列空间的时长
+ * @return osStatus_t 插入任务队列状态, 失败时不销毁任务帧
+ */
+osStatus_t I2CQueuePut(I2CDataFrame* frame, uint32_t timeout)
+{
+    osStatus_t res = osSemaphoreAcquire(i2cFrameQueue[frame->_class]._space, timeout);
+    if(res != osOK)
+    {
+        return res;
+    }
+
+    I2CQueueSubmit(frame);
+    return osOK;
+}
+
+/**
+ * @brief 在任务中结束任务帧: 记录优先级统计, 调用回调函数 (超时时调用超时回调) 并销毁
+ */
+void I2CFrameComplete(I2CDataFrame* frame)
+{
+    I2CClassStat* stat = &i2cFrameQueue[frame->_class]._stat;
+    uint32_t lat = osKernelGetTickCount() - frame->_submitTick;
+
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    if(frame->_result == I2C_FRAME_TIMEOUT)
+    {
+        stat->_timeoutNum++;
+    }
+    else
+    {
+        stat->_doneNum++;
+        stat->_latSum += lat;
+        if(lat > stat->_latMax)
+        {
+            stat->_latMax = lat;
+        }
+    }
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+
+    if(frame->_result == I2C_FRAME_TIMEOUT && frame->_timeoutCallBack != NULL)
+    {
+        I2CResultCallbackTypeDef callBack = frame->_timeoutCallBack;
+        frame->_callBack = NULL;
+        callBack(0, NULL, frame->_ctx);
+    }
+#if (I2C_USE_CACHE == 1)
+    I2CCacheComplete(frame, frame->_result == I2C_FRAME_SUCCESS);
+#endif
+    I2CDataFrame_Delete(frame, frame->_result == I2C_FRAME_SUCCESS);
+}
+
+/**
+ * @brief 取消各任务队列中已超过截止时刻的任务帧
+ * 
+ * @param wait 没有截止时刻时的最长等待时间
+ * @return uint32_t 到最近的截止时刻的等待时间, 不超过 wait
+ * @note 在管理任务中调用, 超时回调在管理任务中执行
+ */
+uint32_t I2CExpire(uint32_t wait)
+{
+    I2CDataFrame* expired = NULL;
+    uint32_t now = osKernelGetTickCount();
+
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    for(uint32_t i = 0; i < I2C_PRIO_NUM; i++)
+    {
+        // 有截止时刻的任务帧按截止时刻排在队首
+        while(i2cFrameQueue[i]._head != NULL && I2CFrameExpired(i2cFrameQueue[i]._head, now))
+        {
+            I2CDataFrame* frame = I2CQueuePop(i);
+#if !(I2C_USE_DMA == 1 && I2C_USE_CHAIN == 1)
+            osSemaphoreAcquire(i2cFramePending, 0);
+#endif
+            frame->_next = expired;
+            expired = frame;
+        }
+
+        I2CDataFrame* head = i2cFrameQueue[i]._head;
+        if(head != NULL && head->_has_deadline && head->_deadline - now < wait)
+        {
+            wait = head->_deadline - now;
+        }
+    }
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+
+    while(expired != NULL)
+    {
+        I2CDataFrame* frame = expired;
+        expired = frame->_next;
+        frame->_result = I2C_FRAME_TIMEOUT;
+        I2CFrameComplete(frame);
+    }
+    return wait;
+}
+
+/**
+ * @brief 向任务队列插入新的任务
+ * 
+ * @param frame I2C 任务帧句柄
+ * @param timeout 等待时长
+ * @return osStatus_t 插入任务队列状态
+ */
+osStatus_t I2CPutFrame(I2CDataFrame* frame, uint32_t timeout)
+{
+    // 数据块创建失败时直接以失败完成
+    if(frame->_data == NULL && (frame->_actType == I2C_ACT_REC || frame->_actType == I2C_ACT_SEND || frame->_actType == I2C_ACT_TRANSACTION))
+    {
+        I2CDataFrame_Delete(frame, 0);
+        return osErrorNoMemory;
+    }
+
+    // 先取得队列空间再查询缓存, 插入失败时缓存不受影响
+    osStatus_t res = osSemaphoreAcquire(i2cFrameQueue[frame->_class]._space, timeout);
+    if(res != osOK)
+    {
+        I2CDataFrame_Delete(frame, 0);
+        return res;
+    }
+
+#if (I2C_USE_CACHE == 1)
+    // 不需要访问总线的任务帧仍经过任务队列, 使回调总在管理任务中执行
+    if((frame->_actType == I2C_ACT_REC || frame->_actType == I2C_ACT_SEND) && I2CCacheApply(frame))
+    {
+        frame->_result = I2C_FRAME_CACHED;
+    }
+#endif
+
+    I2CQueueSubmit(frame);
+    return osOK;
+}
+
+osStatus_t I2CSubmit(const I2CRequest* req, uint32_t timeout)
+{
+    ConstBuf* data = NULL;
+    switch(req->_actType)
+    {
+    case I2C_ACT_REC:
+        data = ConstBuf_CreateEmpty(req->_len);
+        break;
+    case I2C_ACT_SEND:
+        data = req->_data;
+        break;
+    case I2C_ACT_TOUCH:
+        break;
+    case I2C_ACT_TRANSACTION:
+    case I2C_ACT_SAMPLE:
+        // 组合事务需通过 I2CSubmitTransaction 提交, 采样任务需通过 I2CSampleAdd 注册
+        return osErrorParameter;
+    }
+
+    I2CDataFrame* frame = I2CDataFrame_Create(req->_daddr, req->_raddr, data, req->_actType, req->_callBack);
+    if(frame == NULL)
+    {
+        return I2CDataFrame_NoMemory(req->_actType, data, req->_callBack, 1, req->_ctx);
+    }
+    frame->_is_result = 1;
+    frame->_ctx = req->_ctx;
+    if(req->_priority >= I2C_PRIO_LOW && req->_priority <= I2C_PRIO_HIGH)
+    {
+        frame->_class = I2C_PRIO_HIGH - req->_priority;
+    }
+    if(req->_deadline != 0)
+    {
+        frame->_has_deadline = 1;
+        frame->_deadline = osKernelGetTickCount() + req->_deadline;
+    }
+    frame->_timeoutCallBack = req->_timeoutCallBack;
+    return I2CPutFrame(frame, timeout);
+}
+
+osStatus_t I2CSendData(uint8_t daddr, uint8_t raddr, ConstBuf* data, I2CNormalCallbackTypeDef callBack, uint32_t timeout)
+{
+    I2CDataFrame* frame = I2CDataFrame_Create(daddr, raddr, data, I2C_ACT_SEND, callBack);
+    if(frame == NULL)
+    {
+        return I2CDataFrame_NoMemory(I2C_ACT_SEND, data, callBack, 0, NULL);
+    }
+    return I2CPutFrame(frame, timeout);
+}
+
+osStatus_t I2CRecData(uint8_t daddr, uint8_t raddr, size_t len, I2CRecCallbackTypeDef callBack, uint32_t timeout)
+{
+    ConstBuf* data = ConstBuf_CreateEmpty(len);
+    I2CDataFrame* frame = I2CDataFrame_Create(daddr, raddr, data, I2C_ACT_REC, callBack);
+    if(frame == NULL)
+    {
+        return I2CDataFrame_NoMemory(I2C_ACT_REC, data, callBack, 0, NULL);
+    }
+    return I2CPutFrame(frame, timeout);
+}
+
+osStatus_t I2CTouch(uint8_t daddr, uint8_t trail, I2CNormalCallbackTypeDef callBack, uint32_t timeout)
+{
+    I2CDataFrame* frame = I2CDataFrame_Create(daddr, trail, NULL, I2C_ACT_TOUCH, callBack);
+    if(frame == NULL)
+    {
+        return I2CDataFrame_NoMemory(I2C_ACT_TOUCH, NULL, callBack, 0, NULL);
+    }
+    return I2CPutFrame(frame, timeout);
+}
+
+osStatus_t I2CSubmitTransaction(const I2CStep* steps, uint16_t num, I2CResultCallbackTypeDef callBack, void* ctx, uint32_t timeout)
+{
+    if(steps == NULL || num == 0)
+    {
+        return osErrorParameter;
+    }
+
+    // 统计读取结果与写入数据的总长度
+    size_t readLen = 0;
+    size_t writeLen = 0;
+    for(uint16_t i = 0; i < num; i++)
+    {
+        if(steps[i]._type == I2C_STEP_READ)
+        {
+            readLen += steps[i]._len;
+        }
+        else if(steps[i]._type == I2C_STEP_WRITE)
+        {
+            if(steps[i]._data == NULL)
+            {
+                return osErrorParameter;
+            }
+            writeLen += steps[i]._len;
+        }
+    }
+
+    // 步骤列表与写入数据紧跟在任务帧之后, 只需一次分配
+    ConstBuf* result = ConstBuf_CreateEmpty(readLen);
+    I2CDataFrame* frame = I2CDataFrame_CreateEx(0, 0, result, I2C_ACT_TRANSACTION, callBack, num * sizeof(I2CStep) + writeLen);
+    if(frame == NULL)
+    {
+        return I2CDataFrame_NoMemory(I2C_ACT_TRANSACTION, result, callBack, 1, ctx);
+    }
+    frame->_is_result = 1;
+    frame->_ctx = ctx;
+    frame->_steps = (I2CStep*)(frame + 1);
+    frame->_stepNum = num;
+    memcpy(frame->_steps, steps, num * sizeof(I2CStep));
+
+    uint8_t* data = (uint8_t*)(frame->_steps + num);
+    for(uint16_t i = 0; i < num; i++)
+    {
+        if(steps[i]._type == I2C_STEP_WRITE)
+        {
+            memcpy(data, steps[i]._data, steps[i]._len);
+            frame->_steps[i]._data = data;
+            data += steps[i]._len;
+        }
+    }
+
+    return I2CPutFrame(frame, timeout);
+}
+
+#if (I2C_USE_CACHE == 1)
+
+uint8_t I2CCacheSetPolicy(uint8_t daddr, uint8_t raddr, uint16_t num, I2CCachePolicy policy)
+{
+    if(raddr + num > I2C_CACHE_REG_NUM || policy > I2C_CACHE_WRITE_BACK)
+    {
+        return 0;
+    }
+
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    I2CCacheDev* dev = I2CCacheFind(daddr);
+    for(uint32_t i = 0; i < I2C_CACHE_DEV_NUM && dev == NULL; i++)
+    {
+        if(!i2cCacheDev[i]._used)
+        {
+            dev = &i2cCacheDev[i];
+            memset(dev, 0, sizeof(I2CCacheDev));
+            dev->_used = 1;
+            dev->_daddr = daddr;
+        }
+    }
+    if(dev != NULL)
+    {
+        memset(dev->_flag + raddr, policy, num);
+    }
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+    return dev != NULL;
+}
+
+void I2CCacheInvalidate(uint8_t daddr)
+{
+    I2CCacheDev* dev = I2CCacheFind(daddr);
+    if(dev == NULL)
+    {
+        return;
+    }
+
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    for(uint32_t i = 0; i < I2C_CACHE_REG_NUM; i++)
+    {
+        dev->_flag[i] &= ~(I2C_CACHE_VALID | I2C_CACHE_DIRTY);
+    }
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+}
+
+/**
+ * @brief 判断寄存器是否可以并入回写的连续写入 (缓存值与设备一致的写直达 / 写回寄存器)
+ */
+uint8_t I2CCacheIsClean(uint8_t flag)
+{
+    uint8_t policy = flag & I2C_CACHE_POLICY_MASK;
+    return (policy == I2C_CACHE_WRITE_THROUGH || policy == I2C_CACHE_WRITE_BACK) &&
+        (flag & (I2C_CACHE_VALID | I2C_CACHE_DIRTY)) == I2C_CACHE_VALID;
+}
+
+/**
+ * @brief 回写事务完成回调
+ * 
+ * @param ctx 设备的寄存器缓存
+ */
+void I2CCacheFlushDone(uint8_t is_success, ConstBuf* data, void* ctx)
+{
+    I2CCacheDev* dev = ctx;
+    if(data != NULL)
+    {
+        ConstBuf_Delete(data);
+    }
+
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    for(uint32_t i = 0; i < I2C_CACHE_REG_NUM; i++)
+    {
+        if(dev->_flag[i] & I2C_CACHE_FLUSHING)
+        {
+            dev->_flag[i] &= ~I2C_CACHE_FLUSHING;
+            if(!is_success)
+            {
+                dev->_flag[i] |= I2C_CACHE_DIRTY;
+            }
+        }
+    }
+    I2CNormalCallbackTypeDef callBack = dev->_flushCallBack;
+    dev->_is_flushing = 0;
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+
+    if(callBack != NULL)
+    {
+        callBack(is_success);
+    }
+}
+
+osStatus_t I2CCacheFlush(uint8_t daddr, I2CNormalCallbackTypeDef callBack, uint32_t timeout)
+{
+    I2CCacheDev* dev = I2CCacheFind(daddr);
+    if(dev == NULL)
+    {
+        return osErrorParameter;
+    }
+
+    I2CStep steps[I2C_CACHE_FLUSH_STEP];
+    uint16_t num = 0;
+
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    if(dev->_is_flushing)
+    {
+        taskEXIT_CRITICAL_FROM_ISR(mask);
+        return osErrorResource;
+    }
+
+    uint32_t raddr = 0;
+    while(raddr < I2C_CACHE_REG_NUM && num < I2C_CACHE_FLUSH_STEP)
+    {
+        if(!(dev->_flag[raddr] & I2C_CACHE_DIRTY))
+        {
+            raddr++;
+            continue;
+        }
+
+        // 向后延伸到最后一个脏寄存器, 中间可跨过不超过 I2C_CACHE_FLUSH_GAP 个与设备一致的寄存器
+        uint32_t end = raddr + 1;
+        uint32_t scan = end;
+        while(scan < I2C_CACHE_REG_NUM)
+        {
+            if(dev->_flag[scan] & I2C_CACHE_DIRTY)
+            {
+                end = ++scan;
+            }
+            else if(scan - end < I2C_CACHE_FLUSH_GAP && I2CCacheIsClean(dev->_flag[scan]))
+            {
+                scan++;
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        // 写入的数据在提交时复制, 其后再次写入的寄存器将重新标记为脏
+        steps[num] = (I2CStep){
+            ._type = I2C_STEP_WRITE,
+            ._daddr = daddr,
+            ._raddr = raddr,
+            ._len = end - raddr,
+            ._data = dev->_value + raddr
+        };
+        num++;
+        for(; raddr < end; raddr++)
+        {
+            if(dev->_flag[raddr] & I2C_CACHE_DIRTY)
+            {
+                dev->_flag[raddr] = (dev->_flag[raddr] & ~I2C_CACHE_DIRTY) | I2C_CACHE_FLUSHING;
+            }
+        }
+    }
+
+    if(num > 0)
+    {
+        dev->_is_flushing = 1;
+        dev->_flushCallBack = callBack;
+        dev->_stat._flushNum += num;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+
+    if(num == 0)
+    {
+        if(callBack != NULL)
+        {
+            callBack(1);
+        }
+        return osOK;
+    }
+
+    // 插入失败时以失败回调, 寄存器重新标记为脏
+    return I2CSubmitTransaction(steps, num, I2CCacheFlushDone, dev, timeout);
+}
+
+uint8_t I2CCacheGetStat(uint8_t daddr, I2CCacheStat* stat)
+{
+    I2CCacheDev* dev = I2CCacheFind(daddr);
+    if(dev == NULL)
+    {
+        return 0;
+    }
+
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    *stat = dev->_stat;
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+    return 1;
+}
+
+#endif
+
+#if (I2C_USE_SAMPLE == 1)
+
+/**
+ * @brief 采样任务
+ */
+typedef struct I2CSAMPLEJOB
+{
+    // 是否已注册
+    volatile uint8_t _active;
+    // I2C 设备地址
+    uint8_t _daddr;
+    // I2C 设备寄存器地址
+    uint8_t _raddr;
+    // 读取长度
+    uint8_t _len;
+    // 采样周期 (ms)
+    uint32_t _period;
+    // 采样相位, 计划时刻均满足 时刻 % 周期 == 相位
+    uint32_t _phase;
+    // 下一个计划时刻
+    uint32_t _next;
+    // 统计
+    I2CSampleStat _stat;
+} I2CSampleJob;
+
+I2CSampleJob i2cSampleJob[I2C_SAMPLE_JOB_NUM];
+
+// 采样环形缓冲区的位置数, 比容量多一个位置, 使正在读取的采样结果不会占用最旧的结果
+#define I2C_SAMPLE_RING_SLOT_NUM (I2C_SAMPLE_RING_SIZE + 1)
+
+// 采样环形缓冲区, 由 I2C 管理任务写入, 由使用者批量读取
+I2CSample i2cSampleRing[I2C_SAMPLE_RING_SLOT_NUM];
+uint32_t i2cSampleHead = 0;
+uint32_t i2cSampleCount = 0;
+uint32_t i2cSampleDrop = 0;
+
+// 采样任务帧, 静态分配, 有到期的采样任务时放入任务队列, 执行时完成全部到期的采样
+I2CDataFrame i2cSampleFrame = {
+    ._actType = I2C_ACT_SAMPLE,
+    // 采样使用最高优先级
+    ._class = 0,
+};
+// 采样任务帧是否位于任务队列中或正在执行
+volatile uint8_t i2cSampleQueued = 0;
+// 在下一个计划时刻将采样任务帧放入任务队列的定时器
+osTimerId_t i2cSampleTimer = NULL;
+
+uint32_t I2CSampleGcd(uint32_t a, uint32_t b)
 {
-    I2CDataFrame* res = pvPortMalloc(sizeof(I2CDataFrame));
-    res->_daddr = daddr;
-    res->_raddr = raddr;
-    res->_data = data;
-    res->_actType = type;
-    res->_callBack = callBack;
-    return res;
+    while(b != 0)
+    {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
 }
 
-void I2CDataFrame_Delete(I2CDataFrame* obj, uint8_t is_success)
+/**
+ * @brief 为新的采样任务选择相位
+ * @note 周期为 P, Q 的两个任务的计划时刻重合, 当且仅当两者相位模 gcd(P, Q) 同余, 因此选择与已有任务同余最少的相位
+ */
+uint32_t I2CSampleChoosePhase(uint32_t period)
 {
-    switch (obj->_actType)
+    uint32_t best = 0;
+    uint32_t bestNum = UINT32_MAX;
+    for(uint32_t phase = 0; phase < period && bestNum > 0; phase++)
     {
-    case I2C_ACT_REC:
-    {
-        if(is_success)
+        uint32_t num = 0;
+        for(uint32_t i = 0; i < I2C_SAMPLE_JOB_NUM; i++)
         {
-            if(obj->_callBack != NULL)
+            if(i2cSampleJob[i]._active)
             {
-                I2CRecCallbackTypeDef callBack = obj->_callBack;
-                callBack(1, obj->_data);
-            }
-            else
-            {
-                ConstBuf_Delete(obj->_data);
+                uint32_t g = I2CSampleGcd(period, i2cSampleJob[i]._period);
+                if(phase % g == i2cSampleJob[i]._phase % g)
+                {
+                    num++;
+                }
             }
         }
-        else
+
+        if(num < bestNum)
         {
-            ConstBuf_Delete(obj->_data);
-            if(obj->_callBack != NULL)
-            {
-                I2CRecCallbackTypeDef callBack = obj->_callBack;
-                callBack(0, NULL);
-            }
+            best = phase;
+            bestNum = num;
         }
-        break;
     }
-    case I2C_ACT_SEND:
+    return best;
+}
+
+/**
+ * @brief 在下一个计划时刻 (或 delay 毫秒后) 放入采样任务帧
+ * 
+ * @param delay 最长等待时间, 为 0 时等待到最近的计划时刻
+ */
+void I2CSampleSchedule(uint32_t delay)
+{
+    uint32_t now = osKernelGetTickCount();
+    for(uint32_t i = 0; i < I2C_SAMPLE_JOB_NUM; i++)
     {
-        if(obj->_callBack != NULL)
+        if(i2cSampleJob[i]._active)
         {
-            I2CNormalCallbackTypeDef callBack = obj->_callBack;
-            callBack(is_success);
+            int32_t wait = (int32_t)(i2cSampleJob[i]._next - now);
+            wait = (wait < 1) ? 1 : wait;
+            if(delay == 0 || (uint32_t)wait < delay)
+            {
+                delay = wait;
+            }
         }
-        ConstBuf_Delete(obj->_data);
-        break;
     }
-    case I2C_ACT_TOUCH:
+
+    if(delay != 0)
     {
-        if(obj->_callBack != NULL)
+        osTimerStart(i2cSampleTimer, delay);
+    }
+}
+
+void I2CSampleTimerCallBack(void* args)
+{
+    if(i2cSampleQueued)
+    {
+        return;
+    }
+
+    i2cSampleQueued = 1;
+    if(I2CQueuePut(&i2cSampleFrame, 0) != osOK)
+    {
+        // 任务队列已满, 稍后重试
+        i2cSampleQueued = 0;
+        osTimerStart(i2cSampleTimer, 1);
+    }
+}
+
+int32_t I2CSampleAdd(uint8_t daddr, uint8_t raddr, uint8_t len, uint32_t period)
+{
+    if(len == 0 || len > I2C_SAMPLE_DATA_SIZE || period == 0 || !i2cQueueReady)
+    {
+        return -1;
+    }
+
+    if(i2cSampleTimer == NULL)
+    {
+        i2cSampleTimer = osTimerNew(I2CSampleTimerCallBack, osTimerOnce, NULL, NULL);
+    }
+
+    for(int32_t i = 0; i < I2C_SAMPLE_JOB_NUM; i++)
+    {
+        I2CSampleJob* job = &i2cSampleJob[i];
+        if(!job->_active)
         {
-            I2CNormalCallbackTypeDef callBack = obj->_callBack;
-            callBack(is_success);
+            job->_daddr = daddr;
+            job->_raddr = raddr;
+            job->_len = len;
+            job->_period = period;
+            job->_phase = I2CSampleChoosePhase(period);
+            memset(&job->_stat, 0, sizeof(I2CSampleStat));
+
+            // 首个计划时刻为此后第一个满足相位的时刻
+            uint32_t now = osKernelGetTickCount();
+            job->_next = now + (job->_phase + period - now % period) % period;
+            if(job->_next == now)
+            {
+                job->_next += period;
+            }
+
+            job->_active = 1;
+            if(!i2cSampleQueued)
+            {
+                I2CSampleSchedule(0);
+            }
+            return i;
         }
-        break;
     }
+    return -1;
+}
+
+void I2CSampleRemove(int32_t job)
+{
+    if(job >= 0 && job < I2C_SAMPLE_JOB_NUM)
+    {
+        i2cSampleJob[job]._active = 0;
     }
-    vPortFree(obj);
 }
 
-/////////////////////////////
+size_t I2CSampleRead(I2CSample* samples, size_t num)
+{
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    if(num > i2cSampleCount)
+    {
+        num = i2cSampleCount;
+    }
 
-// I2C 发送队列长度
-const uint32_t I2C_DATA_QUEUE_SIZE = 12;
-// I2C 平均每次测试时长
-const uint32_t I2C_WAIT_TIMEOUT = 100;
-// I2C 是否启用 DMA 传输
-#define I2C_USE_DMA 1
+    uint32_t tail = (i2cSampleHead + I2C_SAMPLE_RING_SLOT_NUM - i2cSampleCount) % I2C_SAMPLE_RING_SLOT_NUM;
+    for(size_t i = 0; i < num; i++)
+    {
+        samples[i] = i2cSampleRing[(tail + i) % I2C_SAMPLE_RING_SLOT_NUM];
+    }
+    i2cSampleCount -= num;
+    taskEXIT_CRITICAL_FROM_ISR(mask);
 
-// 发送数据暂存队列 (以暂存的常量数据块为元素)
-osMessageQueueId_t i2c1DataQueue = NULL;
+    return num;
+}
 
-#if (I2C_USE_DMA == 1)
-osSemaphoreId_t i2cFrameDone = NULL;
+uint32_t I2CSampleGetDropNum()
+{
+    return i2cSampleDrop;
+}
 
-void I2CFrameDoneCallBack(I2C_HandleTypeDef* hi2c)
+uint8_t I2CSampleGetStat(int32_t job, I2CSampleStat* stat)
 {
-    if(i2cFrameDone != NULL)
+    if(job < 0 || job >= I2C_SAMPLE_JOB_NUM || !i2cSampleJob[job]._active)
     {
-        osSemaphoreRelease(i2cFrameDone);
+        return 0;
     }
+
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    *stat = i2cSampleJob[job]._stat;
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+    return 1;
 }
 
-#endif
+/**
+ * @brief 预留环形缓冲区中的下一条采样结果
+ * @note 预留的位置为空闲位置, 在提交前不会被使用者读取, 也不会覆盖已有的结果
+ */
+I2CSample* I2CSampleReserve()
+{
+    return &i2cSampleRing[i2cSampleHead];
+}
 
 /**
- * @brief 向任务队列插入新的任务
+ * @brief 提交预留的采样结果, 已满时丢弃最旧的结果
+ * @note 仅在读取成功后调用, 读取失败时不影响已有的结果
+ */
+void I2CSampleCommit()
+{
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    if(i2cSampleCount == I2C_SAMPLE_RING_SIZE)
+    {
+        i2cSampleCount--;
+        i2cSampleDrop++;
+    }
+    i2cSampleHead = (i2cSampleHead + 1) % I2C_SAMPLE_RING_SLOT_NUM;
+    i2cSampleCount++;
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+}
+
+/**
+ * @brief 在任务中执行全部到期的采样任务, 完成后安排下一次采样
  * 
- * @param frame I2C 任务帧句柄
- * @param timeout 等待时长
- * @return osStatus_t 插入任务队列状态
+ * @return uint8_t 总是返回 1, 各采样任务的失败记录在统计中
  */
-osStatus_t I2CPutFrame(I2CDataFrame* frame, uint32_t timeout)
+uint8_t I2CSampleRun()
 {
-    osStatus_t res = osMessageQueuePut(i2c1DataQueue, &frame, 0, timeout);
+    I2C_STAT_START();
 
-    if(res != osOK)
+    for(uint32_t i = 0; i < I2C_SAMPLE_JOB_NUM; i++)
     {
-        I2CDataFrame_Delete(frame, 0);
+        I2CSampleJob* job = &i2cSampleJob[i];
+        uint32_t now = osKernelGetTickCount();
+        if(!job->_active || (int32_t)(now - job->_next) < 0)
+        {
+            continue;
+        }
+
+        // 跳过已错过的计划时刻
+        uint32_t late = now - job->_next;
+        if(late >= job->_period)
+        {
+            job->_stat._missNum += late / job->_period;
+            job->_next += late / job->_period * job->_period;
+            late %= job->_period;
+        }
+        job->_next += job->_period;
+
+        I2CSample* sample = I2CSampleReserve();
+        uint8_t is_success = HAL_I2C_Mem_Read(&hi2c1, job->_daddr, job->_raddr, I2C_MEMADD_SIZE_8BIT, sample->_data, job->_len, I2C_WAIT_TIMEOUT) == HAL_OK;
+
+        UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+        if(is_success)
+        {
+            job->_stat._sampleNum++;
+        }
+        else
+        {
+            job->_stat._failNum++;
+        }
+        job->_stat._lateSum += late;
+        if(late > job->_stat._lateMax)
+        {
+            job->_stat._lateMax = late;
+        }
+        taskEXIT_CRITICAL_FROM_ISR(mask);
+
+        if(is_success)
+        {
+            sample->_tick = now;
+            sample->_job = i;
+            sample->_len = job->_len;
+            I2CSampleCommit();
+        }
     }
-    return res;
+
+    i2cSampleQueued = 0;
+    I2CSampleSchedule(0);
+    return 1;
 }
 
-osStatus_t I2CSendData(uint8_t daddr, uint8_t raddr, ConstBuf* data, I2CNormalCallbackTypeDef callBack, uint32_t timeout)
+#endif
+
+/**
+ * @brief 在任务中执行测试设备
+ * 
+ * @return uint8_t 测试成功时返回 1
+ */
+uint8_t I2CTouchRun(I2CDataFrame* frame)
 {
-    return I2CPutFrame(I2CDataFrame_Create(daddr, raddr, data, I2C_ACT_SEND, callBack), timeout);
+    I2C_STAT_START();
+    return HAL_I2C_IsDeviceReady(
+        &hi2c1,
+        frame->_daddr,
+        frame->_raddr,
+        I2C_WAIT_TIMEOUT
+    ) == HAL_OK;
 }
 
-osStatus_t I2CRecData(uint8_t daddr, uint8_t raddr, size_t len, I2CRecCallbackTypeDef callBack, uint32_t timeout)
+/**
+ * @brief 在任务中按顺序执行组合事务的全部步骤
+ * 
+ * @return uint8_t 全部步骤成功时返回 1, 任一步骤失败时立即返回 0
+ */
+uint8_t I2CTransactionRun(I2CDataFrame* frame)
 {
-    return I2CPutFrame(I2CDataFrame_Create(daddr, raddr, ConstBuf_CreateEmpty(len), I2C_ACT_REC, callBack), timeout);
+    I2C_STAT_START();
+    uint8_t* res = frame->_data->_buf;
+
+    for(uint16_t i = 0; i < frame->_stepNum; i++)
+    {
+        const I2CStep* step = &frame->_steps[i];
+        switch(step->_type)
+        {
+        case I2C_STEP_WRITE:
+        {
+            if(HAL_I2C_Mem_Write(&hi2c1, step->_daddr, step->_raddr, I2C_MEMADD_SIZE_8BIT, (uint8_t*)step->_data, step->_len, I2C_WAIT_TIMEOUT) != HAL_OK)
+            {
+                return 0;
+            }
+            break;
+        }
+        case I2C_STEP_READ:
+        {
+            if(HAL_I2C_Mem_Read(&hi2c1, step->_daddr, step->_raddr, I2C_MEMADD_SIZE_8BIT, res, step->_len, I2C_WAIT_TIMEOUT) != HAL_OK)
+            {
+                return 0;
+            }
+            res += step->_len;
+            break;
+        }
+        case I2C_STEP_DELAY:
+        {
+            osDelay(step->_len);
+            break;
+        }
+        case I2C_STEP_POLL:
+        {
+            uint8_t value = 0;
+            uint16_t n = 0;
+            while(1)
+            {
+                if(HAL_I2C_Mem_Read(&hi2c1, step->_daddr, step->_raddr, I2C_MEMADD_SIZE_8BIT, &value, 1, I2C_WAIT_TIMEOUT) != HAL_OK)
+                {
+                    return 0;
+                }
+                if((value & step->_mask) == step->_value)
+                {
+                    break;
+                }
+                if(++n >= step->_len)
+                {
+                    return 0;
+                }
+                osDelay(1);
+            }
+            break;
+        }
+        }
+    }
+    return 1;
 }
 
-osStatus_t I2CTouch(uint8_t daddr, uint8_t trail, I2CNormalCallbackTypeDef callBack, uint32_t timeout)
+/**
+ * @brief 在任务中执行不能在中断中启动的任务帧
+ * 
+ * @return uint8_t 执行成功时返回 1
+ */
+uint8_t I2CFrameRun(I2CDataFrame* frame)
 {
-    return I2CPutFrame(I2CDataFrame_Create(daddr, trail, NULL, I2C_ACT_TOUCH, callBack), timeout);
+    switch(frame->_actType)
+    {
+    case I2C_ACT_TRANSACTION:
+        return I2CTransactionRun(frame);
+#if (I2C_USE_SAMPLE == 1)
+    case I2C_ACT_SAMPLE:
+        return I2CSampleRun();
+#endif
+    default:
+        return I2CTouchRun(frame);
+    }
+}
+
+#if (I2C_USE_DMA == 1 && I2C_USE_CHAIN == 1)
+
+void I2CManageTask(void* args)
+{
+    I2CDataFrame* queueData = NULL;
+    I2CQueueInit();
+    i2c1DoneQueue = osMessageQueueNew(I2C_DATA_QUEUE_SIZE, sizeof(I2CDataFrame*), NULL);
+
+    #if (I2C_USE_STAT == 1)
+    // 启用 DWT 周期计数器
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    #endif
+
+    I2CRegisterCallBack();
+
+    // 作为完成任务, 任务帧由提交函数与传输完成中断启动
+    while(1)
+    {
+        // 同时在截止时刻取消队列中超时的任务帧
+        if(osMessageQueueGet(i2c1DoneQueue, &queueData, NULL, I2CExpire(I2C_WAIT_TIMEOUT)) != osOK)
+        {
+            I2CCheckTimeout();
+            continue;
+        }
+
+        // 重新启动后由回调 (或启动失败时) 再次移入完成队列
+        if(queueData->_result == I2C_FRAME_RETRY)
+        {
+            I2CFrameRetry(queueData);
+            continue;
+        }
+        if(queueData->_result == I2C_FRAME_RUN)
+        {
+            I2CFrameFinish(I2CFrameRun(queueData), 1);
+        }
+        I2CFrameComplete(queueData);
+
+        // 完成队列已满时启动会暂停, 处理后需重新启动
+        I2CKick();
+    }
+
+    return;
 }
 
+#else
+
 void I2CManageTask(void* args)
 {
     I2CDataFrame* queueData = NULL;
-    i2c1DataQueue = osMessageQueueNew(I2C_DATA_QUEUE_SIZE, sizeof(I2CDataFrame*), NULL);
+    I2CQueueInit();
+
+    #if (I2C_USE_STAT == 1)
+    // 启用 DWT 周期计数器
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    #endif
 
     #if (I2C_USE_DMA == 1)
     
-    i2cFrameDone = osSemaphoreNew(1, 0, NULL);
-    HAL_I2C_RegisterCallback(&hi2c1, HAL_I2C_MEM_TX_COMPLETE_CB_ID, I2CFrameDoneCallBack);
-    HAL_I2C_RegisterCallback(&hi2c1, HAL_I2C_MEM_RX_COMPLETE_CB_ID, I2CFrameDoneCallBack);
+    TaskSignal_Bind(&i2cFrameDone);
+    I2CRegisterCallBack();
 
     #endif
 
     while(1)
     {
-        osMessageQueueGet(i2c1DataQueue, &queueData, NULL, osWaitForever);
+        // 同时在截止时刻取消队列中超时的任务帧
+        if(osSemaphoreAcquire(i2cFramePending, I2CExpire(osWaitForever)) != osOK)
+        {
+            continue;
+        }
+
+        UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+        uint8_t is_get = I2CQueueGet(&queueData);
+        taskEXIT_CRITICAL_FROM_ISR(mask);
+        if(!is_get)
+        {
+            continue;
+        }
+        if(I2CFrameExpired(queueData, osKernelGetTickCount()))
+        {
+            queueData->_result = I2C_FRAME_TIMEOUT;
+            I2CFrameComplete(queueData);
+            continue;
+        }
+        // 已由缓存完成的任务帧不访问总线
+        if(queueData->_result == I2C_FRAME_CACHED)
+        {
+            queueData->_result = I2C_FRAME_SUCCESS;
+            I2CFrameComplete(queueData);
+            continue;
+        }
+
         uint8_t is_success = 0;
 
         switch(queueData->_actType)
@@ -187,13 +1955,12 @@ void I2CManageTask(void* args)
                 queueData->_data->_len
             ) == HAL_OK)
             {
-                if(osSemaphoreAcquire(i2cFrameDone, I2C_WAIT_TIMEOUT) == osOK)
-                {
-                    is_success = 1;
-                }
+                I2C_STAT_START();
+                is_success = I2CWaitFrameDone();
             }
             break;
         #else
+            I2C_STAT_START();
             if(HAL_I2C_Mem_Read(
                 &hi2c1,
                 queueData->_daddr,
@@ -221,13 +1988,12 @@ void I2CManageTask(void* args)
                 queueData->_data->_len
             ) == HAL_OK)
             {
-                if(osSemaphoreAcquire(i2cFrameDone, I2C_WAIT_TIMEOUT) == osOK)
-                {
-                    is_success = 1;
-                }
+                I2C_STAT_START();
+                is_success = I2CWaitFrameDone();
             }
             break;
         #else
+            I2C_STAT_START();
             if(HAL_I2C_Mem_Write(
                 &hi2c1,
                 queueData->_daddr,
@@ -245,27 +2011,41 @@ void I2CManageTask(void* args)
         }
         case I2C_ACT_TOUCH:
         {
-            if(HAL_I2C_IsDeviceReady(
-                &hi2c1,
-                queueData->_daddr,
-                queueData->_raddr,
-                I2C_WAIT_TIMEOUT
-            ) == HAL_OK)
-            {
-                is_success = 1;
-            }
+            is_success = I2CTouchRun(queueData);
+            break;
+        }
+        case I2C_ACT_TRANSACTION:
+        case I2C_ACT_SAMPLE:
+        {
+            is_success = I2CFrameRun(queueData);
             break;
         }
         }
-        I2CDataFrame_Delete(queueData, is_success);
+        queueData->_result = is_success ? I2C_FRAME_SUCCESS : I2C_FRAME_FAIL;
+        I2CFrameComplete(queueData);
     }
 
     return;
 }
 
+#endif
+
+uint8_t I2CGetClassStat(I2CPriority prio, I2CClassStat* stat)
+{
+    if(prio < I2C_PRIO_LOW || prio > I2C_PRIO_HIGH)
+    {
+        return 0;
+    }
+
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    *stat = i2cFrameQueue[I2C_PRIO_HIGH - prio]._stat;
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+    return 1;
+}
+
 I2CTaskState I2CGetTaskState()
 {
-    if(i2c1DataQueue == NULL)
+    if(!i2cQueueReady)
     {
         return I2C_TASK_UNINIT;
     }
@@ -277,7 +2057,7 @@ I2CTaskState I2CGetTaskState()
     {
         return I2C_TASK_RESET;
     }
-    else if(osMessageQueueGetCount(i2c1DataQueue) == I2C_DATA_QUEUE_SIZE)
+    else if(i2cFrameQueue[I2C_PRIO_HIGH - I2C_PRIO_NORMAL]._count == I2C_DATA_QUEUE_SIZE)
     {
         return I2C_TASK_QUEUEFULL;
     }
@@ -3,6 +3,29 @@
 #include "main.h"
 
 #include "user_main.h"
+#include "byte_buf.h"
+
+#ifdef USE_BENCH
+
+/**
+ * @brief 处理性能测试查询指令 `#BENCH`, 用于 tools/echo_bench.py 获取堆使用情况
+ * 
+ * @param cmd 接收到的数据
+ * @param printBuf 格式化输出缓冲区
+ * @return ConstBuf* 是查询指令时返回回复数据块 (当前与历史最少的堆空闲空间), 否则返回 NULL
+ */
+ConstBuf* BenchQuery(const ConstBuf* cmd, ByteBuf* printBuf)
+{
+    if(!ConstBuf_EqualStr(cmd, "#BENCH"))
+    {
+        return NULL;
+    }
+
+    ByteBuf_Printf(printBuf, 0, "[BENCH]heap_free=%u,heap_min=%u[BENCH]\r\n", xPortGetFreeHeapSize(), xPortGetMinimumEverFreeHeapSize());
+    return ConstBuf_CreateByBuf(printBuf, 0);
+}
+
+#endif
 
 // UART IO 示例
 #ifdef PROJECT_UART_IO
@@ -12,6 +35,10 @@ void MainLoopTask(void *argument)
 {   
     ConstBuf* resBuf = NULL;
     ByteBuf* printBuf = ByteBuf_Create(128);
+    if(printBuf == NULL)
+    {
+        Error_Handler();
+    }
 
     while(1)
     {
@@ -22,6 +49,16 @@ void MainLoopTask(void *argument)
             Error_Handler();
         }
 
+        #ifdef USE_BENCH
+            ConstBuf* benchBuf = BenchQuery(resBuf, printBuf);
+            if(benchBuf != NULL)
+            {
+                UART1SendData(benchBuf, 100);
+                ConstBuf_Delete(resBuf);
+                continue;
+            }
+        #endif
+
         // 使用 ByteBuf_Printf 函数创建格式化字符
         ByteBuf_Printf(printBuf, 0, "[REC]%s[REC]\r\n", resBuf->_buf);
         // 使用 ConstBuf_CreateByBuf 包裹缓冲区, 进行转换并发送
@@ -47,6 +84,10 @@ void MainLoopTask(void *argument)
 {
     ConstBuf* resBuf = NULL;
     ByteBuf* printBuf = ByteBuf_Create(128);
+    if(printBuf == NULL)
+    {
+        Error_Handler();
+    }
 
     while(1)
     {
@@ -56,6 +97,16 @@ void MainLoopTask(void *argument)
             Error_Handler();
         }
 
+        #ifdef USE_BENCH
+            ConstBuf* benchBuf = BenchQuery(resBuf, printBuf);
+            if(benchBuf != NULL)
+            {
+                USB_VPC_SendData(benchBuf, 100);
+                ConstBuf_Delete(resBuf);
+                continue;
+            }
+        #endif
+
         ByteBuf_Printf(printBuf, 0, "[REC]%s[REC]\r\n", resBuf->_buf);
         USB_VPC_SendData(ConstBuf_CreateByBuf(printBuf, 0), 100);
 
@@ -74,6 +125,8 @@ void MainLoopTask(void *argument)
 #include "user_usb_vpc.h"
 #define SendData USB_VPC_SendData
 #define ReceiveData USB_VPC_ReceiveData
+#define SendFrame USB_VPC_SendFrame
+#define ReceiveFrame USB_VPC_ReceiveFrame
 #define PROJECT_I2C_CMD
 
 #endif 
@@ -83,6 +136,8 @@ void MainLoopTask(void *argument)
 #include "user_uart.h"
 #define SendData UART1SendData
 #define ReceiveData UART1ReceiveData
+#define SendFrame UART1SendFrame
+#define ReceiveFrame UART1ReceiveFrame
 #define PROJECT_I2C_CMD
 
 #endif 
@@ -101,10 +156,26 @@ void MainLoopTask(void *argument)
 // REC D07501 获取 MPU6050 的 I2C 地址 (应当返回 68)
 // SEND D06B00 启用 MPU6050, REC D03B06 获取三轴加速度 (Z 轴, 即末尾四位约为 0X4000u)
 // SEND D06B80 复位 MPU6050, REC D03B06 得到 0 结果
+// 启用 I2C_USE_SAMPLE 时, SAMPLE D03B0E0064 每 100ms 采样一次 MPU6050, SREAD 取出采样结果
+// QSTAT 返回各优先级请求的完成数, 超时数与延迟
+// 启用 I2C_USE_CACHE 时, CACHE D0750101 缓存 MPU6050 的 WHO_AM_I, 之后 REC D07501 不再访问总线; FLUSH D0 回写, CSTAT D0 返回缓存统计
+// 启用 BYTE_BUF_USE_STAT 时, 指令 STATS 将返回缓冲区对象统计
+// 启用 I2C_CMD_USE_FRAMER 时, 每条指令必须以换行 (\n 或 \r\n) 结尾
+// 启用 I2C_CMD_USE_BINARY 时, 改为使用二进制请求 / 回复协议 (见 I2CBinaryProcess), 可由 tools/i2c_client.py 发送
 
 #include "user_i2c.h"
+#include "framer.h"
+#include "command.h"
 #include "string.h"
 
+// 是否将接收到的数据按行重组为指令, 启用时每条指令必须以换行结尾, 一次接收到多条或不完整的指令均可正确处理
+// 默认关闭, 以兼容不发送换行的已有脚本 (此时每次接收到的数据块即为一条指令)
+#define I2C_CMD_USE_FRAMER 0
+// 单条指令的最大长度
+#define I2C_CMD_MAX_LEN 128
+// 是否使用二进制请求 / 回复协议 (基于 bin_frame 数据帧), 取代文本指令
+#define I2C_CMD_USE_BINARY 0
+
 void NormalCallBack(uint8_t is_success)
 {
     if(is_success)
@@ -126,14 +197,17 @@ void RecCallBack(uint8_t is_success, ConstBuf* data)
         printBuf = ByteBuf_Create(64);
     }
 
-    if(is_success)
+    if(is_success && printBuf == NULL)
+    {
+        // 无法分配输出缓冲区, 放弃输出结果
+        ConstBuf_Delete(data);
+    }
+    else if(is_success)
     {
-        ConstBuf* dataHex = ConstBuf_BufToHex(data->_buf, data->_len);
-        ByteBuf_Printf(printBuf, 0, "Rec: %s\r\n", dataHex->_buf);
+        ByteBuf_Printf(printBuf, 0, "Rec: %H\r\n", data);
 
         SendData(ConstBuf_CreateByBuf(printBuf, 0), 100);
         ConstBuf_Delete(data);
-        ConstBuf_Delete(dataHex);
     }
     else
     {
@@ -141,92 +215,485 @@ void RecCallBack(uint8_t is_success, ConstBuf* data)
     }
 }
 
-void MainLoopTask(void *argument)
+#if (BYTE_BUF_USE_STAT == 1)
+
+/**
+ * @brief 处理指令 STATS, 发送缓冲区对象统计 (总体统计, 分配耗时直方图与各创建位置的统计)
+ * 
+ * @param printBuf 格式化输出缓冲区
+ */
+void BufStatReport(ByteBuf* printBuf)
 {
-    ConstBuf* cmdBuf = NULL;
-    ByteBuf* printBuf = ByteBuf_Create(128);
+    BufStat stat;
+    BufStat_Get(&stat);
 
-    ConstBuf* cmdBody = NULL;
-    ConstBuf* cmdArgs = NULL;
+    ByteBuf_Printf(printBuf, 0, "Live: byte=%u const=%u bytes=%u\r\nPeak: num=%u bytes=%u fail=%u\r\n",
+        stat._liveByteBuf, stat._liveConstBuf, stat._liveBytes, stat._peakNum, stat._peakBytes, stat._allocFail);
+    SendData(ConstBuf_CreateByBuf(printBuf, 0), 100);
 
-    while(1)
+    ByteBuf_Printf(printBuf, 0, "Hist:");
+    for(uint32_t i = 0; i < BUF_STAT_HIST_NUM; i++)
     {
-        cmdBuf = ReceiveData(osWaitForever);
-        if(cmdBuf == NULL)
-        {
-            Error_Handler();
-        }
+        ByteBuf_AppendPrintf(printBuf, " %u", stat._allocHist[i]);
+    }
+    ByteBuf_AppendStr(printBuf, "\r\n");
+    SendData(ConstBuf_CreateByBuf(printBuf, 0), 100);
 
-        ByteBuf_Printf(printBuf, 1, "[REC]%s[REC]\r\n", cmdBuf->_buf);
-        if(CommandResolveText(cmdBuf, &cmdBody, &cmdArgs))
+    BufStatSite site;
+    for(uint32_t i = 0; i < BUF_STAT_SITE_NUM; i++)
+    {
+        if(BufStat_GetSite(i, &site))
         {
-            if(strcmp((const char *)cmdBody->_buf, "SEND") == 0)
-            {
-                if(cmdArgs->_len < 3)
-                {
-                    ByteBuf_Printf(printBuf, 0, "Incorrect Args: %u\r\n", cmdArgs->_len);
-                }
-                else
-                {
-                    I2CSendData(
-                        cmdArgs->_buf[0],
-                        cmdArgs->_buf[1],
-                        ConstBuf_CreateExtBuf(cmdArgs->_buf, cmdArgs->_len, 2, 0, 0),
-                        NormalCallBack,
-                        osWaitForever
-                    );
-                    ByteBuf_Printf(printBuf, 0, "%sSend Done\r\n", printBuf->_buf);                    
-                }
-            }
-            else if(strcmp((const char *)cmdBody->_buf, "REC") == 0)
+            // 仅输出源文件名, 合并统计的其他位置输出为 *
+            const char* file = "*";
+            if(site._file != NULL)
             {
-                if(cmdArgs->_len != 3)
-                {
-                    ByteBuf_Printf(printBuf, 0, "Incorrect Args: %u\r\n", cmdArgs->_len);
-                }
-                else
-                {
-                    I2CRecData(
-                        cmdArgs->_buf[0],
-                        cmdArgs->_buf[1],
-                        cmdArgs->_buf[2],
-                        RecCallBack,
-                        osWaitForever
-                    );
-                    ByteBuf_Printf(printBuf, 0, "%sRec Done\r\n", printBuf->_buf);
-                }
+                file = strrchr(site._file, '/');
+                file = (file != NULL) ? file + 1 : site._file;
             }
-            else if(strcmp((const char *)cmdBody->_buf, "TOUCH") == 0)
+            ByteBuf_Printf(printBuf, 0, "Site %s:%u: live=%u bytes=%u peak=%u\r\n",
+                file, site._line, site._liveNum, site._liveBytes, site._peakBytes);
+            SendData(ConstBuf_CreateByBuf(printBuf, 0), 100);
+        }
+    }
+}
+
+#endif
+
+// 指令 SEND, 参数为 [设备地址][寄存器地址][发送数据]...
+void CommandSend(ConstBuf* args, ByteBuf* printBuf)
+{
+    I2CSendData(
+        args->_buf[0],
+        args->_buf[1],
+        ConstBuf_Slice(args, 2, 0),
+        NormalCallBack,
+        osWaitForever
+    );
+    ByteBuf_AppendStr(printBuf, "Send Done\r\n");
+}
+
+// 指令 REC, 参数为 [设备地址][寄存器地址][接收长度]
+void CommandRec(ConstBuf* args, ByteBuf* printBuf)
+{
+    I2CRecData(
+        args->_buf[0],
+        args->_buf[1],
+        args->_buf[2],
+        RecCallBack,
+        osWaitForever
+    );
+    ByteBuf_AppendStr(printBuf, "Rec Done\r\n");
+}
+
+// 指令 TOUCH, 参数为 [设备地址][尝试次数]
+void CommandTouch(ConstBuf* args, ByteBuf* printBuf)
+{
+    I2CTouch(
+        args->_buf[0],
+        args->_buf[1],
+        NormalCallBack,
+        osWaitForever
+    );
+    ByteBuf_AppendStr(printBuf, "Touch Done\r\n");
+}
+
+#if (BYTE_BUF_USE_STAT == 1)
+
+// 指令 STATS, 无参数
+void CommandStats(ConstBuf* args, ByteBuf* printBuf)
+{
+    (void)args;
+
+    // 统计报告将覆盖输出缓冲区, 因此先发送回显
+    SendData(ConstBuf_CreateByBuf(printBuf, 0), 100);
+    BufStatReport(printBuf);
+    ByteBuf_Printf(printBuf, 0, "Stats Done\r\n");
+}
+
+#endif
+
+#if (I2C_USE_STAT == 1)
+
+// 指令 I2CSTAT, 无参数, 返回任务帧之间的总线空闲时间 (周期数)
+void CommandI2CStat(ConstBuf* args, ByteBuf* printBuf)
+{
+    (void)args;
+
+    I2CStat stat;
+    I2CGetStat(&stat);
+    ByteBuf_AppendPrintf(printBuf, "Frame: %u Idle: num=%u min=%u max=%u avg=%u\r\n",
+        stat._frameNum, stat._idleNum, stat._idleMin, stat._idleMax, (stat._idleNum == 0) ? 0 : stat._idleSum / stat._idleNum);
+}
+
+#endif
+
+#if (I2C_USE_CACHE == 1)
+
+// 指令 CACHE, 参数为 [设备地址][起始寄存器地址][寄存器数][缓存策略], 策略 0 ~ 3 依次为不缓存, 可缓存, 写直达, 写回
+void CommandCache(ConstBuf* args, ByteBuf* printBuf)
+{
+    if(I2CCacheSetPolicy(args->_buf[0], args->_buf[1], args->_buf[2], (I2CCachePolicy)args->_buf[3]))
+    {
+        ByteBuf_AppendStr(printBuf, "Cache Done\r\n");
+    }
+    else
+    {
+        ByteBuf_AppendStr(printBuf, "Cache Fail\r\n");
+    }
+}
+
+// 指令 CSTAT, 参数为 [设备地址], 返回寄存器缓存统计
+void CommandCacheStat(ConstBuf* args, ByteBuf* printBuf)
+{
+    I2CCacheStat stat;
+    if(I2CCacheGetStat(args->_buf[0], &stat))
+    {
+        ByteBuf_AppendPrintf(printBuf, "Hit: %u Miss: %u Skip: %u Defer: %u Flush: %u\r\n",
+            stat._hitNum, stat._missNum, stat._skipNum, stat._deferNum, stat._flushNum);
+    }
+    else
+    {
+        ByteBuf_AppendStr(printBuf, "No Cache\r\n");
+    }
+}
+
+// 指令 FLUSH, 参数为 [设备地址], 将写回寄存器的脏数据写入设备
+void CommandFlush(ConstBuf* args, ByteBuf* printBuf)
+{
+    if(I2CCacheFlush(args->_buf[0], NormalCallBack, osWaitForever) == osOK)
+    {
+        ByteBuf_AppendStr(printBuf, "Flush Done\r\n");
+    }
+    else
+    {
+        ByteBuf_AppendStr(printBuf, "Flush Fail\r\n");
+    }
+}
+
+#endif
+
+// 指令 QSTAT, 无参数, 逐行发送各优先级的完成数, 超时数与延迟 (ms)
+void CommandQueueStat(ConstBuf* args, ByteBuf* printBuf)
+{
+    (void)args;
+
+    // 统计报告将覆盖输出缓冲区, 因此先发送回显
+    SendData(ConstBuf_CreateByBuf(printBuf, 0), 100);
+
+    I2CClassStat stat;
+    for(int32_t prio = I2C_PRIO_HIGH; prio >= I2C_PRIO_LOW; prio--)
+    {
+        I2CGetClassStat((I2CPriority)prio, &stat);
+        ByteBuf_Printf(printBuf, 0, "P%d: done=%u timeout=%u lat_max=%u lat_avg=%u\r\n",
+            prio, stat._doneNum, stat._timeoutNum, stat._latMax, (stat._doneNum == 0) ? 0 : stat._latSum / stat._doneNum);
+        if(prio != I2C_PRIO_LOW)
+        {
+            SendData(ConstBuf_CreateByBuf(printBuf, 0), 100);
+        }
+    }
+}
+
+#if (I2C_USE_SAMPLE == 1)
+
+// 指令 SAMPLE, 参数为 [设备地址][寄存器地址][读取长度][周期高字节][周期低字节], 周期单位为 ms
+void CommandSample(ConstBuf* args, ByteBuf* printBuf)
+{
+    int32_t job = I2CSampleAdd(args->_buf[0], args->_buf[1], args->_buf[2], (args->_buf[3] << 8) | args->_buf[4]);
+    ByteBuf_AppendPrintf(printBuf, "Sample Job: %d\r\n", job);
+}
+
+// 指令 SREAD, 无参数, 逐行发送采样环形缓冲区中的全部结果与各采样任务的统计
+void CommandSampleRead(ConstBuf* args, ByteBuf* printBuf)
+{
+    (void)args;
+
+    // 统计报告将覆盖输出缓冲区, 因此先发送回显
+    SendData(ConstBuf_CreateByBuf(printBuf, 0), 100);
+
+    I2CSample samples[4];
+    size_t num = 0;
+    while((num = I2CSampleRead(samples, 4)) > 0)
+    {
+        for(size_t i = 0; i < num; i++)
+        {
+            ByteBuf_Printf(printBuf, 0, "%u J%u ", samples[i]._tick, samples[i]._job);
+            ByteBuf_AppendHex(printBuf, samples[i]._data, samples[i]._len);
+            ByteBuf_AppendStr(printBuf, "\r\n");
+            SendData(ConstBuf_CreateByBuf(printBuf, 0), 100);
+        }
+    }
+
+    I2CSampleStat stat;
+    for(int32_t i = 0; i < I2C_SAMPLE_JOB_NUM; i++)
+    {
+        if(I2CSampleGetStat(i, &stat))
+        {
+            ByteBuf_Printf(printBuf, 0, "J%d: num=%u fail=%u miss=%u late_max=%u late_sum=%u\r\n",
+                i, stat._sampleNum, stat._failNum, stat._missNum, stat._lateMax, stat._lateSum);
+            SendData(ConstBuf_CreateByBuf(printBuf, 0), 100);
+        }
+    }
+    ByteBuf_Printf(printBuf, 0, "Drop: %u\r\n", I2CSampleGetDropNum());
+}
+
+#endif
+
+// 指令表, 必须按指令名的字节序排列, 新增指令时只需在此添加表项
+// 参数范围为解码后的字节数
+static const CommandEntry cmdTable[] = {
+#if (I2C_USE_CACHE == 1)
+    {"CACHE",   4,  4,      CommandCache},
+    {"CSTAT",   1,  1,      CommandCacheStat},
+    {"FLUSH",   1,  1,      CommandFlush},
+#endif
+#if (I2C_USE_STAT == 1)
+    {"I2CSTAT", 0,  0,      CommandI2CStat},
+#endif
+    {"QSTAT",   0,  0,      CommandQueueStat},
+    {"REC",     3,  3,      CommandRec},
+#if (I2C_USE_SAMPLE == 1)
+    {"SAMPLE",  5,  5,      CommandSample},
+#endif
+    {"SEND",    3,  255,    CommandSend},
+#if (I2C_USE_SAMPLE == 1)
+    {"SREAD",   0,  0,      CommandSampleRead},
+#endif
+#if (BYTE_BUF_USE_STAT == 1)
+    {"STATS",   0,  0,      CommandStats},
+#endif
+    {"TOUCH",   2,  2,      CommandTouch},
+};
+
+/**
+ * @brief 解析并执行一条指令, 并发送执行结果
+ * 
+ * @param cmdBuf 指令
+ * @param printBuf 格式化输出缓冲区
+ */
+void CommandProcess(ConstBuf* cmdBuf, ByteBuf* printBuf)
+{
+    size_t argLen = 0;
+    size_t errPos = 0;
+
+    ByteBuf_Printf(printBuf, 0, "[REC]%s[REC]\r\n", cmdBuf->_buf);
+    switch(Command_Dispatch(cmdTable, sizeof(cmdTable) / sizeof(cmdTable[0]), cmdBuf, printBuf, &argLen, &errPos))
+    {
+    case COMMAND_OK:
+        break;
+    case COMMAND_UNKNOWN:
+        ByteBuf_AppendStr(printBuf, "Unknown Body\r\n");
+        break;
+    case COMMAND_BAD_ARGS:
+        ByteBuf_AppendPrintf(printBuf, "Incorrect Args: %u\r\n", argLen);
+        break;
+    case COMMAND_NO_MEMORY:
+        ByteBuf_AppendStr(printBuf, "No Memory\r\n");
+        break;
+    default:
+        ByteBuf_AppendPrintf(printBuf, "Unknown CMD: %u\r\n", errPos);
+        break;
+    }
+
+    SendData(ConstBuf_CreateByBuf(printBuf, 0), 100);
+}
+
+#if (I2C_CMD_USE_BINARY == 1)
+
+// 二进制请求 (数据帧中的数据) 格式为 [编号低字节][编号高字节][操作码][设备地址][寄存器地址][参数]...
+// 其中 REC 的参数为 [接收长度], SEND 的参数为发送数据, TOUCH 的寄存器地址为尝试次数
+// 回复格式为 [编号低字节][编号高字节][操作码][状态][数据]..., 其中 REC 成功时数据为接收到的数据
+// 请求进入 I2C 任务队列后立即处理下一个请求, 因此可同时有多个请求等待执行, 主机通过编号匹配回复
+
+/// @brief 二进制协议操作码
+typedef enum I2CBINOP
+{
+    // 不访问 I2C, 立即回复, 用于测试协议开销
+    I2C_BIN_OP_PING = 0,
+    I2C_BIN_OP_SEND = 1,
+    I2C_BIN_OP_REC = 2,
+    I2C_BIN_OP_TOUCH = 3
+} I2CBinOp;
+
+/// @brief 二进制协议回复状态
+typedef enum I2CBINSTATUS
+{
+    I2C_BIN_OK = 0,
+    // I2C 操作失败
+    I2C_BIN_FAIL = 1,
+    // 请求格式错误
+    I2C_BIN_BAD_REQUEST = 2
+} I2CBinStatus;
+
+// 二进制请求头长度
+#define I2C_BIN_HEAD_SIZE 5
+
+/**
+ * @brief 发送二进制回复
+ * 
+ * @param id 请求编号
+ * @param op 操作码
+ * @param status 回复状态
+ * @param data 回复数据, 可为 NULL
+ * @param len 回复数据长度
+ */
+void I2CBinaryReply(uint16_t id, uint8_t op, uint8_t status, const uint8_t* data, size_t len)
+{
+    ConstBuf* reply = ConstBuf_CreateEmpty(4 + len);
+    if(reply == NULL)
+    {
+        return;
+    }
+    reply->_buf[0] = id & 0xFF;
+    reply->_buf[1] = id >> 8;
+    reply->_buf[2] = op;
+    reply->_buf[3] = status;
+    if(len > 0)
+    {
+        memcpy(reply->_buf + 4, data, len);
+    }
+    SendFrame(reply, 100);
+}
+
+// I2C 请求完成回调, 上下文中保存请求编号 (低 16 位) 与操作码 (高 16 位)
+void I2CBinaryCallBack(uint8_t is_success, ConstBuf* data, void* ctx)
+{
+    uint32_t tag = (uint32_t)ctx;
+
+    if(data != NULL)
+    {
+        I2CBinaryReply(tag & 0xFFFF, tag >> 16, I2C_BIN_OK, data->_buf, data->_len);
+        ConstBuf_Delete(data);
+    }
+    else
+    {
+        I2CBinaryReply(tag & 0xFFFF, tag >> 16, is_success ? I2C_BIN_OK : I2C_BIN_FAIL, NULL, 0);
+    }
+}
+
+/**
+ * @brief 解析并提交一个二进制请求
+ * 
+ * @param reqBuf 二进制请求
+ */
+void I2CBinaryProcess(ConstBuf* reqBuf)
+{
+    if(reqBuf->_len < I2C_BIN_HEAD_SIZE)
+    {
+        I2CBinaryReply(0xFFFF, 0xFF, I2C_BIN_BAD_REQUEST, NULL, 0);
+        return;
+    }
+
+    uint16_t id = reqBuf->_buf[0] | (reqBuf->_buf[1] << 8);
+    uint8_t op = reqBuf->_buf[2];
+    size_t argLen = reqBuf->_len - I2C_BIN_HEAD_SIZE;
+
+    I2CRequest req = {
+        ._daddr = reqBuf->_buf[3],
+        ._raddr = reqBuf->_buf[4],
+        ._data = NULL,
+        ._len = 0,
+        ._callBack = I2CBinaryCallBack,
+        ._ctx = (void*)(id | ((uint32_t)op << 16))
+    };
+
+    switch(op)
+    {
+    case I2C_BIN_OP_PING:
+        I2CBinaryReply(id, op, I2C_BIN_OK, NULL, 0);
+        return;
+    case I2C_BIN_OP_SEND:
+        if(argLen == 0)
+        {
+            break;
+        }
+        req._actType = I2C_ACT_SEND;
+        req._data = ConstBuf_Slice(reqBuf, I2C_BIN_HEAD_SIZE, 0);
+        I2CSubmit(&req, osWaitForever);
+        return;
+    case I2C_BIN_OP_REC:
+        if(argLen != 1 || reqBuf->_buf[I2C_BIN_HEAD_SIZE] == 0)
+        {
+            break;
+        }
+        req._actType = I2C_ACT_REC;
+        req._len = reqBuf->_buf[I2C_BIN_HEAD_SIZE];
+        I2CSubmit(&req, osWaitForever);
+        return;
+    case I2C_BIN_OP_TOUCH:
+        req._actType = I2C_ACT_TOUCH;
+        I2CSubmit(&req, osWaitForever);
+        return;
+    default:
+        break;
+    }
+
+    I2CBinaryReply(id, op, I2C_BIN_BAD_REQUEST, NULL, 0);
+}
+
+#endif
+
+void MainLoopTask(void *argument)
+{
+    #if (I2C_CMD_USE_BINARY == 1)
+        while(1)
+        {
+            ConstBuf* reqBuf = ReceiveFrame(osWaitForever);
+            if(reqBuf != NULL)
             {
-                if(cmdArgs->_len != 2)
-                {
-                    ByteBuf_Printf(printBuf, 0, "Incorrect Args: %u\r\n", cmdArgs->_len);
-                }
-                else
-                {
-                    I2CTouch(
-                        cmdArgs->_buf[0],
-                        cmdArgs->_buf[1],
-                        NormalCallBack,
-                        osWaitForever
-                    );
-                    ByteBuf_Printf(printBuf, 0, "%sTouch Done\r\n", printBuf->_buf);                    
-                }
+                I2CBinaryProcess(reqBuf);
+                ConstBuf_Delete(reqBuf);
             }
             else
             {
-                ByteBuf_Printf(printBuf, 0, "%sUnknown Body\r\n", printBuf->_buf);
+                // 永久等待时返回 NULL 说明无法分配帧缓冲区, 稍后重试
+                osDelay(10);
             }
+        }
+    #endif
+
+    ConstBuf* cmdBuf = NULL;
+    ByteBuf* printBuf = ByteBuf_Create(128);
+    if(printBuf == NULL)
+    {
+        Error_Handler();
+    }
 
-            ConstBuf_Delete(cmdBody);
-            ConstBuf_Delete(cmdArgs);
+    #if (I2C_CMD_USE_FRAMER == 1)
+        Framer cmdFramer;
+        if(!Framer_Init(&cmdFramer, FRAMER_LINE, I2C_CMD_MAX_LEN))
+        {
+            Error_Handler();
         }
-        else
+    #endif
+
+    while(1)
+    {
+        cmdBuf = ReceiveData(osWaitForever);
+        if(cmdBuf == NULL)
         {
-            ByteBuf_Printf(printBuf, 0, "%sUnknown CMD\r\n", printBuf->_buf);
+            Error_Handler();
         }
 
-        SendData(ConstBuf_CreateByBuf(printBuf, 0), 100);
+        #if (I2C_CMD_USE_FRAMER == 1)
+            // 接收到的数据可能包含多条或不完整的指令, 逐行取出完整的指令
+            // 接收时作为字符串末尾补充的 \0 不属于数据流
+            const uint8_t* data = cmdBuf->_buf;
+            size_t len = cmdBuf->_len;
+            if(len > 0 && data[len - 1] == 0)
+            {
+                len--;
+            }
+
+            ConstBuf* frame = NULL;
+            while((frame = Framer_Push(&cmdFramer, &data, &len)) != NULL)
+            {
+                CommandProcess(frame, printBuf);
+                ConstBuf_Delete(frame);
+            }
+        #else
+            CommandProcess(cmdBuf, printBuf);
+        #endif
 
         ConstBuf_Delete(cmdBuf);
         cmdBuf = NULL;
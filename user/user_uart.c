@@ -8,6 +8,10 @@
 
 #include "user_uart.h"
 #include "byte_buf.h"
+#include "rx_ring.h"
+#include "buf_ring.h"
+#include "bin_frame.h"
+#include "task_signal.h"
 
 //********** UART1 发送管理 **********//
 
@@ -16,25 +20,120 @@ const uint32_t UART1_SEND_QUEUE_SIZE = 8;
 // 发送等待时长
 const uint32_t UART1_SEND_TIMEOUT = HAL_MAX_DELAY;
 // 是否使用 DMA 进行发送
-#define UART1_SEND_USE_DMA 0
+#define UART1_SEND_USE_DMA 1
+// 是否将发送队列中的多个数据块合并到暂存区后一次发送
+#define UART1_SEND_USE_BATCH 1
+// 合并发送暂存区长度, 超过该长度的数据块将单独直接发送
+#define UART1_SEND_BATCH_SIZE 256
+// 单次合并的最多数据块数
+#define UART1_SEND_BATCH_MAX_NUM 16
+// 合并等待时长 (tick), 暂存区未满时, 自取出第一个数据块起最多等待该时长以合并后续数据块
+const uint32_t UART1_SEND_BATCH_WAIT = 2;
+// 发送暂存区数量, 使用 DMA 时, 一个暂存区发送的同时, 发送任务可准备另一个暂存区
+// 发送完成中断仅保存一个待发送暂存区 (uart1SendNext), 因此只能为 2
+#define UART1_SEND_SLOT_NUM 2
+
+#if (UART1_SEND_SLOT_NUM != 2)
+#error "UART1_SEND_SLOT_NUM must be 2, only one pending slot is kept for the DMA complete interrupt"
+#endif
 
 // 发送数据暂存队列 (以暂存的常量数据块为元素)
 osMessageQueueId_t uart1SendQueue = NULL;
 
+/// @brief UART 发送暂存区
+typedef struct UARTSENDSLOT
+{
+    // 合并发送缓冲区
+    uint8_t _buf[UART1_SEND_BATCH_SIZE];
+    // 实际发送的数据, 指向合并发送缓冲区或单独发送的数据块
+    uint8_t* _data;
+    // 实际发送的数据长度
+    size_t _len;
+    // 该暂存区包含的数据块, 将在发送完成后删除
+    ConstBuf* _list[UART1_SEND_BATCH_MAX_NUM];
+    // 该暂存区包含的数据块数
+    size_t _num;
+} UARTSendSlot;
+
+UARTSendSlot uart1SendSlot[UART1_SEND_SLOT_NUM];
+// 暂存区发送完成信号 (计数信号, 每发送完成一个暂存区发出一次)
+TaskSignal uart1SendSlotDone;
+
 #if (UART1_SEND_USE_DMA == 1)
-// 发送完成信号
-osSemaphoreId_t uart1SendDone = NULL;
+// 正在发送的暂存区
+UARTSendSlot* volatile uart1SendActive = NULL;
+// 已准备好, 等待在当前发送完成后立即发送的暂存区
+UARTSendSlot* volatile uart1SendNext = NULL;
 
-// 数据发送完成回调
+// 数据发送完成回调, 若下一个暂存区已准备好, 则在中断中立即开始发送
 void UART1SendCmpltCallBack(UART_HandleTypeDef *huart)
 {
-    if(uart1SendDone != NULL)
+    UARTSendSlot* next = uart1SendNext;
+    uart1SendNext = NULL;
+    uart1SendActive = next;
+
+    if(next != NULL)
     {
-        osSemaphoreRelease(uart1SendDone);
+        if(HAL_UART_Transmit_DMA(&huart1, next->_data, next->_len) != HAL_OK)
+        {
+            Error_Handler();
+        }
     }
+
+    TaskSignal_Post(&uart1SendSlotDone);
 }
 #endif
 
+/**
+ * @brief 提交已准备好的暂存区进行发送
+ * 
+ * @param slot 已准备好的暂存区
+ * @note 使用 DMA 时, 若当前没有正在进行的发送则立即开始, 否则由发送完成回调接续发送; 不使用 DMA 时阻塞发送
+ */
+void UART1SendCommit(UARTSendSlot* slot)
+{
+    #if (UART1_SEND_USE_DMA == 1)
+        uint8_t isIdle = 0;
+
+        taskENTER_CRITICAL();
+        if(uart1SendActive == NULL)
+        {
+            uart1SendActive = slot;
+            isIdle = 1;
+        }
+        else
+        {
+            uart1SendNext = slot;
+        }
+        taskEXIT_CRITICAL();
+
+        if(isIdle && HAL_UART_Transmit_DMA(&huart1, slot->_data, slot->_len) != HAL_OK)
+        {
+            Error_Handler();
+        }
+    #else
+        if(HAL_UART_Transmit(&huart1, slot->_data, slot->_len, UART1_SEND_TIMEOUT) != HAL_OK)
+        {
+            Error_Handler();
+        } 
+        TaskSignal_Post(&uart1SendSlotDone);
+    #endif
+}
+
+/**
+ * @brief 回收一个已发送完成的暂存区, 并删除其中的数据块 (同时释放其绑定的信号量)
+ * 
+ * @param slot 暂存区
+ */
+void UART1SendReclaim(UARTSendSlot* slot)
+{
+    for(size_t i = 0; i < slot->_num; i++)
+    {
+        ConstBuf_Delete(slot->_list[i]);
+    }
+    slot->_num = 0;
+}
+
 // 数据发送管理任务
 void UART1SendTask(void* args)
 {
@@ -42,42 +141,100 @@ void UART1SendTask(void* args)
     ConstBuf* sendData = NULL;
 
     uart1SendQueue = osMessageQueueNew(UART1_SEND_QUEUE_SIZE, sizeof(ConstBuf*), NULL);
-    
+    TaskSignal_Bind(&uart1SendSlotDone);
+
     // 注册发送完成回调函数
     #if (UART1_SEND_USE_DMA == 1)
-        uart1SendDone = osSemaphoreNew(1, 0, NULL);
         HAL_UART_RegisterCallback(&huart1, HAL_UART_TX_COMPLETE_CB_ID, &UART1SendCmpltCallBack);
     #endif
 
+    // 暂存区按提交顺序发送完成, 因此按相同顺序回收
+    uint32_t fillIdx = 0;
+    uint32_t reclaimIdx = 0;
+    uint32_t busyNum = 0;
+
     while(1)
     {
-        // 等待发送队列中插入数据
-        osMessageQueueGet(uart1SendQueue, &sendData, NULL, osWaitForever);
+        // 回收所有已发送完成的暂存区
+        while(busyNum > 0 && TaskSignal_Pend(&uart1SendSlotDone, 0))
+        {
+            UART1SendReclaim(&uart1SendSlot[reclaimIdx]);
+            reclaimIdx = (reclaimIdx + 1) % UART1_SEND_SLOT_NUM;
+            busyNum--;
+        }
 
-        // 使用 HAL 提供的方法发送数据
-        #if (UART1_SEND_USE_DMA == 1)
-            if(HAL_UART_Transmit_DMA(&huart1, sendData->_buf, sendData->_len) != HAL_OK)
+        // 等待发送队列中插入数据 (上一轮未能合并的数据块将留到本轮发送)
+        // 仍有暂存区在发送时, 定期返回以及时回收
+        if(sendData == NULL)
+        {
+            if(osMessageQueueGet(uart1SendQueue, &sendData, NULL, busyNum > 0 ? 1 : osWaitForever) != osOK)
             {
-                Error_Handler();
+                sendData = NULL;
+                continue;
             }
-            // 等待发送完成
-            osSemaphoreAcquire(uart1SendDone, UART1_SEND_TIMEOUT);            
-        #else
-            if(HAL_UART_Transmit(&huart1, sendData->_buf, sendData->_len, UART1_SEND_TIMEOUT) != HAL_OK)
+        }
+
+        // 所有暂存区均在发送时, 等待最早提交的暂存区发送完成
+        if(busyNum == UART1_SEND_SLOT_NUM)
+        {
+            TaskSignal_Pend(&uart1SendSlotDone, osWaitForever);
+            UART1SendReclaim(&uart1SendSlot[reclaimIdx]);
+            reclaimIdx = (reclaimIdx + 1) % UART1_SEND_SLOT_NUM;
+            busyNum--;
+        }
+
+        UARTSendSlot* slot = &uart1SendSlot[fillIdx];
+        fillIdx = (fillIdx + 1) % UART1_SEND_SLOT_NUM;
+        busyNum++;
+
+        // 不合并或超过暂存区长度的数据块直接发送
+        if(UART1_SEND_USE_BATCH == 0 || sendData->_len > UART1_SEND_BATCH_SIZE)
+        {
+            slot->_data = sendData->_buf;
+            slot->_len = sendData->_len;
+            slot->_list[0] = sendData;
+            slot->_num = 1;
+            sendData = NULL;
+
+            UART1SendCommit(slot);
+            continue;
+        }
+
+        // 将数据块依次复制到暂存区, 直到暂存区放不下, 或等待超时
+        uint32_t batchBeg = osKernelGetTickCount();
+        slot->_data = slot->_buf;
+        slot->_len = 0;
+
+        while(sendData != NULL && slot->_len + sendData->_len <= UART1_SEND_BATCH_SIZE && slot->_num < UART1_SEND_BATCH_MAX_NUM)
+        {
+            memcpy(slot->_buf + slot->_len, sendData->_buf, sendData->_len);
+            slot->_len += sendData->_len;
+            slot->_list[slot->_num] = sendData;
+            slot->_num++;
+            sendData = NULL;
+
+            // 取出下一个数据块, 队列为空时最多等待到合并时限
+            uint32_t passed = osKernelGetTickCount() - batchBeg;
+            uint32_t wait = (passed < UART1_SEND_BATCH_WAIT) ? (UART1_SEND_BATCH_WAIT - passed) : 0;
+            if(osMessageQueueGet(uart1SendQueue, &sendData, NULL, wait) != osOK)
             {
-                Error_Handler();
-            } 
-        #endif
+                sendData = NULL;
+            }
+        }
 
-        // 删除已发送数据块
-        ConstBuf_Delete(sendData);
+        UART1SendCommit(slot);
     }
 }
 
 osStatus_t UART1SendData(ConstBuf* data, uint32_t timeout)
 {
+    if(data == NULL)
+    {
+        return osErrorNoMemory;
+    }
     if(uart1SendQueue == NULL)
     {
+        ConstBuf_Delete(data);
         return osError;
     }
 
@@ -91,6 +248,13 @@ osStatus_t UART1SendData(ConstBuf* data, uint32_t timeout)
     return res;
 }
 
+osStatus_t UART1SendFrame(ConstBuf* data, uint32_t timeout)
+{
+    ConstBuf* frame = BinFrame_Encode(data->_buf, data->_len);
+    ConstBuf_Delete(data);
+    return UART1SendData(frame, timeout);
+}
+
 UARTSendState UART1SendGetState()
 {
     if(uart1SendQueue == NULL)
@@ -117,51 +281,262 @@ UARTSendState UART1SendGetState()
 
 //********** UART1 接收管理 **********//
 
-// 结果数据块队列长度
-const uint32_t UART1_RECEIVE_QUEUE_SIZE = 8;
+// 结果数据块队列长度, 必须为 2 的幂
+#define UART1_RECEIVE_QUEUE_SIZE 8
 // 读取缓冲区长度
-const uint32_t UART1_RECEIVE_BUF_SIZE = 256;
-// 是否将结果作为字符串处理
+#define UART1_RECEIVE_BUF_SIZE 256
+// 是否将结果作为字符串处理, 是则总是在数据块末尾补充一个 \0
 const uint8_t UART1_RECEIVE_AS_STRING = 1;
+// 无法分配结果数据块而丢弃的数据块数
+volatile uint32_t uart1RecAllocFailNum = 0;
 // 接收后插入接收队列的等待时长
 const uint32_t UART1_RECEIVE_TIMEOUT = HAL_MAX_DELAY;
 // 是否使用 DMA 进行接收
 #define UART1_REC_USE_DMA 1
+// 是否使用零复制接收 (接收缓冲区轮转使用, 并直接借给接收者)
+#define UART1_REC_ZERO_COPY 1
+// 是否使用循环 DMA 与环形缓冲区持续接收, 启用时将忽略以上两项 (需在 CubeMX 中将 USART1_RX 的 DMA 设为 Circular 模式)
+// 两种模式不能组合: 环形模式下 DMA 不停止, 没有重新启动的空窗期, 但接收者需要复制数据;
+// 零复制模式 (默认) 不复制数据, 但每次空闲后需重新启动 DMA, 重新启动前到达的数据可能丢失
+#define UART1_REC_USE_RING 0
+
+#if (UART1_REC_USE_RING == 1)
+
+// 环形接收缓冲区长度
+#define UART1_RECEIVE_RING_SIZE 512
+
+// 环形接收缓冲区 (DMA 循环写入区域)
+uint8_t uart1RecRingBuf[UART1_RECEIVE_RING_SIZE];
+RxRing uart1RecRing;
+// 有新数据到达信号, 信号值为新数据的字节数, 由等待数据的接收者绑定
+TaskSignal uart1RecReady;
+// 接收错误信号, 信号值为 TASK_SIGNAL_ERROR 与 HAL 错误码
+TaskSignal uart1RecError;
+// 接收错误次数
+volatile uint32_t uart1RecErrorNum = 0;
+
+// 半满, 全满与空闲事件回调函数, 函数的第二个参数为 DMA 当前写入位置
+void UART1ReceiveEventCallBack(UART_HandleTypeDef *huart, uint16_t pos)
+{
+    size_t newNum = RxRing_Produce(&uart1RecRing, pos);
+    if(newNum > 0)
+    {
+        TaskSignal_Give(&uart1RecReady, newNum);
+    }
+}
+
+// 接收错误回调函数, HAL 将在错误时终止 DMA 接收, 由接收任务重新启动
+void UART1ReceiveErrorCallBack(UART_HandleTypeDef *huart)
+{
+    uart1RecErrorNum++;
+    TaskSignal_Give(&uart1RecError, TASK_SIGNAL_ERROR | huart->ErrorCode);
+}
+
+void UART1ReceiveTask(void* args)
+{
+    // 环形接收要求 DMA 工作在循环模式
+    if(huart1.hdmarx == NULL || huart1.hdmarx->Init.Mode != DMA_CIRCULAR)
+    {
+        Error_Handler();
+    }
+
+    RxRing_Init(&uart1RecRing, uart1RecRingBuf, UART1_RECEIVE_RING_SIZE);
+    TaskSignal_Bind(&uart1RecError);
+    HAL_UART_RegisterRxEventCallback(&huart1, &UART1ReceiveEventCallBack);
+    HAL_UART_RegisterCallback(&huart1, HAL_UART_ERROR_CB_ID, &UART1ReceiveErrorCallBack);
+
+    while(1)
+    {
+        // 启动循环 DMA 接收, 此后接收不会停止, 直到发生错误
+        if(HAL_UARTEx_ReceiveToIdle_DMA(&huart1, uart1RecRingBuf, UART1_RECEIVE_RING_SIZE) != HAL_OK)
+        {
+            Error_Handler();
+        }
+
+        // 等待接收错误, 并重新启动接收
+        TaskSignal_Wait(&uart1RecError, osWaitForever, NULL);
+        HAL_UART_AbortReceive(&huart1);
+
+        // DMA 将从缓冲区起点重新写入, 保留未读数据, 以及错误前已写入但还没有产生事件的数据
+        size_t newNum = RxRing_Restart(&uart1RecRing, UART1_RECEIVE_RING_SIZE - __HAL_DMA_GET_COUNTER(huart1.hdmarx));
+        if(newNum > 0)
+        {
+            TaskSignal_Give(&uart1RecReady, newNum);
+        }
+    }
+}
+
+/**
+ * @brief 等待环形接收缓冲区中有未读数据
+ * 
+ * @param timeout 每次等待新数据信号的时间
+ * @return uint8_t 有未读数据时返回 1, 超时返回 0
+ */
+uint8_t UART1ReceiveWait(uint32_t timeout)
+{
+    if(uart1RecRing._buf == NULL)
+    {
+        return 0;
+    }
+
+    // 先绑定再检查未读数据, 之后到达的数据一定会唤醒当前任务
+    if(uart1RecReady._task != xTaskGetCurrentTaskHandle())
+    {
+        TaskSignal_Bind(&uart1RecReady);
+    }
+    while(RxRing_GetCount(&uart1RecRing) == 0)
+    {
+        if(!TaskSignal_Wait(&uart1RecReady, timeout, NULL))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+ConstBuf* UART1ReceiveData(uint32_t timeout)
+{
+    ConstBuf* tmpResBuf = NULL;
+    size_t len = 0;
+    while(tmpResBuf == NULL)
+    {
+        if(!UART1ReceiveWait(timeout))
+        {
+            return NULL;
+        }
+
+        // 每个数据块最多包含 UART1_RECEIVE_BUF_SIZE 字节
+        len = RxRing_GetCount(&uart1RecRing);
+        if(len > UART1_RECEIVE_BUF_SIZE)
+        {
+            len = UART1_RECEIVE_BUF_SIZE;
+        }
+
+        // 无法分配数据块时丢弃这部分数据并计数, 继续等待之后的数据
+        tmpResBuf = ConstBuf_CreateEmpty(UART1_RECEIVE_AS_STRING ? len + 1 : len);
+        if(tmpResBuf == NULL)
+        {
+            RxRing_Skip(&uart1RecRing, len);
+            uart1RecAllocFailNum++;
+        }
+    }
+
+    tmpResBuf->_len = RxRing_Read(&uart1RecRing, tmpResBuf->_buf, len);
+    if(UART1_RECEIVE_AS_STRING)
+    {
+        tmpResBuf->_buf[tmpResBuf->_len] = 0;
+        tmpResBuf->_len++;
+    }
+    return tmpResBuf;
+}
+
+size_t UART1ReceiveStream(uint8_t* buf, size_t len, uint32_t timeout)
+{
+    if(!UART1ReceiveWait(timeout))
+    {
+        return 0;
+    }
+    return RxRing_Read(&uart1RecRing, buf, len);
+}
+
+void UART1ReceiveGetStat(UARTRecStat* stat)
+{
+    stat->_overrunNum = uart1RecRing._overrunNum;
+    stat->_overrunBytes = uart1RecRing._overrunBytes;
+    stat->_errorNum = uart1RecErrorNum;
+    stat->_allocFailNum = uart1RecAllocFailNum;
+}
+
+#else
 
-// 接收数据暂存队列 (以暂存的常量数据块为元素)
-osMessageQueueId_t uart1RecQueue = NULL;
+// 接收数据暂存队列 (以暂存的常量数据块为元素), 队列满时丢弃最早的数据块
+ConstBuf* uart1RecQueueItem[UART1_RECEIVE_QUEUE_SIZE];
+BufRing uart1RecQueue;
 // 接收缓冲区
 ByteBuf* recBuf = NULL;
 
+#if (UART1_REC_ZERO_COPY == 1)
+// 轮转接收缓冲区数量, 必须大于接收队列长度
+// 接收队列已满时, 仍有一个缓冲区用于接收, 一个缓冲区可被接收者持有, 此时插入将丢弃最早的数据块并归还其缓冲区
+// 若缓冲区数量不超过队列长度, 缓冲区将先于队列耗尽, 接收任务只能等待接收者, 丢弃最早数据的策略永远不会生效
+#define UART1_RECEIVE_BUF_NUM (UART1_RECEIVE_QUEUE_SIZE + 2)
+
+#if (UART1_RECEIVE_BUF_NUM <= UART1_RECEIVE_QUEUE_SIZE + 1)
+#error "UART1_RECEIVE_BUF_NUM must exceed UART1_RECEIVE_QUEUE_SIZE + 1"
+#endif
+
+// 轮转接收缓冲区, 每个缓冲区多预留 1 字节用于补充字符串末尾的 \0
+uint8_t uart1RecBufPool[UART1_RECEIVE_BUF_NUM][UART1_RECEIVE_BUF_SIZE + 1];
+// 空闲接收缓冲区队列 (以缓冲区首地址为元素)
+osMessageQueueId_t uart1RecFreeQueue = NULL;
+// 包裹当前接收目标缓冲区的对象
+ByteBuf uart1RecWrapBuf = {
+    ._buf = NULL,
+    ._len = 0,
+    ._size = UART1_RECEIVE_BUF_SIZE
+};
+
+// 接收者销毁数据块时, 将借出的缓冲区归还空闲队列
+void UART1ReceiveBufRelease(uint8_t* buf)
+{
+    osMessageQueuePut(uart1RecFreeQueue, &buf, 0, 0);
+}
+
+/**
+ * @brief 取得一个空闲接收缓冲区
+ * 
+ * @return uint8_t* 空闲接收缓冲区首地址
+ * @note 接收队列已满时由插入丢弃最早的数据块并归还缓冲区, 因此仅当接收者持有超过一个缓冲区时才需要等待接收者归还
+ * @note 接收队列为单生产者单消费者队列, 接收任务作为生产者不从中取出数据
+ */
+uint8_t* UART1ReceiveTakeBuf()
+{
+    uint8_t* res = NULL;
+    osMessageQueueGet(uart1RecFreeQueue, &res, NULL, osWaitForever);
+    return res;
+}
+#endif
+
 #if (UART1_REC_USE_DMA == 1)
-// 接收完成信号
-osSemaphoreId_t uart1RecDone = NULL;
+// 接收完成信号, 信号值为接收到的数据量
+TaskSignal uart1RecDone;
 
 // 接收直到空闲完成回调函数, 函数的第二个参数为接收到的数据量
 void UART1ReceiveCmpltCallBack(UART_HandleTypeDef *huart, uint16_t len)
 {
-    if(uart1RecDone != NULL)
-    {
-        recBuf->_len = len;
-        osSemaphoreRelease(uart1RecDone);
-    }
+    TaskSignal_Give(&uart1RecDone, len);
 }
 #endif
 
 void UART1ReceiveTask(void* args)
 {
     // 初始化接收队列, 信号量与缓冲区
-    recBuf = ByteBuf_Create(UART1_RECEIVE_BUF_SIZE);
-    uart1RecQueue = osMessageQueueNew(UART1_RECEIVE_QUEUE_SIZE, sizeof(ByteBuf*), NULL);
+    #if (UART1_REC_ZERO_COPY == 1)
+        recBuf = &uart1RecWrapBuf;
+        uart1RecFreeQueue = osMessageQueueNew(UART1_RECEIVE_BUF_NUM, sizeof(uint8_t*), NULL);
+        for(uint32_t i = 0; i < UART1_RECEIVE_BUF_NUM; i++)
+        {
+            uint8_t* tmpFreeBuf = uart1RecBufPool[i];
+            osMessageQueuePut(uart1RecFreeQueue, &tmpFreeBuf, 0, 0);
+        }
+    #else
+        recBuf = ByteBuf_Create(UART1_RECEIVE_BUF_SIZE);
+    #endif
+    BufRing_Init(&uart1RecQueue, uart1RecQueueItem, UART1_RECEIVE_QUEUE_SIZE);
     
     // 注册接收直到空闲回调函数
     #if (UART1_REC_USE_DMA == 1)
-        uart1RecDone = osSemaphoreNew(1, 0, NULL);
+        TaskSignal_Bind(&uart1RecDone);
         HAL_UART_RegisterRxEventCallback(&huart1, &UART1ReceiveCmpltCallBack);
     #endif
 
     while(1)
     {
+        // 轮转到下一个空闲接收缓冲区
+        #if (UART1_REC_ZERO_COPY == 1)
+            recBuf->_buf = UART1ReceiveTakeBuf();
+        #endif
+
         // 使用 HAL 提供的方法发送数据
         #if (UART1_REC_USE_DMA == 1)
             if(HAL_UARTEx_ReceiveToIdle_DMA(&huart1, recBuf->_buf, recBuf->_size))
@@ -169,7 +544,9 @@ void UART1ReceiveTask(void* args)
                 Error_Handler();
             }
             // 等待一次数据接收完成
-            osSemaphoreAcquire(uart1RecDone, osWaitForever);
+            uint32_t len = 0;
+            TaskSignal_Wait(&uart1RecDone, osWaitForever, &len);
+            recBuf->_len = len;
         #else
             uint16_t len = 0;
 
@@ -180,33 +557,89 @@ void UART1ReceiveTask(void* args)
             recBuf->_len = len;
         #endif
 
-        // 将缓冲区数据复制到一个常量缓冲区中, 并缓存到接收队列
-        ConstBuf* tmpResBuf = ConstBuf_CreateByBuf(recBuf, UART1_RECEIVE_AS_STRING);
-        osStatus_t res = osOK;
-
-        do
-        {
-            res = osMessageQueuePut(uart1RecQueue, &tmpResBuf, 0, UART1_RECEIVE_TIMEOUT);
-            // 当队列满时, 删除最早插入的数据
-            if(res == osErrorTimeout)
+        #if (UART1_REC_ZERO_COPY == 1)
+            // 直接将接收缓冲区借给接收者, 并缓存到接收队列
+            if(UART1_RECEIVE_AS_STRING)
+            {
+                recBuf->_buf[recBuf->_len] = 0;
+                recBuf->_len++;
+            }
+            ConstBuf* tmpResBuf = ConstBuf_CreateByBorrow(recBuf->_buf, recBuf->_len, UART1ReceiveBufRelease);
+            if(tmpResBuf == NULL)
+            {
+                // 无法分配数据块对象时直接归还缓冲区, 丢弃本次数据
+                UART1ReceiveBufRelease(recBuf->_buf);
+                uart1RecAllocFailNum++;
+                continue;
+            }
+        #else
+            // 将缓冲区数据复制到一个常量缓冲区中, 并缓存到接收队列
+            ConstBuf* tmpResBuf = ConstBuf_CreateEmpty(UART1_RECEIVE_AS_STRING ? recBuf->_len + 1 : recBuf->_len);
+            if(tmpResBuf == NULL)
+            {
+                // 无法分配数据块时丢弃本次数据
+                uart1RecAllocFailNum++;
+                continue;
+            }
+            memcpy(tmpResBuf->_buf, recBuf->_buf, recBuf->_len);
+            if(UART1_RECEIVE_AS_STRING)
             {
-                ConstBuf* tmpAbanBuf = UART1ReceiveData(osWaitForever);
-                ConstBuf_Delete(tmpAbanBuf);                
+                tmpResBuf->_buf[recBuf->_len] = 0;
             }
-        } while (res == osErrorTimeout);
+        #endif
+
+        // 当队列满时, 删除最早插入的数据
+        ConstBuf* tmpAbanBuf = BufRing_Push(&uart1RecQueue, tmpResBuf);
+        if(tmpAbanBuf != NULL)
+        {
+            ConstBuf_Delete(tmpAbanBuf);
+        }
     }
 }
 
 ConstBuf* UART1ReceiveData(uint32_t timeout)
 {
-    ConstBuf* tmpResBuf = NULL;
-    osMessageQueueGet(uart1RecQueue, &tmpResBuf, NULL, timeout);
-    return tmpResBuf;
+    return BufRing_Pop(&uart1RecQueue, timeout);
+}
+
+void UART1ReceiveGetStat(UARTRecStat* stat)
+{
+    // 队列模式下以接收队列满而丢弃的数据块数作为溢出次数, 不统计字节数与外设错误
+    stat->_overrunNum = uart1RecQueue._dropNum;
+    stat->_overrunBytes = 0;
+    stat->_errorNum = 0;
+    stat->_allocFailNum = uart1RecAllocFailNum;
+}
+
+#endif
+
+// 二进制数据帧的最大数据长度
+#define UART1_RECEIVE_FRAME_SIZE 256
+// 二进制数据帧接收器
+BinFrameReader uart1RecFrameReader;
+uint8_t uart1RecFrameInit = 0;
+
+ConstBuf* UART1ReceiveFrame(uint32_t timeout)
+{
+    if(!uart1RecFrameInit)
+    {
+        // 无法分配帧缓冲区时不接收, 下次调用时重新初始化
+        if(!BinFrameReader_Init(&uart1RecFrameReader, UART1_RECEIVE_FRAME_SIZE, UART1_RECEIVE_AS_STRING))
+        {
+            return NULL;
+        }
+        uart1RecFrameInit = 1;
+    }
+    return BinFrameReader_Read(&uart1RecFrameReader, UART1ReceiveData, timeout);
 }
 
 UARTRecState UART1ReceiveGetState()
 {
-    if(uart1RecQueue == NULL)
+#if (UART1_REC_USE_RING == 1)
+    if(uart1RecRing._buf == NULL)
+#else
+    if(uart1RecQueue._item == NULL)
+#endif
     {
         return UART_REC_UNINIT;
     }
@@ -218,7 +651,11 @@ UARTRecState UART1ReceiveGetState()
     {
         return UART_REC_RESET;
     }
-    else if(osMessageQueueGetCount(uart1RecQueue) == 0)
+#if (UART1_REC_USE_RING == 1)
+    else if(RxRing_GetCount(&uart1RecRing) == 0)
+#else
+    else if(BufRing_GetCount(&uart1RecQueue) == 0)
+#endif
     {
         return UART_REC_EMPTY;
     }
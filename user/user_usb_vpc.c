@@ -5,83 +5,205 @@
 
 #include "byte_buf.h"
 #include "user_usb_vpc.h"
+#include "task_signal.h"
+#include "buf_ring.h"
+#include "bin_frame.h"
 
 #include "usbd_cdc_if.h"
+#include "string.h"
 
 extern PCD_HandleTypeDef hpcd_USB_FS;
 
 //********** USB VPC 接收管理 **********//
 
-// 使用 ByteBuf 对象包裹系统的 USB 接收缓冲区
-extern uint8_t UserRxBufferFS[APP_RX_DATA_SIZE];
-ByteBuf wrapRxBuf = {
-    ._buf = UserRxBufferFS,
-    ._len = 0,
-    ._size = APP_RX_DATA_SIZE
-};
-
-// 结果数据块队列长度
-const uint32_t USB_VPC_RECEIVE_QUEUE_SIZE = 8;
-// 读取缓冲区长度
-const uint32_t USB_VPC_RECEIVE_BUF_SIZE = APP_RX_DATA_SIZE;
-// 是否将结果作为字符串处理
+// 结果数据块队列长度, 必须为 2 的幂
+// 大于接收缓冲池中的缓冲区数量, 因此接收者读取过慢时将由缓冲池耗尽暂停接收, 而不会丢弃数据
+#define USB_VPC_RECEIVE_QUEUE_SIZE 16
+// 是否将结果作为字符串处理, 是则总是在数据块末尾补充一个 \0
 const uint8_t USB_VPC_RECEIVE_AS_STRING = 1;
-// 接收后插入接收队列的等待时长
-const uint32_t USB_VPC_RECEIVE_TIMEOUT = HAL_MAX_DELAY;
+// 接收缓冲池中的缓冲区数量, 每个缓冲区存放一个 OUT 数据包
+#define USB_VPC_RECEIVE_BUF_NUM 8
 
-// 接收数据暂存队列 (以暂存的常量数据块为元素)
-osMessageQueueId_t uvRecQueue = NULL;
-// 接收完成信号
-osSemaphoreId_t uvRecDone = NULL;
+// 接收数据暂存队列 (以暂存的常量数据块为元素), 队列满时丢弃最早的数据块
+ConstBuf* uvRecQueueItem[USB_VPC_RECEIVE_QUEUE_SIZE];
+BufRing uvRecQueue;
+// 无法分配结果数据块而丢弃的数据包数
+volatile uint32_t uvRecAllocFailNum = 0;
 
-// 接收直到空闲完成回调函数, 函数的第二个参数为接收到的数据量
-void USB_VPC_ReceiveCmpltCallBack(uint32_t len)
+/// @brief 已接收的 OUT 数据包
+typedef struct UVRECPACKET
 {
-    if(uvRecDone != NULL)
+    // 数据包所在的缓冲区
+    uint8_t* _buf;
+    // 数据包长度
+    uint32_t _len;
+} UVRecPacket;
+
+// 接收缓冲池, 每个缓冲区多预留 1 字节用于补充字符串末尾的 \0
+uint8_t uvRecBufPool[USB_VPC_RECEIVE_BUF_NUM][CDC_DATA_FS_MAX_PACKET_SIZE + 1];
+// 空闲接收缓冲区队列 (以缓冲区首地址为元素)
+osMessageQueueId_t uvRecFreeQueue = NULL;
+// 已接收数据包队列, 由接收完成回调插入, 接收管理任务取出
+osMessageQueueId_t uvRecPacketQueue = NULL;
+// OUT 端点是否因没有空闲缓冲区而未重新开始接收 (此时端点对主机回复 NAK)
+volatile uint8_t uvRecStalled = 0;
+
+/**
+ * @brief 判断缓冲区是否属于接收缓冲池
+ * 
+ * @param buf 缓冲区首地址
+ * @return uint8_t 属于接收缓冲池时返回 1
+ */
+static inline uint8_t USB_VPC_ReceiveIsPoolBuf(const uint8_t* buf)
+{
+    return buf >= uvRecBufPool[0] && buf < uvRecBufPool[USB_VPC_RECEIVE_BUF_NUM];
+}
+
+/**
+ * @brief 若 OUT 端点处于暂停状态, 则取得一个空闲缓冲区并重新开始接收
+ * 
+ * @note 可在任务与中断中调用
+ */
+void USB_VPC_ReceiveResume()
+{
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    uint8_t* buf = NULL;
+    if(uvRecStalled && osMessageQueueGet(uvRecFreeQueue, &buf, NULL, 0) == osOK)
     {
-        wrapRxBuf._len = len;
-        osSemaphoreRelease(uvRecDone);
+        uvRecStalled = 0;
+        USBD_CDC_SetRxBuffer(&hUsbDeviceFS, buf);
+        USBD_CDC_ReceivePacket(&hUsbDeviceFS);
     }
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+}
+
+// 接收者销毁数据块时, 将借出的缓冲区归还缓冲池, 若 OUT 端点已暂停则立即重新开始接收
+void USB_VPC_ReceiveBufRelease(uint8_t* buf)
+{
+    osMessageQueuePut(uvRecFreeQueue, &buf, 0, 0);
+    USB_VPC_ReceiveResume();
+}
+
+void USB_VPC_ReceiveCmpltCallBack(uint8_t* buf, uint32_t len)
+{
+    UVRecPacket packet = {
+        ._buf = buf,
+        ._len = len
+    };
+
+    // 接收任务未启动时, 直接在原缓冲区重新开始接收 (丢弃数据)
+    if(uvRecPacketQueue == NULL)
+    {
+        USBD_CDC_SetRxBuffer(&hUsbDeviceFS, buf);
+        USBD_CDC_ReceivePacket(&hUsbDeviceFS);
+        return;
+    }
+
+    osMessageQueuePut(uvRecPacketQueue, &packet, 0, 0);
+
+    // 端点在上一次接收完成后自动回复 NAK, 取得空闲缓冲区后再重新开始接收
+    // 之后只在缓冲池中的缓冲区上接收, 设备初始化时使用的 UserRxBufferFS 不会被覆盖
+    uvRecStalled = 1;
+    USB_VPC_ReceiveResume();
 }
 
 void USB_VPC_ReceiveTask(void* args)
 {
-    // 初始化接收队列, 信号量与缓冲区
-    uvRecQueue = osMessageQueueNew(USB_VPC_RECEIVE_QUEUE_SIZE, sizeof(ByteBuf*), NULL);
-    uvRecDone = osSemaphoreNew(1, 0, NULL);
+    // 初始化接收队列与缓冲池
+    BufRing_Init(&uvRecQueue, uvRecQueueItem, USB_VPC_RECEIVE_QUEUE_SIZE);
+    uvRecFreeQueue = osMessageQueueNew(USB_VPC_RECEIVE_BUF_NUM, sizeof(uint8_t*), NULL);
+    for(uint32_t i = 0; i < USB_VPC_RECEIVE_BUF_NUM; i++)
+    {
+        uint8_t* tmpFreeBuf = uvRecBufPool[i];
+        osMessageQueuePut(uvRecFreeQueue, &tmpFreeBuf, 0, 0);
+    }
+    // 缓冲池中的缓冲区与设备初始化时使用的 UserRxBufferFS 可能同时位于队列中
+    uvRecPacketQueue = osMessageQueueNew(USB_VPC_RECEIVE_BUF_NUM + 1, sizeof(UVRecPacket), NULL);
 
     while(1)
     {
-        // 等待一次数据接收完成
-        osSemaphoreAcquire(uvRecDone, osWaitForever);            
-
-        // 将缓冲区数据复制到一个常量缓冲区中, 并缓存到接收队列
-        ConstBuf* tmpResBuf = ConstBuf_CreateByBuf(&wrapRxBuf, USB_VPC_RECEIVE_AS_STRING);
-        osStatus_t res = osOK;
+        // 等待一个数据包接收完成
+        UVRecPacket packet;
+        osMessageQueueGet(uvRecPacketQueue, &packet, NULL, osWaitForever);
 
-        do
+        ConstBuf* tmpResBuf = NULL;
+        if(USB_VPC_ReceiveIsPoolBuf(packet._buf))
+        {
+            // 直接将缓冲池中的缓冲区借给接收者, 接收者销毁数据块后归还
+            if(USB_VPC_RECEIVE_AS_STRING)
+            {
+                packet._buf[packet._len] = 0;
+                packet._len++;
+            }
+            tmpResBuf = ConstBuf_CreateByBorrow(packet._buf, packet._len, USB_VPC_ReceiveBufRelease);
+            if(tmpResBuf == NULL)
+            {
+                // 无法分配数据块对象时直接归还缓冲区, 丢弃本次数据
+                USB_VPC_ReceiveBufRelease(packet._buf);
+            }
+        }
+        else
         {
-            res = osMessageQueuePut(uvRecQueue, &tmpResBuf, 0, USB_VPC_RECEIVE_TIMEOUT);
-            // 当队列满时, 删除最早插入的数据
-            if(res == osErrorTimeout)
+            // 复制不属于缓冲池的缓冲区
+            tmpResBuf = ConstBuf_CreateEmpty(USB_VPC_RECEIVE_AS_STRING ? packet._len + 1 : packet._len);
+            if(tmpResBuf != NULL)
             {
-                ConstBuf* tmpAbanBuf = USB_VPC_ReceiveData(osWaitForever);
-                ConstBuf_Delete(tmpAbanBuf);                
+                memcpy(tmpResBuf->_buf, packet._buf, packet._len);
+                if(USB_VPC_RECEIVE_AS_STRING)
+                {
+                    tmpResBuf->_buf[packet._len] = 0;
+                }
             }
-        } while (res == osErrorTimeout);
+        }
+
+        if(tmpResBuf == NULL)
+        {
+            uvRecAllocFailNum++;
+            continue;
+        }
+
+        // 当队列满时, 删除最早插入的数据
+        ConstBuf* tmpAbanBuf = BufRing_Push(&uvRecQueue, tmpResBuf);
+        if(tmpAbanBuf != NULL)
+        {
+            ConstBuf_Delete(tmpAbanBuf);
+        }
     }
 }
 
 ConstBuf* USB_VPC_ReceiveData(uint32_t timeout)
 {
-    ConstBuf* tmpResBuf = NULL;
-    osMessageQueueGet(uvRecQueue, &tmpResBuf, NULL, timeout);
-    return tmpResBuf;
+    return BufRing_Pop(&uvRecQueue, timeout);
+}
+
+uint32_t USB_VPC_ReceiveGetAllocFailNum()
+{
+    return uvRecAllocFailNum;
+}
+
+// 二进制数据帧的最大数据长度
+#define USB_VPC_RECEIVE_FRAME_SIZE 256
+// 二进制数据帧接收器
+BinFrameReader uvRecFrameReader;
+uint8_t uvRecFrameInit = 0;
+
+ConstBuf* USB_VPC_ReceiveFrame(uint32_t timeout)
+{
+    if(!uvRecFrameInit)
+    {
+        // 无法分配帧缓冲区时不接收, 下次调用时重新初始化
+        if(!BinFrameReader_Init(&uvRecFrameReader, USB_VPC_RECEIVE_FRAME_SIZE, USB_VPC_RECEIVE_AS_STRING))
+        {
+            return NULL;
+        }
+        uvRecFrameInit = 1;
+    }
+    return BinFrameReader_Read(&uvRecFrameReader, USB_VPC_ReceiveData, timeout);
 }
 
 USB_VPC_RecState USB_VPC_ReceiveGetState()
 {
-    if(uvRecQueue == NULL)
+    if(uvRecQueue._item == NULL)
     {
         return USB_VPC_REC_UNINIT;
     }
@@ -93,7 +215,7 @@ USB_VPC_RecState USB_VPC_ReceiveGetState()
     {
         return USB_VPC_REC_RESET;
     }
-    else if(osMessageQueueGetCount(uvRecQueue) == 0)
+    else if(BufRing_GetCount(&uvRecQueue) == 0)
     {
         return USB_VPC_REC_EMPTY;
     }
@@ -107,36 +229,186 @@ USB_VPC_RecState USB_VPC_ReceiveGetState()
 
 // USB VPC 发送队列长度
 const uint32_t USB_VPC_SEND_QUEUE_SIZE = 8;
+// 合并发送暂存区长度, 为端点最大包长的整数倍, 一次传输可包含多个数据包, 超过该长度的数据块将单独直接发送
+#define USB_VPC_SEND_BATCH_SIZE (8 * CDC_DATA_FS_MAX_PACKET_SIZE)
+// 单次合并的最多数据块数
+#define USB_VPC_SEND_BATCH_MAX_NUM 16
+// 发送暂存区数量, 一个暂存区传输的同时, 发送任务可准备另一个暂存区
+#define USB_VPC_SEND_SLOT_NUM 2
+// 传输长度为最大包长的整数倍且之后暂无数据时, 是否补发零长度包以结束传输
+// 若所用的 USB 中间件已在 USBD_CDC_DataIn 中自动发送零长度包, 可设为 0
+#define USB_VPC_SEND_USE_ZLP 1
 
 // 发送数据暂存队列 (以暂存的常量数据块为元素)
 osMessageQueueId_t uvSendQueue = NULL;
 
+/// @brief USB VPC 发送暂存区
+typedef struct UVSENDSLOT
+{
+    // 合并发送缓冲区
+    uint8_t _buf[USB_VPC_SEND_BATCH_SIZE];
+    // 实际发送的数据, 指向合并发送缓冲区或单独发送的数据块
+    uint8_t* _data;
+    // 实际发送的数据长度
+    size_t _len;
+    // 该暂存区包含的数据块, 将在主机确认接收 (传输完成) 后删除
+    ConstBuf* _list[USB_VPC_SEND_BATCH_MAX_NUM];
+    // 该暂存区包含的数据块数
+    size_t _num;
+} UVSendSlot;
+
+UVSendSlot uvSendSlot[USB_VPC_SEND_SLOT_NUM];
+// 传输完成信号 (计数信号, 每完成一次传输发出一次)
+TaskSignal uvSendDone;
+
+void USB_VPC_TransmitCmpltCallBack(void)
+{
+    TaskSignal_Post(&uvSendDone);
+}
+
+/**
+ * @brief 开始一次传输, 端点忙时等待后重试
+ * 
+ * @param data 传输的数据, 传输完成前必须保持有效
+ * @param len 传输的数据长度, 为 0 时发送零长度包
+ * @return uint8_t 成功开始传输时返回 1, 否则返回 0 (如设备未连接)
+ */
+uint8_t USB_VPC_SendStart(uint8_t* data, size_t len)
+{
+    uint8_t res = USBD_OK;
+    while((res = CDC_Transmit_FS(data, len)) == USBD_BUSY)
+    {
+        osDelay(1);
+    }
+    return res == USBD_OK;
+}
+
+/**
+ * @brief 将发送队列中的数据块填入暂存区
+ * 
+ * @param slot 空闲的暂存区
+ * @param sendData 第一个数据块, 返回时为未能放入暂存区, 留到下一次发送的数据块 (可能为 NULL)
+ */
+void USB_VPC_SendFill(UVSendSlot* slot, ConstBuf** sendData)
+{
+    // 超过暂存区长度的数据块直接发送
+    if((*sendData)->_len > USB_VPC_SEND_BATCH_SIZE)
+    {
+        slot->_data = (*sendData)->_buf;
+        slot->_len = (*sendData)->_len;
+        slot->_list[0] = *sendData;
+        slot->_num = 1;
+        *sendData = NULL;
+        return;
+    }
+
+    // 将数据块依次复制到暂存区, 直到暂存区放不下或队列为空
+    slot->_data = slot->_buf;
+    slot->_len = 0;
+    while(*sendData != NULL && slot->_len + (*sendData)->_len <= USB_VPC_SEND_BATCH_SIZE && slot->_num < USB_VPC_SEND_BATCH_MAX_NUM)
+    {
+        memcpy(slot->_buf + slot->_len, (*sendData)->_buf, (*sendData)->_len);
+        slot->_len += (*sendData)->_len;
+        slot->_list[slot->_num] = *sendData;
+        slot->_num++;
+
+        if(osMessageQueueGet(uvSendQueue, sendData, NULL, 0) != osOK)
+        {
+            *sendData = NULL;
+        }
+    }
+}
+
+/**
+ * @brief 回收一个已传输完成的暂存区, 并删除其中的数据块
+ * 
+ * @param slot 暂存区
+ * @param is_last 之后是否暂无数据发送, 是则在需要时补发零长度包
+ */
+void USB_VPC_SendReclaim(UVSendSlot* slot, uint8_t is_last)
+{
+    #if (USB_VPC_SEND_USE_ZLP == 1)
+        // 以满包结束的传输需要零长度包通知主机传输结束
+        if(is_last && slot->_len > 0 && slot->_len % CDC_DATA_FS_MAX_PACKET_SIZE == 0)
+        {
+            if(USB_VPC_SendStart(slot->_buf, 0))
+            {
+                TaskSignal_Pend(&uvSendDone, osWaitForever);
+            }
+        }
+    #endif
+
+    for(size_t i = 0; i < slot->_num; i++)
+    {
+        ConstBuf_Delete(slot->_list[i]);
+    }
+    slot->_num = 0;
+}
+
 // 数据发送管理任务
 void USB_VPC_SendTask(void* args)
 {
-    // 在管理任务启动时, 初始化信号量与队列
+    // 在管理任务启动时, 初始化信号与队列
     ConstBuf* sendData = NULL;
     uvSendQueue = osMessageQueueNew(USB_VPC_SEND_QUEUE_SIZE, sizeof(ConstBuf*), NULL);
+    TaskSignal_Bind(&uvSendDone);
+
+    uint32_t fillIdx = 0;
+    // 正在传输的暂存区
+    UVSendSlot* active = NULL;
 
     while(1)
     {
-        // 等待发送队列中插入数据
-        osMessageQueueGet(uvSendQueue, &sendData, NULL, osWaitForever);
+        // 等待发送队列中插入数据 (上一轮未能合并的数据块将留到本轮发送)
+        // 仍有传输进行时, 定期返回以及时回收
+        if(sendData == NULL)
+        {
+            if(osMessageQueueGet(uvSendQueue, &sendData, NULL, active != NULL ? 1 : osWaitForever) != osOK)
+            {
+                sendData = NULL;
+                if(active != NULL && TaskSignal_Pend(&uvSendDone, 0))
+                {
+                    USB_VPC_SendReclaim(active, 1);
+                    active = NULL;
+                }
+                continue;
+            }
+        }
 
-        if(CDC_Transmit_FS(sendData->_buf, sendData->_len) != USBD_OK)
+        // 上一次传输进行的同时准备下一个暂存区
+        UVSendSlot* slot = &uvSendSlot[fillIdx];
+        fillIdx = (fillIdx + 1) % USB_VPC_SEND_SLOT_NUM;
+        USB_VPC_SendFill(slot, &sendData);
+
+        // 等待上一次传输完成 (主机已确认接收) 后再回收其数据块, 并开始本次传输
+        if(active != NULL)
         {
-            Error_Handler();
+            TaskSignal_Pend(&uvSendDone, osWaitForever);
+            USB_VPC_SendReclaim(active, 0);
         }
 
-        // 删除已发送数据块
-        ConstBuf_Delete(sendData);
+        if(USB_VPC_SendStart(slot->_data, slot->_len))
+        {
+            active = slot;
+        }
+        else
+        {
+            // 设备未连接等错误时丢弃数据
+            USB_VPC_SendReclaim(slot, 0);
+            active = NULL;
+        }
     }
 }
 
 osStatus_t USB_VPC_SendData(ConstBuf* data, uint32_t timeout)
 {
+    if(data == NULL)
+    {
+        return osErrorNoMemory;
+    }
     if(uvSendQueue == NULL)
     {
+        ConstBuf_Delete(data);
         return osError;
     }
 
@@ -150,6 +422,13 @@ osStatus_t USB_VPC_SendData(ConstBuf* data, uint32_t timeout)
     return res;
 }
 
+osStatus_t USB_VPC_SendFrame(ConstBuf* data, uint32_t timeout)
+{
+    ConstBuf* frame = BinFrame_Encode(data->_buf, data->_len);
+    ConstBuf_Delete(data);
+    return USB_VPC_SendData(frame, timeout);
+}
+
 USB_VPC_SendState USB_VPC_SendGetState()
 {
     if(uvSendQueue == NULL)